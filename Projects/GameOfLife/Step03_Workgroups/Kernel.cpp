@@ -5,6 +5,8 @@
 #include <span>
 #include <numeric>
 
+#include "stencil/TemporalBlocking.hpp"
+
 namespace GameOfLife {
 
 	Kernel::Kernel(size_t w, size_t h, size_t pad) :
@@ -57,6 +59,25 @@ namespace GameOfLife {
 
 	}
 
+	void Kernel::stepMany(unsigned n)
+	{
+		const tc::ivec2 size{ static_cast<int>(m_Width), static_cast<int>(m_Height) };
+		const int pad = static_cast<int>(m_Pad);
+		tc::stencil::stepMany(
+			tc::stencil::Grid2D<const uint32_t>{ m_State0.data(), size, pad },
+			tc::stencil::Grid2D<uint32_t>{ m_State1.data(), size, pad },
+			n,
+			[](const uint32_t* center, std::ptrdiff_t stride, uint32_t* out, int count, tc::ivec2) {
+				for (int i = 0; i < count; ++i) {
+					const uint32_t* c = center + i;
+					uint32_t neighbours = c[-stride - 1] + c[-stride] + c[-stride + 1]
+						+ c[-1] + c[1]
+						+ c[stride - 1] + c[stride] + c[stride + 1];
+					out[i] = (neighbours == 3) || (c[0] && neighbours == 2);
+				}
+			});
+	}
+
 	void Kernel::main() {
 		int n = 0;
 		int c = globalInvocationID.x;
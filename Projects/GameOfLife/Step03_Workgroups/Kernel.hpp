@@ -40,6 +40,9 @@ namespace GameOfLife
 
 		void dispatch();
 		void dispatchWorkGroup();
+		// advances n generations into the second buffer, like n dispatches
+		// but in tiles that stay in cache.
+		void stepMany(unsigned n);
 		void main();
 
 		size_t getWidth() const {
@@ -9,11 +9,11 @@ struct [[clang::annotate("kernel")]] GameOfLifeKernel
 {
 	static constexpr char fileLocation[] = "gol_v4";
 	tc::uvec3 local_size{ 4, 4, 1 };
-	tc::ImageBinding<tc::InternalFormat::R8UI, tc::Dim::D2, tc::cpu::R8UI, 0> inData;
+	// the cells outside the world read as dead, no padding around the image.
+	tc::ImageBinding<tc::InternalFormat::R8UI, tc::Dim::D2, tc::cpu::R8UI, 0, 0,
+		tc::StorageLayout::Linear, tc::AddressMode::Border> inData;
 	tc::ImageBinding<tc::InternalFormat::R8UI, tc::Dim::D2, tc::cpu::R8UI, 1> outData;
 
-	tc::Uniform<tc::integer, 1> pad{ 1 };
-
 	std::array<tc::ivec2, 8> kernelIndices {
 		tc::ivec2{-1,-1}, tc::ivec2{0,-1},tc::ivec2{1,-1},
 		tc::ivec2{-1, 0},                 tc::ivec2{1, 0},
@@ -24,7 +24,7 @@ struct [[clang::annotate("kernel")]] GameOfLifeKernel
 		using namespace tc;
 		uint n = 0;
 		uvec2 gId = tc::gl_GlobalInvocationID["xy"_sw];
-		ivec2 coordinate = ivec2(gId.x+pad, gId.y+pad);
+		ivec2 coordinate = ivec2(gId.x, gId.y);
 
 		bool alive = imageLoad(inData, coordinate).x;
 		for (int ki = 0; ki < kernelIndices.size(); ++ki) {
@@ -50,14 +50,13 @@ struct [[clang::annotate("kernel")]] ConvertKernel
 		tc::vec4(1    , 0  , 0  , 1.0)
 	};
 
-	tc::Uniform<tc::integer, 1> pad{ 1 };
-	tc::Uniform<tc::integer, 2> scale{ 2 };
+	tc::SpecConstant<tc::integer, 1, 2> scale;
 
 	void main()
 	{
 		tc::uvec2 gId = tc::gl_GlobalInvocationID["xy"_sw];
 		tc::ivec2 rc = tc::ivec2(gId.x , gId.y );
-		tc::ivec2 coordinate = rc / scale + tc::ivec2{ pad,pad };
+		tc::ivec2 coordinate = rc / scale;
 
 		tc::ivec2 dim = imageSize(inData);
 
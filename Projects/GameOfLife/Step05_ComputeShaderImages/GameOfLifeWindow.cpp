@@ -19,8 +19,8 @@ GameOfLifeWindow::~GameOfLifeWindow()
 void GameOfLifeWindow::init(SurfaceRenderer& renderer)
 {
 	using namespace tc;
-	integer w = renderer.getWidth() / m_ConvertKernel.scale + 2 * m_GameOfLife.pad;
-	integer h = renderer.getHeight() / m_ConvertKernel.scale + 2 * m_GameOfLife.pad;
+	integer w = renderer.getWidth() / m_ConvertKernel.scale;
+	integer h = renderer.getHeight() / m_ConvertKernel.scale;
 
 	tc::ivec2 dim{ w,h };
 	m_pDataIn.reset(new BufferResource<tc::cpu::R8UI, tc::Dim::D2>{ dim });
@@ -29,7 +29,7 @@ void GameOfLifeWindow::init(SurfaceRenderer& renderer)
 	m_GameOfLife.inData.attach(m_pDataIn.get());
 	m_GameOfLife.outData.attach(m_pDataOut.get());
 
-	ivec2 offset{ w / 2 + m_GameOfLife.pad, h / 2 + m_GameOfLife.pad };
+	ivec2 offset{ w / 2, h / 2 };
 	tc::imageStore(m_GameOfLife.inData, ivec2{ 1, 0 } + offset, 1);
 	tc::imageStore(m_GameOfLife.inData, ivec2{ 0, 1 } + offset, 1);
 	tc::imageStore(m_GameOfLife.inData, ivec2{ 1, 1 } + offset, 1);
@@ -60,9 +60,8 @@ void GameOfLifeWindow::compute(SurfaceRenderer& renderer)
 	b.useKernel(m_GameOfLife);
 	b.bindImage(m_GameOfLife.inData);
 	b.bindImage(m_GameOfLife.outData);
-	b.bindUniform(m_GameOfLife.pad);
 	tc::ivec2 dim = tc::imageSize(m_GameOfLife.inData);
-	b.execute(m_GameOfLife, tc::uvec3{ dim.x - 2 * m_GameOfLife.pad, dim.y - 2 * m_GameOfLife.pad, 1 });
+	b.execute(m_GameOfLife, tc::uvec3{ dim.x, dim.y, 1 });
 
 	auto oldFrame = m_GameOfLife.inData.getBufferData();
 	auto newFrame = m_GameOfLife.outData.getBufferData();
@@ -74,8 +73,6 @@ void GameOfLifeWindow::compute(SurfaceRenderer& renderer)
 	m_ConvertKernel.inData.attach(newFrame);
 	b.bindImage(m_ConvertKernel.inData);
 	b.bindImage(m_ConvertKernel.outData);
-	b.bindUniform(m_ConvertKernel.pad);
-	b.bindUniform(m_ConvertKernel.scale);
 	int scale = m_ConvertKernel.scale;
 	b.execute(m_ConvertKernel, tc::uvec3{ renderer.getWidth(),renderer.getHeight(),1 });
 }
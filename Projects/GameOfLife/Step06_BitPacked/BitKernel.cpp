@@ -0,0 +1,196 @@
+#include "BitKernel.hpp"
+#include <execution>
+#include <algorithm>
+#include <ranges>
+
+#include "stencil/TemporalBlocking.hpp"
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+namespace GameOfLife {
+
+	namespace {
+		// The operations of the step on one word, or on a register of words.
+		// Shifts stay within a 64 bit lane, the bit that crosses into the next
+		// word comes from an unaligned load one word to the left or right.
+		struct ScalarLanes {
+			using type = uint64_t;
+			static constexpr size_t Words = 1;
+
+			static type load(const uint64_t* p) { return *p; }
+			static void store(uint64_t* p, type v) { *p = v; }
+			static type and_(type a, type b) { return a & b; }
+			static type or_(type a, type b) { return a | b; }
+			static type xor_(type a, type b) { return a ^ b; }
+			// ~a & b
+			static type andnot(type a, type b) { return ~a & b; }
+			template<int N> static type shl(type a) { return a << N; }
+			template<int N> static type shr(type a) { return a >> N; }
+		};
+
+#if defined(__AVX2__)
+		struct Avx2Lanes {
+			using type = __m256i;
+			static constexpr size_t Words = 4;
+
+			static type load(const uint64_t* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+			static void store(uint64_t* p, type v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+			static type and_(type a, type b) { return _mm256_and_si256(a, b); }
+			static type or_(type a, type b) { return _mm256_or_si256(a, b); }
+			static type xor_(type a, type b) { return _mm256_xor_si256(a, b); }
+			static type andnot(type a, type b) { return _mm256_andnot_si256(a, b); }
+			template<int N> static type shl(type a) { return _mm256_slli_epi64(a, N); }
+			template<int N> static type shr(type a) { return _mm256_srli_epi64(a, N); }
+		};
+#endif
+
+#if defined(__AVX512F__)
+		struct Avx512Lanes {
+			using type = __m512i;
+			static constexpr size_t Words = 8;
+
+			static type load(const uint64_t* p) { return _mm512_loadu_si512(p); }
+			static void store(uint64_t* p, type v) { _mm512_storeu_si512(p, v); }
+			static type and_(type a, type b) { return _mm512_and_si512(a, b); }
+			static type or_(type a, type b) { return _mm512_or_si512(a, b); }
+			static type xor_(type a, type b) { return _mm512_xor_si512(a, b); }
+			static type andnot(type a, type b) { return _mm512_andnot_si512(a, b); }
+			template<int N> static type shl(type a) { return _mm512_slli_epi64(a, N); }
+			template<int N> static type shr(type a) { return _mm512_srli_epi64(a, N); }
+		};
+#endif
+
+		// cells x - 1 of the words at p, moved to bit x.
+		template<typename Lanes>
+		typename Lanes::type westOf(const uint64_t* p, typename Lanes::type center) {
+			return Lanes::or_(Lanes::template shl<1>(center), Lanes::template shr<63>(Lanes::load(p - 1)));
+		}
+
+		// cells x + 1 of the words at p, moved to bit x.
+		template<typename Lanes>
+		typename Lanes::type eastOf(const uint64_t* p, typename Lanes::type center) {
+			return Lanes::or_(Lanes::template shr<1>(center), Lanes::template shl<63>(Lanes::load(p + 1)));
+		}
+
+		// The eight neighbours are added with full adders into the bit planes
+		// s0, s1 and s2 of the count modulo 8. A count of 8 wraps to 0, which
+		// is fine as both mean the cell is dead in the next generation.
+		template<typename Lanes>
+		typename Lanes::type nextWords(const uint64_t* up, const uint64_t* row, const uint64_t* down)
+		{
+			using L = Lanes;
+			using V = typename Lanes::type;
+
+			const V u = L::load(up);
+			const V c = L::load(row);
+			const V d = L::load(down);
+			const V uw = westOf<L>(up, u);
+			const V ue = eastOf<L>(up, u);
+			const V w = westOf<L>(row, c);
+			const V e = eastOf<L>(row, c);
+			const V dw = westOf<L>(down, d);
+			const V de = eastOf<L>(down, d);
+
+			// full adder on the row above and the row below, half adder on the
+			// west and east neighbours.
+			const V upX = L::xor_(uw, ue);
+			const V upSum = L::xor_(upX, u);
+			const V upCarry = L::or_(L::and_(uw, ue), L::and_(u, upX));
+			const V downX = L::xor_(dw, de);
+			const V downSum = L::xor_(downX, d);
+			const V downCarry = L::or_(L::and_(dw, de), L::and_(d, downX));
+			const V midSum = L::xor_(w, e);
+			const V midCarry = L::and_(w, e);
+
+			// ones
+			const V onesX = L::xor_(upSum, downSum);
+			const V s0 = L::xor_(onesX, midSum);
+			const V onesCarry = L::or_(L::and_(upSum, downSum), L::and_(midSum, onesX));
+
+			// twos
+			const V twosX = L::xor_(upCarry, downCarry);
+			const V twosSum = L::xor_(twosX, midCarry);
+			const V twosCarry = L::or_(L::and_(upCarry, downCarry), L::and_(midCarry, twosX));
+			const V s1 = L::xor_(twosSum, onesCarry);
+			const V s2 = L::xor_(twosCarry, L::and_(twosSum, onesCarry));
+
+			// alive when the count is 3, or 2 and the cell is alive.
+			return L::andnot(s2, L::and_(s1, L::or_(s0, c)));
+		}
+
+		// next generation of count words of a row, up and down are the same
+		// words in the rows above and below.
+		void stepWords(const uint64_t* up, const uint64_t* row, const uint64_t* down, uint64_t* out, size_t count)
+		{
+			size_t x = 0;
+#if defined(__AVX512F__)
+			for (; x + Avx512Lanes::Words <= count; x += Avx512Lanes::Words) {
+				Avx512Lanes::store(out + x, nextWords<Avx512Lanes>(up + x, row + x, down + x));
+			}
+#endif
+#if defined(__AVX2__)
+			for (; x + Avx2Lanes::Words <= count; x += Avx2Lanes::Words) {
+				Avx2Lanes::store(out + x, nextWords<Avx2Lanes>(up + x, row + x, down + x));
+			}
+#endif
+			for (; x < count; ++x) {
+				ScalarLanes::store(out + x, nextWords<ScalarLanes>(up + x, row + x, down + x));
+			}
+		}
+	}
+
+	BitKernel::BitKernel(size_t w, size_t h) :
+		m_Width{ w },
+		m_Height{ h },
+		m_WordsPerRow{ (w + CellsPerWord - 1) / CellsPerWord },
+		m_Stride{ m_WordsPerRow + 2 },
+		m_LastWordMask{ w % CellsPerWord == 0 ? ~uint64_t{ 0 } : (uint64_t{ 1 } << (w % CellsPerWord)) - 1 },
+		m_State0(m_Stride * (h + 2), 0u),
+		m_State1(m_State0.size(), 0u)
+	{
+
+	}
+
+	void BitKernel::dispatch()
+	{
+		auto range = std::views::iota(index{ 0 }, static_cast<index>(m_Height));
+		std::for_each(std::execution::par,
+			range.begin(), range.end(),
+			[&](const index cy) {
+				stepRow(cy);
+			});
+	}
+
+	void BitKernel::stepRow(index cy)
+	{
+		const uint64_t* up = &m_State0[wordIndex(0, cy - 1)];
+		const uint64_t* row = &m_State0[wordIndex(0, cy)];
+		const uint64_t* down = &m_State0[wordIndex(0, cy + 1)];
+		uint64_t* out = &m_State1[wordIndex(0, cy)];
+
+		stepWords(up, row, down, out, m_WordsPerRow);
+		out[m_WordsPerRow - 1] &= m_LastWordMask;
+	}
+
+	void BitKernel::stepMany(unsigned n)
+	{
+		const tc::ivec2 size{ static_cast<int>(m_WordsPerRow), static_cast<int>(m_Height) };
+		// a tile of 32 words by 256 rows and both generations of it fit in L2, the
+		// halo grows by a row every generation and by a word every 64.
+		tc::stencil::Blocking blocking{ .tileSize = tc::ivec2{ 32, 256 }, .cellsPerElement = tc::ivec2{ 64, 1 } };
+		const index lastWord = static_cast<index>(m_WordsPerRow) - 1;
+		tc::stencil::stepMany(
+			tc::stencil::Grid2D<const uint64_t>{ m_State0.data(), size, 1 },
+			tc::stencil::Grid2D<uint64_t>{ m_State1.data(), size, 1 },
+			n,
+			[&](const uint64_t* center, std::ptrdiff_t stride, uint64_t* out, int count, tc::ivec2 first) {
+				stepWords(center - stride, center, center + stride, out, count);
+				if (first.x + count - 1 == lastWord) {
+					out[count - 1] &= m_LastWordMask;
+				}
+			},
+			blocking);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,78 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace GameOfLife
+{
+	using index = ptrdiff_t;
+
+	// Game of Life with 64 cells per word.
+	// Cell x of a row is bit x % 64 of word x / 64. Every row has a zero word
+	// left and right of it and there is a zero row above and below the grid,
+	// so the neighbours of the border cells are dead like in the padded kernels.
+	// The neighbour count of 64 cells is computed at once with full adders on
+	// bit planes, with AVX2 or AVX-512 that is 256 or 512 cells at once.
+	class BitKernel
+	{
+	public:
+		static constexpr size_t CellsPerWord = 64;
+
+		BitKernel(size_t w, size_t h);
+
+		index wordIndex(index wx, index cy) const {
+			return (cy + 1) * m_Stride + (wx + 1);
+		}
+
+		void set0(index cx, index cy) {
+			m_State0[wordIndex(cx / CellsPerWord, cy)] |= uint64_t{ 1 } << (cx % CellsPerWord);
+		}
+
+		uint32_t get1(index cx, index cy) const {
+			return (m_State1[wordIndex(cx / CellsPerWord, cy)] >> (cx % CellsPerWord)) & 1u;
+		}
+
+		void dispatch();
+		// advances n generations into the second buffer, like n dispatches
+		// but in tiles that stay in cache.
+		void stepMany(unsigned n);
+
+		size_t getWidth() const {
+			return m_Width;
+		}
+
+		size_t getHeight() const {
+			return m_Height;
+		}
+
+		// words per row, including the zero word on either side.
+		size_t getStride() const {
+			return m_Stride;
+		}
+
+		// the packed state with padding, for the upload to the GPU kernel.
+		std::span<const uint64_t> getState0() const {
+			return m_State0;
+		}
+
+		std::span<const uint64_t> getState1() const {
+			return m_State1;
+		}
+
+		void swapBuffers() {
+			std::swap(m_State0, m_State1);
+		}
+	private:
+		void stepRow(index cy);
+
+		size_t m_Width;
+		size_t m_Height;
+		size_t m_WordsPerRow;
+		size_t m_Stride;
+		// clears the bits past the last cell of a row.
+		uint64_t m_LastWordMask;
+		std::vector<uint64_t> m_State0{};
+		std::vector<uint64_t> m_State1{};
+	};
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <iostream>
+#include "vec.hpp"
+#include "math/arithmetic.hpp"
+#include "computebackend.hpp"
+
+// The GPU counterpart of BitKernel, 32 cells per uint.
+// A packed row of BitKernel is read as uints, a 64 bit word is two uints with
+// the low cells in the first one, so the zero words around a row are pad = 2
+// uints wide and stride is twice the stride of BitKernel.
+struct [[clang::annotate("kernel")]] BitPackedKernel
+{
+	static constexpr char fileLocation[] = "gol_bitpacked";
+	tc::uvec3 local_size{ 64, 1, 1 };
+	tc::BufferBinding<tc::uint, 0> inData;
+	tc::BufferBinding<tc::uint, 1> outData;
+
+	// uints per row, including the padding on both sides.
+	tc::Uniform<tc::integer, 1> stride{ 6 };
+	// cells per row
+	tc::Uniform<tc::integer, 2> width{ 64 };
+
+	tc::SpecConstant<tc::integer, 0, 2> pad;
+
+	tc::uint sum(tc::uint a, tc::uint b, tc::uint c) {
+		return a ^ b ^ c;
+	}
+
+	tc::uint carry(tc::uint a, tc::uint b, tc::uint c) {
+		return (a & b) | (c & (a ^ b));
+	}
+
+	void main() {
+		using namespace tc;
+		uvec2 gId = tc::gl_GlobalInvocationID["xy"_sw];
+		int wx = int(gId.x);
+		// the dispatch is rounded up to whole groups, the invocations past
+		// the last word of a row must not touch the padding or the next row.
+		if (wx >= (width + 31) / 32) {
+			return;
+		}
+		int i = (int(gId.y) + 1) * stride + pad + wx;
+		int iUp = i - stride;
+		int iDown = i + stride;
+
+		uint c = inData[i];
+		uint u = inData[iUp];
+		uint d = inData[iDown];
+
+		// neighbours moved to the bit of the cell, the bit that crosses a
+		// word boundary comes from the word next to it.
+		uint uw = (u << 1u) | (inData[iUp - 1] >> 31u);
+		uint ue = (u >> 1u) | (inData[iUp + 1] << 31u);
+		uint w = (c << 1u) | (inData[i - 1] >> 31u);
+		uint e = (c >> 1u) | (inData[i + 1] << 31u);
+		uint dw = (d << 1u) | (inData[iDown - 1] >> 31u);
+		uint de = (d >> 1u) | (inData[iDown + 1] << 31u);
+
+		// bit planes of the neighbour count modulo 8
+		uint upSum = sum(uw, u, ue);
+		uint upCarry = carry(uw, ue, u);
+		uint downSum = sum(dw, d, de);
+		uint downCarry = carry(dw, de, d);
+		uint midSum = w ^ e;
+		uint midCarry = w & e;
+
+		uint s0 = sum(upSum, downSum, midSum);
+		uint onesCarry = carry(upSum, downSum, midSum);
+		uint twosSum = sum(upCarry, downCarry, midCarry);
+		uint twosCarry = carry(upCarry, downCarry, midCarry);
+		uint s1 = twosSum ^ onesCarry;
+		uint s2 = twosCarry ^ (twosSum & onesCarry);
+
+		// the last word of a row may extend past the grid.
+		uint mask = 0xFFFFFFFFu;
+		int cellsLeft = width - wx * 32;
+		if (cellsLeft < 32) {
+			mask = (1u << uint(cellsLeft)) - 1u;
+		}
+		outData[i] = ~s2 & s1 & (s0 | c) & mask;
+	}
+};
+
+struct [[clang::annotate("kernel")]] ConvertKernel
+{
+	static constexpr char fileLocation[] = "convert_bitpacked";
+	tc::uvec3 local_size{ 16, 16, 1 };
+
+	tc::BufferBinding<tc::uint, 0> inData;
+	tc::ImageBinding<tc::InternalFormat::RGBA8, tc::Dim::D2, tc::cpu::RGBA8UI, 1> outData;
+
+	std::array<tc::vec4, 3> colors{
+		tc::vec4(0    , 0  , 0  , 1.0),
+		tc::vec4(0.133, 0.7, 0.3, 1.0),
+		tc::vec4(1    , 0  , 0  , 1.0)
+	};
+
+	tc::Uniform<tc::integer, 1> stride{ 6 };
+	tc::Uniform<tc::integer, 2> width{ 64 };
+	tc::Uniform<tc::integer, 3> height{ 64 };
+
+	tc::SpecConstant<tc::integer, 0, 2> pad;
+	tc::SpecConstant<tc::integer, 1, 2> scale;
+
+	void main()
+	{
+		tc::uvec2 gId = tc::gl_GlobalInvocationID["xy"_sw];
+		tc::ivec2 rc = tc::ivec2(gId.x, gId.y);
+		tc::ivec2 cell = rc / scale;
+
+		if (cell.x < width && cell.y < height)
+		{
+			tc::uint word = inData[(cell.y + 1) * stride + pad + cell.x / 32];
+			tc::uint alive = (word >> tc::uint(cell.x % 32)) & 1u;
+			tc::imageStore(outData, rc, colors[alive]);
+		}
+		else {
+			tc::imageStore(outData, rc, colors[2]);
+		}
+	}
+};
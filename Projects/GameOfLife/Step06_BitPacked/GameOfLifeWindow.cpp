@@ -0,0 +1,101 @@
+#include "GameOfLifeWindow.h"
+#include "OpenGLBackend.hpp"
+
+#include <cstring>
+
+#include "kernel_intrinsics.hpp"
+#include "math/arithmetic.hpp"
+
+
+GameOfLifeWindow::GameOfLifeWindow(GLuint width, GLuint height)
+	:m_Engine{ width / decltype(ConvertKernel::scale)::value, height / decltype(ConvertKernel::scale)::value }
+{
+
+}
+
+GameOfLifeWindow::~GameOfLifeWindow()
+{
+}
+
+void GameOfLifeWindow::init(SurfaceRenderer& renderer)
+{
+	using namespace tc;
+	// a uint view of the 64 bit words, see BitPackedKernel.
+	integer stride = static_cast<integer>(2 * m_Engine.getStride());
+	integer N = static_cast<integer>(2 * m_Engine.getState0().size());
+	m_pDataIn.reset(new BufferResource<uint>{ N });
+	m_pDataOut.reset(new BufferResource<uint>{ N });
+
+	m_GameOfLife.stride = stride;
+	m_GameOfLife.width = static_cast<integer>(m_Engine.getWidth());
+	m_ConvertKernel.stride = stride;
+	m_ConvertKernel.width = static_cast<integer>(m_Engine.getWidth());
+	m_ConvertKernel.height = static_cast<integer>(m_Engine.getHeight());
+
+	// a glider and an R-pentomino
+	GameOfLife::index hw = m_Engine.getWidth() / 2;
+	GameOfLife::index hh = m_Engine.getHeight() / 2;
+	m_Engine.set0(hw + 1, hh);
+	m_Engine.set0(hw, hh + 1);
+	m_Engine.set0(hw + 1, hh + 1);
+	m_Engine.set0(hw + 1, hh + 2);
+	m_Engine.set0(hw + 2, hh + 2);
+
+	m_Engine.set0(hw / 2 + 1, hh / 2);
+	m_Engine.set0(hw / 2 + 2, hh / 2);
+	m_Engine.set0(hw / 2, hh / 2 + 1);
+	m_Engine.set0(hw / 2 + 1, hh / 2 + 1);
+	m_Engine.set0(hw / 2 + 1, hh / 2 + 2);
+
+	m_GameOfLife.inData.attach(m_pDataIn.get());
+	m_GameOfLife.outData.attach(m_pDataOut.get());
+	uploadState(m_Engine);
+
+	tc::gpu::GPUBackend gpu;
+	gpu.uploadBuffer(*m_pDataOut.get());
+
+	m_ConvertKernel.outData.attach(renderer.getRenderBuffer());
+}
+
+void GameOfLifeWindow::compute(SurfaceRenderer& renderer)
+{
+	using Backend = tc::gpu::GPUBackend;
+	Backend b;
+	if constexpr (UseCpuEngine) {
+		m_Engine.dispatch();
+		m_Engine.swapBuffers();
+		uploadState(m_Engine);
+	}
+	else {
+		b.useKernel(m_GameOfLife);
+		b.bindBuffer(m_GameOfLife.inData);
+		b.bindBuffer(m_GameOfLife.outData);
+		b.bindUniform(m_GameOfLife.stride);
+		b.bindUniform(m_GameOfLife.width);
+		tc::uint words = static_cast<tc::uint>((m_Engine.getWidth() + 31) / 32);
+		b.execute(m_GameOfLife, tc::uvec3{ words, static_cast<tc::uint>(m_Engine.getHeight()), 1u });
+
+		using std::swap;
+		swap(m_GameOfLife.inData, m_GameOfLife.outData);
+	}
+
+	b.useKernel(m_ConvertKernel);
+	m_ConvertKernel.inData.attach(m_GameOfLife.inData.getBufferData());
+	b.bindBuffer(m_ConvertKernel.inData);
+	b.bindImage(m_ConvertKernel.outData);
+	b.bindUniform(m_ConvertKernel.stride);
+	b.bindUniform(m_ConvertKernel.width);
+	b.bindUniform(m_ConvertKernel.height);
+	b.execute(m_ConvertKernel, tc::uvec3{ renderer.getWidth(),renderer.getHeight(),1 });
+}
+
+void GameOfLifeWindow::uploadState(const GameOfLife::BitKernel& engine)
+{
+	// little endian: the low cells of a 64 bit word are in the first uint.
+	std::span<const uint64_t> state = engine.getState0();
+	tc::BufferResource<tc::uint>* pBuffer = m_GameOfLife.inData.getBufferData();
+	std::memcpy(pBuffer->data(), state.data(), state.size_bytes());
+
+	tc::gpu::GPUBackend gpu;
+	gpu.uploadBuffer(*pBuffer);
+}
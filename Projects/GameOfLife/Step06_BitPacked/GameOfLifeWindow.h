@@ -0,0 +1,29 @@
+#pragma once
+#include "SurfaceRenderer.hpp"
+#include "ComputeShader.hpp"
+#include "GameOfLife.h"
+#include "BitKernel.hpp"
+#include "GL/glew.h"
+
+class GameOfLifeWindow
+{
+public:
+	GameOfLifeWindow(GLuint width, GLuint height);
+	~GameOfLifeWindow();
+
+	void init(SurfaceRenderer& renderer);
+	void compute(SurfaceRenderer& renderer);
+	
+private:
+	void uploadState(const GameOfLife::BitKernel& engine);
+
+	// steps on the CPU with BitKernel instead of with the compute shader.
+	static constexpr bool UseCpuEngine = false;
+
+	GameOfLife::BitKernel m_Engine;
+	BitPackedKernel m_GameOfLife;
+	std::unique_ptr<tc::BufferResource<tc::uint>> m_pDataIn;
+	std::unique_ptr<tc::BufferResource<tc::uint>> m_pDataOut;
+
+	ConvertKernel m_ConvertKernel;
+};
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <iostream>
+#include "vec.hpp"
+#include "math/arithmetic.hpp"
+#include "computebackend.hpp"
+
+// Shows the viewport that HashLife renders, one R8UI pixel per cell.
+struct [[clang::annotate("kernel")]] ConvertKernel
+{
+	static constexpr char fileLocation[] = "convert_hashlife";
+	tc::uvec3 local_size{ 16, 16, 1 };
+
+	tc::ImageBinding<tc::InternalFormat::R8UI, tc::Dim::D2, tc::cpu::R8UI, 0> inData;
+	tc::ImageBinding<tc::InternalFormat::RGBA8, tc::Dim::D2, tc::cpu::RGBA8UI, 1> outData;
+
+	std::array<tc::vec4, 3> colors{
+		tc::vec4(0    , 0  , 0  , 1.0),
+		tc::vec4(0.133, 0.7, 0.3, 1.0),
+		tc::vec4(1    , 0  , 0  , 1.0)
+	};
+
+	tc::SpecConstant<tc::integer, 0, 2> scale;
+
+	void main()
+	{
+		tc::uvec2 gId = tc::gl_GlobalInvocationID["xy"_sw];
+		tc::ivec2 rc = tc::ivec2(gId.x, gId.y);
+		tc::ivec2 coordinate = rc / scale;
+
+		tc::ivec2 dim = imageSize(inData);
+
+		if (coordinate.x < dim.x && coordinate.y < dim.y)
+		{
+			tc::uint alive = imageLoad(inData, coordinate).x;
+			tc::imageStore(outData, rc, colors[alive]);
+		}
+		else {
+			tc::imageStore(outData, rc, colors[2]);
+		}
+	}
+};
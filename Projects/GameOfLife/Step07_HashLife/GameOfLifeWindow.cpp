@@ -0,0 +1,70 @@
+#include "GameOfLifeWindow.h"
+#include "OpenGLBackend.hpp"
+
+#include <array>
+#include <string_view>
+
+#include "kernel_intrinsics.hpp"
+#include "math/arithmetic.hpp"
+#include "images/ImageFormat.hpp"
+
+
+GameOfLifeWindow::GameOfLifeWindow(GLuint width, GLuint height)
+{
+
+}
+
+GameOfLifeWindow::~GameOfLifeWindow()
+{
+}
+
+void GameOfLifeWindow::init(SurfaceRenderer& renderer)
+{
+	using namespace tc;
+	integer w = renderer.getWidth() / m_ConvertKernel.scale;
+	integer h = renderer.getHeight() / m_ConvertKernel.scale;
+	m_pView.reset(new BufferResource<tc::cpu::R8UI, tc::Dim::D2>{ ivec2{ w, h } });
+
+	// a Gosper glider gun, drawn in an image like the seed of the other steps.
+	constexpr std::array<std::string_view, 9> gun{
+		"........................O...........",
+		"......................O.O...........",
+		"............OO......OO............OO",
+		"...........O...O....OO............OO",
+		"OO........O.....O...OO..............",
+		"OO........O...O.OO....O.O...........",
+		"..........O.....O.......O...........",
+		"...........O...O....................",
+		"............OO......................"
+	};
+	BufferResource<tc::cpu::R8UI, tc::Dim::D2> seed{ ivec2{ static_cast<integer>(gun[0].size()), static_cast<integer>(gun.size()) } };
+	for (integer y = 0; y < static_cast<integer>(gun.size()); ++y) {
+		for (integer x = 0; x < static_cast<integer>(gun[y].size()); ++x) {
+			seed[ivec2{ x, y }] = tc::cpu::R8UI(gun[y][x] == 'O' ? 1 : 0);
+		}
+	}
+	m_Life.seed(seed, -w / 2 + 4, -h / 2 + 4);
+
+	m_Life.render(*m_pView, -w / 2, -h / 2);
+	tc::gpu::GPUBackend gpu;
+	gpu.uploadImage<tc::InternalFormat::R8UI>(*m_pView.get());
+
+	m_ConvertKernel.inData.attach(m_pView.get());
+	m_ConvertKernel.outData.attach(renderer.getRenderBuffer());
+}
+
+void GameOfLifeWindow::compute(SurfaceRenderer& renderer)
+{
+	using Backend = tc::gpu::GPUBackend;
+	Backend b;
+
+	m_Life.step(StepLog2);
+	tc::ivec2 dim = m_pView->getDimension();
+	m_Life.render(*m_pView, -dim.x / 2, -dim.y / 2);
+	b.uploadImage<tc::InternalFormat::R8UI>(*m_pView.get());
+
+	b.useKernel(m_ConvertKernel);
+	b.bindImage(m_ConvertKernel.inData);
+	b.bindImage(m_ConvertKernel.outData);
+	b.execute(m_ConvertKernel, tc::uvec3{ renderer.getWidth(),renderer.getHeight(),1 });
+}
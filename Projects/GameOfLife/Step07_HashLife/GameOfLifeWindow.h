@@ -0,0 +1,25 @@
+#pragma once
+#include "SurfaceRenderer.hpp"
+#include "ComputeShader.hpp"
+#include "GameOfLife.h"
+#include "HashLife.hpp"
+#include "GL/glew.h"
+
+class GameOfLifeWindow
+{
+public:
+	GameOfLifeWindow(GLuint width, GLuint height);
+	~GameOfLifeWindow();
+
+	void init(SurfaceRenderer& renderer);
+	void compute(SurfaceRenderer& renderer);
+	
+private:
+	// generations per frame, as a power of two.
+	static constexpr unsigned StepLog2 = 2;
+
+	GameOfLife::HashLife m_Life;
+	std::unique_ptr<tc::BufferResource<tc::cpu::R8UI, tc::Dim::D2>> m_pView;
+
+	ConvertKernel m_ConvertKernel;
+};
@@ -0,0 +1,340 @@
+#include "HashLife.hpp"
+#include <algorithm>
+
+namespace GameOfLife {
+
+	HashLife::HashLife()
+	{
+		m_Nodes.push_back(Node{ Dead, Dead, Dead, Dead, 0, 0, NoResult });
+		m_Nodes.push_back(Node{ Dead, Dead, Dead, Dead, 0, 1, NoResult });
+		m_Root = empty(3);
+	}
+
+	HashLife::NodeId HashLife::join(NodeId nw, NodeId ne, NodeId sw, NodeId se)
+	{
+		Key key{ nw, ne, sw, se };
+		auto it = m_Table.find(key);
+		if (it != m_Table.end()) {
+			return it->second;
+		}
+		uint64_t population = m_Nodes[nw].population + m_Nodes[ne].population
+			+ m_Nodes[sw].population + m_Nodes[se].population;
+		NodeId id = static_cast<NodeId>(m_Nodes.size());
+		m_Nodes.push_back(Node{ nw, ne, sw, se, m_Nodes[nw].level + 1, population, NoResult });
+		m_Table.emplace(key, id);
+		return id;
+	}
+
+	HashLife::NodeId HashLife::empty(uint32_t level)
+	{
+		if (level == 0) {
+			return Dead;
+		}
+		if (m_Empty.size() <= level) {
+			m_Empty.resize(level + 1, NoResult);
+		}
+		if (m_Empty[level] == NoResult) {
+			NodeId e = empty(level - 1);
+			m_Empty[level] = join(e, e, e, e);
+		}
+		return m_Empty[level];
+	}
+
+	// the node in the middle of an empty node of twice its size.
+	HashLife::NodeId HashLife::expand(NodeId id)
+	{
+		const Node n = m_Nodes[id];
+		NodeId e = empty(n.level - 1);
+		return join(
+			join(e, e, e, n.nw),
+			join(e, e, n.ne, e),
+			join(e, n.sw, e, e),
+			join(n.se, e, e, e));
+	}
+
+	// the middle of the node at half its size.
+	HashLife::NodeId HashLife::centre(NodeId id)
+	{
+		const Node n = m_Nodes[id];
+		return join(m_Nodes[n.nw].se, m_Nodes[n.ne].sw, m_Nodes[n.sw].ne, m_Nodes[n.se].nw);
+	}
+
+	// a 4x4 node, its centre one generation later.
+	HashLife::NodeId HashLife::baseSuccessor(NodeId id)
+	{
+		const Node n = m_Nodes[id];
+		int cells[4][4];
+		const NodeId quadrants[4] = { n.nw, n.ne, n.sw, n.se };
+		for (int q = 0; q < 4; ++q) {
+			const Node& quadrant = m_Nodes[quadrants[q]];
+			int x = (q % 2) * 2;
+			int y = (q / 2) * 2;
+			cells[y][x] = static_cast<int>(m_Nodes[quadrant.nw].population);
+			cells[y][x + 1] = static_cast<int>(m_Nodes[quadrant.ne].population);
+			cells[y + 1][x] = static_cast<int>(m_Nodes[quadrant.sw].population);
+			cells[y + 1][x + 1] = static_cast<int>(m_Nodes[quadrant.se].population);
+		}
+
+		NodeId next[2][2];
+		for (int y = 1; y <= 2; ++y) {
+			for (int x = 1; x <= 2; ++x) {
+				int count = 0;
+				for (int dy = -1; dy <= 1; ++dy) {
+					for (int dx = -1; dx <= 1; ++dx) {
+						if (dy || dx) {
+							count += cells[y + dy][x + dx];
+						}
+					}
+				}
+				bool alive = (count == 3) || (cells[y][x] && count == 2);
+				next[y - 1][x - 1] = alive ? Alive : Dead;
+			}
+		}
+		return join(next[0][0], next[0][1], next[1][0], next[1][1]);
+	}
+
+	// The centre of a level L node 2^min(j, L - 2) generations later, from
+	// nine overlapping nodes of level L - 1. When the step is the full
+	// 2^(L - 2) both halves of the time come from results one level down,
+	// for a smaller step the first half is skipped by taking the centres.
+	HashLife::NodeId HashLife::successor(NodeId id)
+	{
+		const Node n = m_Nodes[id];
+		if (n.result != NoResult) {
+			return n.result;
+		}
+		if (n.population == 0) {
+			NodeId result = empty(n.level - 1);
+			m_Nodes[id].result = result;
+			return result;
+		}
+		if (n.level == 2) {
+			NodeId result = baseSuccessor(id);
+			m_Nodes[id].result = result;
+			return result;
+		}
+
+		const Node nw = m_Nodes[n.nw];
+		const Node ne = m_Nodes[n.ne];
+		const Node sw = m_Nodes[n.sw];
+		const Node se = m_Nodes[n.se];
+		NodeId parts[3][3] = {
+			{ n.nw, join(nw.ne, ne.nw, nw.se, ne.sw), n.ne },
+			{ join(nw.sw, nw.se, sw.nw, sw.ne), join(nw.se, ne.sw, sw.ne, se.nw), join(ne.sw, ne.se, se.nw, se.ne) },
+			{ n.sw, join(sw.ne, se.nw, sw.se, se.sw), n.se }
+		};
+
+		const bool fullStep = m_StepLog2 >= n.level - 2;
+		for (auto& row : parts) {
+			for (NodeId& part : row) {
+				part = fullStep ? successor(part) : centre(part);
+			}
+		}
+
+		NodeId result = join(
+			successor(join(parts[0][0], parts[0][1], parts[1][0], parts[1][1])),
+			successor(join(parts[0][1], parts[0][2], parts[1][1], parts[1][2])),
+			successor(join(parts[1][0], parts[1][1], parts[2][0], parts[2][1])),
+			successor(join(parts[1][1], parts[1][2], parts[2][1], parts[2][2])));
+		m_Nodes[id].result = result;
+		return result;
+	}
+
+	HashLife::NodeId HashLife::setCell(NodeId id, int64_t x, int64_t y, bool alive)
+	{
+		const Node n = m_Nodes[id];
+		if (n.level == 0) {
+			return alive ? Alive : Dead;
+		}
+		int64_t half = int64_t{ 1 } << (n.level - 1);
+		if (y < half) {
+			return x < half
+				? join(setCell(n.nw, x, y, alive), n.ne, n.sw, n.se)
+				: join(n.nw, setCell(n.ne, x - half, y, alive), n.sw, n.se);
+		}
+		return x < half
+			? join(n.nw, n.ne, setCell(n.sw, x, y - half, alive), n.se)
+			: join(n.nw, n.ne, n.sw, setCell(n.se, x - half, y - half, alive));
+	}
+
+	// all cells are in the middle quarter of the node, the part that stays inside
+	// the result as a pattern grows at most at c/2 into empty space.
+	bool HashLife::isPadded(NodeId id) const
+	{
+		const Node& n = m_Nodes[id];
+		const Node& nw = m_Nodes[n.nw];
+		const Node& ne = m_Nodes[n.ne];
+		const Node& sw = m_Nodes[n.sw];
+		const Node& se = m_Nodes[n.se];
+		return nw.population == m_Nodes[m_Nodes[nw.se].se].population
+			&& ne.population == m_Nodes[m_Nodes[ne.sw].sw].population
+			&& sw.population == m_Nodes[m_Nodes[sw.ne].ne].population
+			&& se.population == m_Nodes[m_Nodes[se.nw].nw].population;
+	}
+
+	int64_t HashLife::halfSize() const
+	{
+		return int64_t{ 1 } << (m_Nodes[m_Root].level - 1);
+	}
+
+	void HashLife::set0(int64_t cx, int64_t cy, bool alive)
+	{
+		while (cx < -halfSize() || cx >= halfSize() || cy < -halfSize() || cy >= halfSize()) {
+			m_Root = expand(m_Root);
+		}
+		m_Root = setCell(m_Root, cx + halfSize(), cy + halfSize(), alive);
+	}
+
+	bool HashLife::get(int64_t cx, int64_t cy) const
+	{
+		int64_t half = halfSize();
+		if (cx < -half || cx >= half || cy < -half || cy >= half) {
+			return false;
+		}
+		int64_t x = cx + half;
+		int64_t y = cy + half;
+		NodeId id = m_Root;
+		while (m_Nodes[id].level > 0 && m_Nodes[id].population > 0) {
+			const Node& n = m_Nodes[id];
+			half = int64_t{ 1 } << (n.level - 1);
+			if (y < half) {
+				id = x < half ? n.nw : n.ne;
+			}
+			else {
+				id = x < half ? n.sw : n.se;
+				y -= half;
+			}
+			if (x >= half) {
+				x -= half;
+			}
+		}
+		return m_Nodes[id].population > 0;
+	}
+
+	void HashLife::seed(const Image& image, int64_t left, int64_t top)
+	{
+		tc::ivec2 dim = image.getDimension();
+		for (int y = 0; y < dim.y; ++y) {
+			for (int x = 0; x < dim.x; ++x) {
+				if (image[tc::ivec2{ x, y }].get<tc::Channel::R>() != 0) {
+					set0(left + x, top + y);
+				}
+			}
+		}
+	}
+
+	void HashLife::step(unsigned log2Generations)
+	{
+		if (log2Generations != m_StepLog2) {
+			for (Node& n : m_Nodes) {
+				n.result = NoResult;
+			}
+			m_StepLog2 = log2Generations;
+		}
+		while (m_Nodes[m_Root].level < m_StepLog2 + 2 || !isPadded(m_Root)) {
+			m_Root = expand(m_Root);
+		}
+		m_Root = successor(expand(m_Root));
+		m_Generation += uint64_t{ 1 } << m_StepLog2;
+
+		if (m_Nodes.size() > m_NodeLimit) {
+			collectGarbage();
+		}
+	}
+
+	void HashLife::render(Image& image, int64_t left, int64_t top, unsigned log2Scale) const
+	{
+		tc::ivec2 dim = image.getDimension();
+		for (int y = 0; y < dim.y; ++y) {
+			for (int x = 0; x < dim.x; ++x) {
+				image[tc::ivec2{ x, y }] = tc::cpu::R8UI(0);
+			}
+		}
+		renderNode(m_Root, -halfSize(), -halfSize(), image, left, top, log2Scale);
+	}
+
+	void HashLife::renderNode(NodeId id, int64_t x, int64_t y, Image& image,
+		int64_t left, int64_t top, unsigned log2Scale) const
+	{
+		const Node& n = m_Nodes[id];
+		if (n.population == 0) {
+			return;
+		}
+		tc::ivec2 dim = image.getDimension();
+		int64_t size = int64_t{ 1 } << n.level;
+		int64_t right = left + (int64_t{ dim.x } << log2Scale);
+		int64_t bottom = top + (int64_t{ dim.y } << log2Scale);
+		if (x + size <= left || y + size <= top || x >= right || y >= bottom) {
+			return;
+		}
+		if (n.level <= log2Scale) {
+			// the node is marked once it lies in a single pixel. A viewport
+			// that is not aligned to the pixel size splits the node over up to
+			// two pixels per axis, its quadrants then go to their own pixels.
+			int px = static_cast<int>((std::max(x, left) - left) >> log2Scale);
+			int py = static_cast<int>((std::max(y, top) - top) >> log2Scale);
+			int lastX = static_cast<int>((std::min(x + size, right) - 1 - left) >> log2Scale);
+			int lastY = static_cast<int>((std::min(y + size, bottom) - 1 - top) >> log2Scale);
+			if (px == lastX && py == lastY) {
+				image[tc::ivec2{ px, py }] = tc::cpu::R8UI(1);
+				return;
+			}
+		}
+		int64_t half = size / 2;
+		renderNode(n.nw, x, y, image, left, top, log2Scale);
+		renderNode(n.ne, x + half, y, image, left, top, log2Scale);
+		renderNode(n.sw, x, y + half, image, left, top, log2Scale);
+		renderNode(n.se, x + half, y + half, image, left, top, log2Scale);
+	}
+
+	void HashLife::collectGarbage()
+	{
+		// children are always created before their parents, so the ids of the
+		// children of a node are smaller than its own.
+		std::vector<bool> marked(m_Nodes.size(), false);
+		marked[Dead] = true;
+		marked[Alive] = true;
+		std::vector<NodeId> stack{ m_Root };
+		while (!stack.empty()) {
+			NodeId id = stack.back();
+			stack.pop_back();
+			if (marked[id]) {
+				continue;
+			}
+			marked[id] = true;
+			const Node& n = m_Nodes[id];
+			stack.insert(stack.end(), { n.nw, n.ne, n.sw, n.se });
+		}
+
+		std::vector<NodeId> remap(m_Nodes.size(), NoResult);
+		std::vector<Node> nodes;
+		m_Table.clear();
+		for (NodeId id = 0; id < m_Nodes.size(); ++id) {
+			if (!marked[id]) {
+				continue;
+			}
+			Node n = m_Nodes[id];
+			remap[id] = static_cast<NodeId>(nodes.size());
+			if (n.level > 0) {
+				n.nw = remap[n.nw];
+				n.ne = remap[n.ne];
+				n.sw = remap[n.sw];
+				n.se = remap[n.se];
+				m_Table.emplace(Key{ n.nw, n.ne, n.sw, n.se }, remap[id]);
+			}
+			nodes.push_back(n);
+		}
+		for (Node& n : nodes) {
+			if (n.result != NoResult) {
+				n.result = remap[n.result];
+			}
+		}
+		for (NodeId& e : m_Empty) {
+			if (e != NoResult) {
+				e = remap[e];
+			}
+		}
+		m_Root = remap[m_Root];
+		m_Nodes = std::move(nodes);
+	}
+}
@@ -0,0 +1,110 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+#include "kernel_intrinsics.hpp"
+
+namespace GameOfLife
+{
+	// Game of Life on an unbounded universe with HashLife.
+	// The universe is a quadtree with 2^level cells on a side, every distinct
+	// node is stored once in a hash table so a pattern that repeats in space
+	// shares its nodes. A node of level L caches its result: the centre of the
+	// node, half its size, 2^min(j, L - 2) generations later with 2^j the step
+	// size. Repetition in time then turns into cache hits.
+	// The root is centred on cell (0, 0), x goes right and y goes down.
+	class HashLife
+	{
+	public:
+		using NodeId = uint32_t;
+		using Image = tc::BufferResource<tc::cpu::R8UI, tc::Dim::D2>;
+
+		HashLife();
+
+		void set0(int64_t cx, int64_t cy, bool alive = true);
+		bool get(int64_t cx, int64_t cy) const;
+
+		// sets the cells of the non zero pixels, pixel (0, 0) is cell (left, top).
+		void seed(const Image& image, int64_t left, int64_t top);
+
+		// advances the universe 2^log2Generations generations.
+		void step(unsigned log2Generations);
+
+		// writes the viewport with top left cell (left, top) to image, one
+		// pixel per 2^log2Scale cells, a pixel is 1 when any of its cells lives.
+		void render(Image& image, int64_t left, int64_t top, unsigned log2Scale = 0) const;
+
+		// drops the nodes that are no longer part of the universe and the
+		// cached results that point to them.
+		void collectGarbage();
+
+		// step collects garbage when the table grows past this number of nodes.
+		void setNodeLimit(size_t nodeLimit) {
+			m_NodeLimit = nodeLimit;
+		}
+
+		size_t getNodeCount() const {
+			return m_Nodes.size();
+		}
+
+		uint64_t getPopulation() const {
+			return m_Nodes[m_Root].population;
+		}
+
+		uint64_t getGeneration() const {
+			return m_Generation;
+		}
+
+	private:
+		static constexpr NodeId Dead = 0;
+		static constexpr NodeId Alive = 1;
+		static constexpr NodeId NoResult = ~NodeId{ 0 };
+
+		struct Node {
+			NodeId nw, ne, sw, se;
+			uint32_t level;
+			uint64_t population;
+			NodeId result;
+		};
+
+		struct Key {
+			NodeId nw, ne, sw, se;
+			bool operator==(const Key&) const = default;
+		};
+
+		struct KeyHash {
+			size_t operator()(const Key& k) const {
+				uint64_t h = k.nw;
+				h = h * 0x9E3779B97F4A7C15ull + k.ne;
+				h = h * 0x9E3779B97F4A7C15ull + k.sw;
+				h = h * 0x9E3779B97F4A7C15ull + k.se;
+				return static_cast<size_t>(h ^ (h >> 29));
+			}
+		};
+
+		NodeId join(NodeId nw, NodeId ne, NodeId sw, NodeId se);
+		NodeId empty(uint32_t level);
+		NodeId expand(NodeId id);
+		NodeId centre(NodeId id);
+		NodeId successor(NodeId id);
+		NodeId baseSuccessor(NodeId id);
+		NodeId setCell(NodeId id, int64_t x, int64_t y, bool alive);
+		bool isPadded(NodeId id) const;
+		int64_t halfSize() const;
+
+		void renderNode(NodeId id, int64_t x, int64_t y, Image& image,
+			int64_t left, int64_t top, unsigned log2Scale) const;
+
+		std::vector<Node> m_Nodes;
+		std::unordered_map<Key, NodeId, KeyHash> m_Table;
+		// the empty node of every level, NoResult until it is created.
+		std::vector<NodeId> m_Empty;
+		NodeId m_Root;
+		// the results in the nodes are for steps of 2^m_StepLog2 generations.
+		unsigned m_StepLog2{ 0 };
+		uint64_t m_Generation{ 0 };
+		size_t m_NodeLimit{ 1u << 22 };
+	};
+}
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <iostream>
+#include "vec.hpp"
+#include "math/arithmetic.hpp"
+#include "computebackend.hpp"
+
+// One work group steps one tile of the active tile list, it is dispatched
+// with executeIndirect so the number of groups never leaves the GPU.
+// A tile in which a cell changed sets its flag in changed.
+struct [[clang::annotate("kernel")]] TileStepKernel
+{
+	static constexpr char fileLocation[] = "gol_tile_step";
+	tc::uvec3 local_size{ 16, 16, 1 };
+	tc::BufferBinding<tc::uint, 0> inData;
+	tc::BufferBinding<tc::uint, 1> outData;
+	tc::BufferBinding<tc::uint, 2> activeTiles;
+	tc::BufferBinding<tc::uint, 3> changed;
+
+	tc::Uniform<tc::integer, 1> width{ 16 };
+	tc::Uniform<tc::integer, 2> height{ 16 };
+	tc::Uniform<tc::integer, 3> tilesX{ 1 };
+
+	// equal to local_size
+	tc::SpecConstant<tc::integer, 0, 16> tileSize;
+
+	int coordinateToIndex(int cx, int cy) {
+		return (cy + 1) * (width + 2) + (cx + 1);
+	}
+
+	void main() {
+		using namespace tc;
+		uint tile = activeTiles[gl_WorkGroupID.x];
+		uvec2 local = gl_LocalInvocationID["xy"_sw];
+		int cx = (int(tile) % tilesX) * tileSize + int(local.x);
+		int cy = (int(tile) / tilesX) * tileSize + int(local.y);
+		if (cx < width && cy < height) {
+			uint n = 0;
+			for (int dy = -1; dy <= 1; ++dy)
+			{
+				for (int dx = -1; dx <= 1; ++dx)
+				{
+					if (dy || dx) {
+						n += inData[coordinateToIndex(cx + dx, cy + dy)];
+					}
+				}
+			}
+			int cellIndex = coordinateToIndex(cx, cy);
+			uint alive = inData[cellIndex];
+			uint next = uint((n == 3) || (alive == 1 && n == 2));
+			outData[cellIndex] = next;
+			if (next != alive) {
+				changed[tile] = 1u;
+			}
+		}
+	}
+};
+
+// Sets the group count of the indirect dispatch to 0, before compaction.
+struct [[clang::annotate("kernel")]] ResetArgsKernel
+{
+	static constexpr char fileLocation[] = "gol_reset_args";
+	tc::uvec3 local_size{ 1, 1, 1 };
+	tc::BufferBinding<tc::uint, 0> dispatchArgs;
+
+	void main() {
+		dispatchArgs[0] = 0u;
+		dispatchArgs[1] = 1u;
+		dispatchArgs[2] = 1u;
+	}
+};
+
+// Lists every tile with a changed tile in its 3x3 neighbourhood and counts
+// them in the group count of the indirect dispatch. Also clears the flags
+// that the next step writes to.
+struct [[clang::annotate("kernel")]] CompactTilesKernel
+{
+	static constexpr char fileLocation[] = "gol_compact_tiles";
+	tc::uvec3 local_size{ 64, 1, 1 };
+	tc::BufferBinding<tc::uint, 0> changed;
+	tc::BufferBinding<tc::uint, 1> nextChanged;
+	tc::BufferBinding<tc::uint, 2> activeTiles;
+	tc::BufferBinding<tc::uint, 3> dispatchArgs;
+
+	tc::Uniform<tc::integer, 1> tilesX{ 1 };
+	tc::Uniform<tc::integer, 2> tilesY{ 1 };
+
+	void main() {
+		using namespace tc;
+		int tile = int(gl_GlobalInvocationID.x);
+		if (tile < tilesX * tilesY) {
+			int tx = tile % tilesX;
+			int ty = tile / tilesX;
+			bool active = false;
+			for (int y = ty - 1; y <= ty + 1; ++y) {
+				for (int x = tx - 1; x <= tx + 1; ++x) {
+					if (x >= 0 && y >= 0 && x < tilesX && y < tilesY && changed[y * tilesX + x] != 0u) {
+						active = true;
+					}
+				}
+			}
+			nextChanged[tile] = 0u;
+			if (active) {
+				uint slot = atomicAdd(dispatchArgs[0], 1u);
+				activeTiles[slot] = uint(tile);
+			}
+		}
+	}
+};
+
+struct [[clang::annotate("kernel")]] ConvertKernel
+{
+	static constexpr char fileLocation[] = "convert_sparse";
+	tc::uvec3 local_size{ 16, 16, 1 };
+
+	tc::BufferBinding<tc::uint, 0> inData;
+	tc::ImageBinding<tc::InternalFormat::RGBA8, tc::Dim::D2, tc::cpu::RGBA8UI, 1> outData;
+
+	std::array<tc::vec4, 3> colors{
+		tc::vec4(0    , 0  , 0  , 1.0),
+		tc::vec4(0.133, 0.7, 0.3, 1.0),
+		tc::vec4(1    , 0  , 0  , 1.0)
+	};
+
+	tc::Uniform<tc::integer, 1> width{ 16 };
+	tc::Uniform<tc::integer, 2> height{ 16 };
+
+	tc::SpecConstant<tc::integer, 0, 2> scale;
+
+	void main()
+	{
+		tc::uvec2 gId = tc::gl_GlobalInvocationID["xy"_sw];
+		tc::ivec2 rc = tc::ivec2(gId.x, gId.y);
+		tc::ivec2 cell = rc / scale;
+
+		if (cell.x < width && cell.y < height)
+		{
+			tc::uint alive = inData[(cell.y + 1) * (width + 2) + cell.x + 1];
+			tc::imageStore(outData, rc, colors[alive]);
+		}
+		else {
+			tc::imageStore(outData, rc, colors[2]);
+		}
+	}
+};
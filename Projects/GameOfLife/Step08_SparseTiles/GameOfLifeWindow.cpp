@@ -0,0 +1,151 @@
+#include "GameOfLifeWindow.h"
+#include "OpenGLBackend.hpp"
+
+#include <algorithm>
+
+#include "kernel_intrinsics.hpp"
+#include "math/arithmetic.hpp"
+
+
+GameOfLifeWindow::GameOfLifeWindow(GLuint width, GLuint height)
+	:m_Engine{ width / decltype(ConvertKernel::scale)::value, height / decltype(ConvertKernel::scale)::value,
+		decltype(TileStepKernel::tileSize)::value }
+{
+
+}
+
+GameOfLifeWindow::~GameOfLifeWindow()
+{
+}
+
+void GameOfLifeWindow::init(SurfaceRenderer& renderer)
+{
+	using namespace tc;
+	integer w = renderer.getWidth() / m_ConvertKernel.scale;
+	integer h = renderer.getHeight() / m_ConvertKernel.scale;
+	integer tileSize = m_Step.tileSize;
+	integer tilesX = (w + tileSize - 1) / tileSize;
+	integer tilesY = (h + tileSize - 1) / tileSize;
+	m_TileCount = tilesX * tilesY;
+
+	m_Step.width = w;
+	m_Step.height = h;
+	m_Step.tilesX = tilesX;
+	m_Compact.tilesX = tilesX;
+	m_Compact.tilesY = tilesY;
+	m_ConvertKernel.width = w;
+	m_ConvertKernel.height = h;
+
+	m_pDataIn.reset(new Buffer{ (w + 2) * (h + 2) });
+	m_pDataOut.reset(new Buffer{ (w + 2) * (h + 2) });
+	m_pActiveTiles.reset(new Buffer{ m_TileCount });
+	m_pChanged.reset(new Buffer{ m_TileCount });
+	m_pNextChanged.reset(new Buffer{ m_TileCount });
+	m_pDispatchArgs.reset(new Buffer{ 3 });
+
+	// an R-pentomino and a glider, the rest of the board stays idle.
+	setCellIn(w / 2 + 1, h / 2);
+	setCellIn(w / 2 + 2, h / 2);
+	setCellIn(w / 2, h / 2 + 1);
+	setCellIn(w / 2 + 1, h / 2 + 1);
+	setCellIn(w / 2 + 1, h / 2 + 2);
+
+	setCellIn(9, 8);
+	setCellIn(10, 9);
+	setCellIn(8, 10);
+	setCellIn(9, 10);
+	setCellIn(10, 10);
+
+	// the first step runs every tile.
+	for (integer tile = 0; tile < m_TileCount; ++tile) {
+		(*m_pActiveTiles)[tile] = static_cast<uint>(tile);
+	}
+	(*m_pDispatchArgs)[0] = static_cast<uint>(m_TileCount);
+	(*m_pDispatchArgs)[1] = 1;
+	(*m_pDispatchArgs)[2] = 1;
+
+	m_Step.inData.attach(m_pDataIn.get());
+	m_Step.outData.attach(m_pDataOut.get());
+	m_Step.activeTiles.attach(m_pActiveTiles.get());
+	m_Step.changed.attach(m_pChanged.get());
+
+	m_ResetArgs.dispatchArgs.attach(m_pDispatchArgs.get());
+
+	m_Compact.changed.attach(m_pChanged.get());
+	m_Compact.nextChanged.attach(m_pNextChanged.get());
+	m_Compact.activeTiles.attach(m_pActiveTiles.get());
+	m_Compact.dispatchArgs.attach(m_pDispatchArgs.get());
+
+	tc::gpu::GPUBackend gpu;
+	for (Buffer* pBuffer : { m_pDataIn.get(), m_pDataOut.get(), m_pActiveTiles.get(),
+		m_pChanged.get(), m_pNextChanged.get(), m_pDispatchArgs.get() }) {
+		gpu.uploadBuffer(*pBuffer);
+	}
+
+	m_ConvertKernel.outData.attach(renderer.getRenderBuffer());
+}
+
+void GameOfLifeWindow::compute(SurfaceRenderer& renderer)
+{
+	using Backend = tc::gpu::GPUBackend;
+	Backend b;
+	if constexpr (UseCpuEngine) {
+		m_Engine.dispatch();
+		m_Engine.swapBuffers();
+		uploadState(m_Engine);
+	}
+	else {
+		b.useKernel(m_Step);
+		b.bindBuffer(m_Step.inData);
+		b.bindBuffer(m_Step.outData);
+		b.bindBuffer(m_Step.activeTiles);
+		b.bindBuffer(m_Step.changed);
+		b.bindUniform(m_Step.width);
+		b.bindUniform(m_Step.height);
+		b.bindUniform(m_Step.tilesX);
+		b.executeIndirect(m_Step, *m_pDispatchArgs);
+
+		b.useKernel(m_ResetArgs);
+		b.bindBuffer(m_ResetArgs.dispatchArgs);
+		b.execute(m_ResetArgs, tc::uvec3{ 1u, 1u, 1u });
+
+		b.useKernel(m_Compact);
+		b.bindBuffer(m_Compact.changed);
+		b.bindBuffer(m_Compact.nextChanged);
+		b.bindBuffer(m_Compact.activeTiles);
+		b.bindBuffer(m_Compact.dispatchArgs);
+		b.bindUniform(m_Compact.tilesX);
+		b.bindUniform(m_Compact.tilesY);
+		b.execute(m_Compact, tc::uvec3{ static_cast<tc::uint>(m_TileCount), 1u, 1u });
+
+		// the cleared flags are written by the next step.
+		using std::swap;
+		swap(m_Step.inData, m_Step.outData);
+		swap(m_Step.changed, m_Compact.nextChanged);
+	}
+
+	b.useKernel(m_ConvertKernel);
+	m_ConvertKernel.inData.attach(m_Step.inData.getBufferData());
+	b.bindBuffer(m_ConvertKernel.inData);
+	b.bindImage(m_ConvertKernel.outData);
+	b.bindUniform(m_ConvertKernel.width);
+	b.bindUniform(m_ConvertKernel.height);
+	b.execute(m_ConvertKernel, tc::uvec3{ renderer.getWidth(),renderer.getHeight(),1 });
+}
+
+void GameOfLifeWindow::setCellIn(int c, int r)
+{
+	(*m_pDataIn)[(r + 1) * (m_Step.width + 2) + c + 1] = 1;
+	m_Engine.set0(c, r);
+}
+
+void GameOfLifeWindow::uploadState(const GameOfLife::SparseKernel& engine)
+{
+	// the same padded layout, a byte per cell on the CPU and a uint on the GPU.
+	std::span<const uint8_t> state = engine.getState0();
+	Buffer* pBuffer = m_Step.inData.getBufferData();
+	std::copy(state.begin(), state.end(), pBuffer->data());
+
+	tc::gpu::GPUBackend gpu;
+	gpu.uploadBuffer(*pBuffer);
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include "SurfaceRenderer.hpp"
+#include "ComputeShader.hpp"
+#include "GameOfLife.h"
+#include "SparseKernel.hpp"
+#include "GL/glew.h"
+
+class GameOfLifeWindow
+{
+public:
+	GameOfLifeWindow(GLuint width, GLuint height);
+	~GameOfLifeWindow();
+
+	void init(SurfaceRenderer& renderer);
+	void compute(SurfaceRenderer& renderer);
+	void setCellIn(int c, int r);
+	
+private:
+	using Buffer = tc::BufferResource<tc::uint>;
+
+	void uploadState(const GameOfLife::SparseKernel& engine);
+
+	// steps on the CPU with SparseKernel instead of with the compute shaders.
+	static constexpr bool UseCpuEngine = false;
+
+	GameOfLife::SparseKernel m_Engine;
+	TileStepKernel m_Step;
+	ResetArgsKernel m_ResetArgs;
+	CompactTilesKernel m_Compact;
+	ConvertKernel m_ConvertKernel;
+
+	std::unique_ptr<Buffer> m_pDataIn;
+	std::unique_ptr<Buffer> m_pDataOut;
+	std::unique_ptr<Buffer> m_pActiveTiles;
+	std::unique_ptr<Buffer> m_pChanged;
+	std::unique_ptr<Buffer> m_pNextChanged;
+	// group count x, y and z of the tile step.
+	std::unique_ptr<Buffer> m_pDispatchArgs;
+
+	tc::integer m_TileCount{ 0 };
+};
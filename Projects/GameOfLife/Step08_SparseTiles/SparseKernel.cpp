@@ -0,0 +1,52 @@
+#include "SparseKernel.hpp"
+#include <algorithm>
+
+namespace GameOfLife {
+
+	SparseKernel::SparseKernel(size_t w, size_t h, int tileSize) :
+		m_Width{ w },
+		m_Height{ h },
+		m_PaddedWidth{ w + 2 },
+		m_Tiles{ tc::ivec2{ static_cast<int>(w), static_cast<int>(h) }, tc::ivec2{ tileSize, tileSize } },
+		m_State0(m_PaddedWidth* (h + 2), 0u),
+		m_State1(m_State0.size(), 0u)
+	{
+
+	}
+
+	void SparseKernel::dispatch()
+	{
+		// the tiles that changed in the previous dispatch, or were seeded.
+		m_Tiles.compact();
+		m_Tiles.forEachActive([&](const uint32_t tile) {
+			stepTile(tile);
+			});
+	}
+
+	void SparseKernel::stepTile(uint32_t tile)
+	{
+		const tc::ivec2 origin = m_Tiles.tileOrigin(tile);
+		const tc::ivec2 size = m_Tiles.getTileSize();
+		const index endX = std::min<index>(origin.x + size.x, m_Width);
+		const index endY = std::min<index>(origin.y + size.y, m_Height);
+		const index w = m_PaddedWidth;
+
+		bool changed = false;
+		for (index r = origin.y; r < endY; ++r) {
+			for (index c = origin.x; c < endX; ++c) {
+				const index i = coordinateToIndex(c, r);
+				const uint8_t* s = m_State0.data();
+				int n = s[i - w - 1] + s[i - w] + s[i - w + 1]
+					+ s[i - 1] + s[i + 1]
+					+ s[i + w - 1] + s[i + w] + s[i + w + 1];
+				uint8_t alive = s[i];
+				uint8_t next = (n == 3) || (alive && n == 2);
+				m_State1[i] = next;
+				changed |= next != alive;
+			}
+		}
+		if (changed) {
+			m_Tiles.markChanged(tile);
+		}
+	}
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <span>
+
+#include "sparse/ActiveTiles.hpp"
+
+namespace GameOfLife
+{
+	using index = ptrdiff_t;
+
+	// Game of Life that only steps the tiles around the cells that changed in
+	// the previous generation, a stable or empty part of the board costs nothing.
+	// The cells are padded with one dead cell on every side, like Kernel(w, h, 1).
+	class SparseKernel
+	{
+	public:
+		SparseKernel(size_t w, size_t h, int tileSize = 32);
+
+		index coordinateToIndex(index cx, index cy) const {
+			return (cy + 1) * m_PaddedWidth + (cx + 1);
+		}
+
+		// the tile of the cell runs in the next dispatch.
+		void set0(index cx, index cy) {
+			m_State0[coordinateToIndex(cx, cy)] = 1;
+			m_Tiles.markChanged(m_Tiles.tileOf(tc::ivec2{ static_cast<int>(cx), static_cast<int>(cy) }));
+		}
+
+		uint32_t get1(index cx, index cy) const {
+			return m_State1[coordinateToIndex(cx, cy)];
+		}
+
+		// the padded cells, a byte per cell.
+		std::span<const uint8_t> getState0() const {
+			return m_State0;
+		}
+
+		void dispatch();
+
+		size_t getWidth() const {
+			return m_Width;
+		}
+
+		size_t getHeight() const {
+			return m_Height;
+		}
+
+		// tiles stepped by the last dispatch.
+		size_t getActiveTileCount() const {
+			return m_Tiles.getActive().size();
+		}
+
+		void swapBuffers() {
+			std::swap(m_State0, m_State1);
+		}
+	private:
+		void stepTile(uint32_t tile);
+
+		size_t m_Width;
+		size_t m_Height;
+		size_t m_PaddedWidth;
+		tc::sparse::ActiveTiles m_Tiles;
+		std::vector<uint8_t> m_State0{};
+		std::vector<uint8_t> m_State1{};
+	};
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "vec.hpp"
+#include "computebackend.hpp"
+
+// red and green are the x and y coordinate of the pixel, in 1/255.
+struct [[clang::annotate("kernel")]] Gradient
+{
+	static constexpr char fileLocation[] = "gradient";
+
+	tc::uvec3 local_size{ 16, 16, 1 };
+	tc::ImageBinding<tc::InternalFormat::RGBA8, tc::Dim::D2, tc::cpu::RGBA8UI, 0> image;
+
+	tc::Uniform<tc::integer, 1> width{ 0 };
+	tc::Uniform<tc::integer, 2> height{ 0 };
+
+	void main() {
+		tc::uvec2 gId = tc::gl_GlobalInvocationID["xy"_sw];
+		tc::ivec2 pixel = tc::ivec2(gId.x, gId.y);
+		if (pixel.x < width && pixel.y < height) {
+			tc::imageStore(image, pixel, tc::vec4(float(pixel.x) / 255.0f, float(pixel.y) / 255.0f, 0.0f, 1.0f));
+		}
+	}
+};
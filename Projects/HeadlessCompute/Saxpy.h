@@ -0,0 +1,24 @@
+#pragma once
+
+#include "vec.hpp"
+#include "computebackend.hpp"
+
+// y = a * x + y
+struct [[clang::annotate("kernel")]] Saxpy
+{
+	static constexpr char fileLocation[] = "saxpy";
+
+	tc::uvec3 local_size{ 256, 1, 1 };
+	tc::BufferBinding<float, 0> x;
+	tc::BufferBinding<float, 1> y;
+
+	tc::Uniform<float, 1> a{ 2.0f };
+	tc::Uniform<tc::uint, 2> count{ 0 };
+
+	void main() {
+		tc::uint i = tc::gl_GlobalInvocationID.x;
+		if (i < count) {
+			y[i] = a * x[i] + y[i];
+		}
+	}
+};
@@ -0,0 +1,160 @@
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "vec.hpp"
+#include "OpenGLBackend.hpp"
+#include "HeadlessContext.hpp"
+#include "FrameWriter.h"
+#include "Saxpy.h"
+#include "Gradient.h"
+
+namespace {
+	// runs y = 2x + y ten times and checks it against the CPU.
+	bool runSaxpy(tc::gpu::HeadlessContext& context)
+	{
+		const tc::uint N = 1u << 20;
+		tc::BufferResource<float> x{ static_cast<tc::integer>(N) };
+		tc::BufferResource<float> y{ static_cast<tc::integer>(N) };
+		x.randomize(0, 100);
+		y.randomize(0, 100);
+		std::vector<float> expected(y.data(), y.data() + N);
+
+		Saxpy kernel;
+		kernel.x.attach(&x);
+		kernel.y.attach(&y);
+		kernel.count = N;
+
+		tc::gpu::GPUBackend gpu;
+		gpu.uploadBuffer(x);
+		gpu.uploadBuffer(y);
+		gpu.useKernel(kernel);
+		gpu.bindBuffer(kernel.x);
+		gpu.bindBuffer(kernel.y);
+		gpu.bindUniform(kernel.a);
+		gpu.bindUniform(kernel.count);
+
+		const int runs = 10;
+		gpu.execute(kernel, tc::uvec3{ N, 1, 1 });
+		context.finish();
+		auto start = std::chrono::steady_clock::now();
+		for (int i = 1; i < runs; ++i) {
+			gpu.execute(kernel, tc::uvec3{ N, 1, 1 });
+		}
+		context.finish();
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+		gpu.downloadBuffer(y);
+
+		for (tc::uint i = 0; i < N; ++i) {
+			for (int r = 0; r < runs; ++r) {
+				expected[i] = 2.0f * x.data()[i] + expected[i];
+			}
+			if (std::abs(y.data()[i] - expected[i]) > 1e-3f * std::abs(expected[i])) {
+				std::cerr << "Element " << i << " is " << y.data()[i] << " instead of " << expected[i] << std::endl;
+				return false;
+			}
+		}
+		std::cout << "saxpy of " << N << " floats: " << elapsed.count() / (runs - 1) << " ms per dispatch" << std::endl;
+		return true;
+	}
+
+	// renders a gradient on the GPU and records it with FrameWriter, which
+	// downloads the image.
+	bool runFrameReadback()
+	{
+		const tc::ivec2 size{ 64, 48 };
+		tc::BufferResource<tc::cpu::RGBA8UI, tc::Dim::D2> image{ size };
+
+		Gradient kernel;
+		kernel.image.attach(&image);
+		kernel.width = size.x;
+		kernel.height = size.y;
+
+		tc::gpu::GPUBackend gpu;
+		gpu.uploadImage<tc::InternalFormat::RGBA8>(image);
+		gpu.useKernel(kernel);
+		gpu.bindImage(kernel.image);
+		gpu.bindUniform(kernel.width);
+		gpu.bindUniform(kernel.height);
+		gpu.execute(kernel, tc::uvec3{ tc::uint(size.x), tc::uint(size.y), 1u });
+
+		const std::filesystem::path directory = std::filesystem::temp_directory_path() / "tc_headless_frames";
+		std::filesystem::remove_all(directory);
+		{
+			tc::assets::FrameWriter writer{ { directory, "gradient", tc::assets::FrameFormat::PAM, 2, 1 } };
+			writer.submit(gpu, image);
+			writer.finish();
+		}
+
+		std::ifstream file{ directory / "gradient_000000.pam", std::ios::binary };
+		const std::vector<uint8_t> bytes{ std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+		std::filesystem::remove_all(directory);
+		const size_t pixelCount = size_t(size.x) * size.y;
+		if (bytes.size() < pixelCount * 4) {
+			std::cerr << "The recorded frame has " << bytes.size() << " bytes." << std::endl;
+			return false;
+		}
+		const uint8_t* pixels = bytes.data() + bytes.size() - pixelCount * 4;
+		for (int y = 0; y < size.y; ++y) {
+			for (int x = 0; x < size.x; ++x) {
+				const uint8_t* p = pixels + (size_t(y) * size.x + x) * 4;
+				if (p[0] != x || p[1] != y || p[3] != 255) {
+					std::cerr << "Pixel " << x << ", " << y << " is " << int(p[0]) << ", " << int(p[1])
+						<< " in the recorded frame." << std::endl;
+					return false;
+				}
+			}
+		}
+		std::cout << "recorded a " << size.x << "x" << size.y << " frame rendered on the GPU" << std::endl;
+		return true;
+	}
+}
+
+// Creates a headless context, runs a dispatch and checks it against the CPU,
+// then records a frame rendered on the GPU.
+// The first argument picks the api: native, egl or osmesa, any by default.
+// Returns 77 when no such context can be created, ctest counts it as skipped.
+int main(int argc, char** argv)
+{
+	tc::gpu::HeadlessApi api = tc::gpu::HeadlessApi::Any;
+	if (argc > 1) {
+		if (std::strcmp(argv[1], "native") == 0) {
+			api = tc::gpu::HeadlessApi::Native;
+		}
+		else if (std::strcmp(argv[1], "egl") == 0) {
+			api = tc::gpu::HeadlessApi::EGL;
+		}
+		else if (std::strcmp(argv[1], "osmesa") == 0) {
+			api = tc::gpu::HeadlessApi::OSMesa;
+		}
+	}
+
+	std::unique_ptr<tc::gpu::HeadlessContext> pContext;
+	try {
+		pContext = std::make_unique<tc::gpu::HeadlessContext>(false, api);
+	}
+	catch (const std::exception& e) {
+		std::cerr << "Skipped: " << e.what() << std::endl;
+		return 77;
+	}
+	const char* apiNames[] = { "any", "native", "egl", "osmesa" };
+	std::cout << pContext->getRenderer() << ", " << pContext->getVersion()
+		<< " (" << apiNames[static_cast<int>(pContext->getApi())] << ")" << std::endl;
+
+	try {
+		if (!runSaxpy(*pContext) || !runFrameReadback()) {
+			return EXIT_FAILURE;
+		}
+	}
+	catch (const std::exception& e) {
+		std::cerr << "An exception occurred: " << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+	return 0;
+}
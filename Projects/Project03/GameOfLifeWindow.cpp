@@ -8,7 +8,6 @@
 
 
 GameOfLifeWindow::GameOfLifeWindow(GLuint width, GLuint height)
-	:m_pImage1{nullptr},m_pImage2{nullptr}
 {
 
 }
@@ -21,12 +20,12 @@ void GameOfLifeWindow::init(SurfaceRenderer& renderer)
 {
 	m_pImage1 =
 		tc::assets::loadImage<tc::cpu::R8UI>("patterns/methuselah.png");
-	m_GameOfLife.inData.attach(m_pImage1);
+	m_GameOfLife.inData.attach(m_pImage1.get());
 
 	tc::ivec2 dim = tc::imageSize(m_GameOfLife.inData);
 
-	m_pImage2 = new tc::BufferResource<tc::cpu::R8UI, tc::Dim::D2>{ dim };
-	m_GameOfLife.outData.attach(m_pImage2);	
+	m_pImage2 = std::make_unique<tc::BufferResource<tc::cpu::R8UI, tc::Dim::D2>>(dim);
+	m_GameOfLife.outData.attach(m_pImage2.get());	
 
 	tc::gpu::GPUBackend gpuBackend;
 	gpuBackend.uploadImage<tc::InternalFormat::R8UI>(*m_pImage1);
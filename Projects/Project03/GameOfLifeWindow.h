@@ -5,6 +5,7 @@
 #include "GL/glew.h"
 
 #include <chrono>
+#include <memory>
 
 constexpr std::string_view pattern =
 R"(000000000000000000
@@ -48,8 +49,8 @@ public:
 	
 private:
 	GameOfLifeKernel m_GameOfLife;
-	tc::BufferResource<tc::cpu::R8UI, tc::Dim::D2>* m_pImage1;
-	tc::BufferResource<tc::cpu::R8UI, tc::Dim::D2>* m_pImage2;
+	std::unique_ptr<tc::BufferResource<tc::cpu::R8UI, tc::Dim::D2>> m_pImage1;
+	std::unique_ptr<tc::BufferResource<tc::cpu::R8UI, tc::Dim::D2>> m_pImage2;
 
 	ConvertKernel m_ConvertKernel;
 
@@ -23,7 +23,7 @@ void RayTracerWindow::init(SurfaceRenderer& renderer)
 
 	tc::gpu::GPUBackend backend;
 	
-	m_pCameraRaysImage = new tc::BufferResource<tc::cpu::RGBA8, tc::Dim::D2>{ dim };
+	m_pCameraRaysImage = new tc::BufferResource<tc::cpu::RGBA32F, tc::Dim::D2>{ dim };
 	backend.uploadImage<tc::InternalFormat::RGBA32F> (*m_pCameraRaysImage);
 
 	m_RayTracerKernel.outData.attach(m_pCameraRaysImage);
@@ -18,6 +18,6 @@ public:
 private:
 	RayTracerKernel m_RayTracerKernel;
 	VisualizeRaysKernel m_VisualizeRaysKernel;
-	tc::BufferResource<tc::cpu::RGBA8, tc::Dim::D2>* m_pCameraRaysImage;
+	tc::BufferResource<tc::cpu::RGBA32F, tc::Dim::D2>* m_pCameraRaysImage;
 	uint32_t m_FrameCount{ 0 };
 };
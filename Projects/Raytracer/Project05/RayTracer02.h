@@ -5,13 +5,14 @@
 #include "math/arithmetic.hpp"
 #include "math/linearalgebra.hpp"
 #include "computebackend.hpp"
+#include "layout/std430.hpp"
 
 struct [[clang::annotate("kernel")]] RayTracerKernel
 {
 	static constexpr char fileLocation[] = "raytracer_v2";
 
 	tc::uvec3 local_size{ 16, 16, 1 };
-	tc::ImageBinding<tc::InternalFormat::RGBA32F, tc::Dim::D2, tc::cpu::RGBA8, 1> outData;
+	tc::ImageBinding<tc::InternalFormat::RGBA16F, tc::Dim::D2, tc::cpu::RGBA16F, 1> outData;
 	tc::Uniform<float, 0> fieldOfView{ 1.2 };
 
 	struct Sphere {
@@ -43,15 +44,17 @@ struct [[clang::annotate("kernel")]] SphereRayTracer
 {
 	static constexpr char fileLocation[] = "sphere_raytracer";
 	tc::uvec3 local_size{ 16,16,1 };
-	tc::ImageBinding<tc::InternalFormat::RGBA32F, tc::Dim::D2, tc::cpu::RGBA8, 0> rays;
+	tc::ImageBinding<tc::InternalFormat::RGBA16F, tc::Dim::D2, tc::cpu::RGBA16F, 0> rays;
 	tc::BufferBinding<float, 1> tBuffer;
 
+	// the radius is in w: a C++ std430::vec3 is 16 bytes, a float after it
+	// would be at offset 16 and the padded sphere 48 bytes instead of 32.
 	struct Sphere {
-		tc::vec4 locR;
-		tc::vec4 color;
+		tc::std430::vec4 centerRadius;
+		tc::std430::vec4 color;
 	};
 	tc::BufferBinding<Sphere, 2> spheres;
-	tc::Uniform<int, 0> nrOfSpheres;
+	tc::SpecConstant<int, 0, 4> nrOfSpheres;
 
 	tc::ImageBinding<tc::InternalFormat::RGBA8, tc::Dim::D2, tc::cpu::RGBA8UI, 1> outputTexture;
 	tc::Uniform<tc::vec3, 1> lightPos{ tc::vec3{-0.25,3,0.2} };
@@ -71,8 +74,8 @@ struct [[clang::annotate("kernel")]] SphereRayTracer
 		vec4 color = vec4(0.05, 0.05, 0.05, 1);
 		for (int si = 0; si < nrOfSpheres; ++si)
 		{
-			vec3 sphereLoc = spheres[si].locR["xyz"_sw];
-			float r = spheres[si].locR.w;
+			vec3 sphereLoc = spheres[si].centerRadius["xyz"_sw];
+			float r = spheres[si].centerRadius.w;
 
 			vec3 raySphereDiff = sphereLoc - rayOrigin; // take origin of ray (camera into account)
 			float L2 = dot(raySphereDiff, raySphereDiff);
@@ -102,11 +105,18 @@ struct [[clang::annotate("kernel")]] SphereRayTracer
 	}
 };
 
+// the sphere buffer is uploaded as is, its layout has to match std430.
+static_assert(tc::std430::verify<SphereRayTracer::Sphere>({
+	TC_STD430_MEMBER(SphereRayTracer::Sphere, centerRadius),
+	TC_STD430_MEMBER(SphereRayTracer::Sphere, color) }),
+	"SphereRayTracer::Sphere does not match the std430 layout.");
+static_assert(sizeof(SphereRayTracer::Sphere) == 32, "SphereRayTracer::Sphere has to be 32 bytes like in GLSL.");
+
 struct [[clang::annotate("kernel")]] VisualizeRaysKernel
 {
 	static constexpr char fileLocation[] = "visualize_rays";
 	tc::uvec3 local_size{ 16, 16, 1 };
-	tc::ImageBinding<tc::InternalFormat::RGBA32F, tc::Dim::D2, tc::cpu::RGBA8, 0> inData;
+	tc::ImageBinding<tc::InternalFormat::RGBA16F, tc::Dim::D2, tc::cpu::RGBA16F, 0> inData;
 	tc::ImageBinding<tc::InternalFormat::RGBA8, tc::Dim::D2, tc::cpu::RGBA8UI, 1> outData;
 
 	void main()
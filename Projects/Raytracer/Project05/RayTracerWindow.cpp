@@ -21,10 +21,13 @@ void RayTracerWindow::init(SurfaceRenderer& renderer)
 {
 	tc::ivec2 dim{ renderer.getWidth(),renderer.getHeight()};
 
+	// compile both kernels while the buffers are created and uploaded.
+	tc::gpu::GPUBackend::precompile<RayTracerKernel, SphereRayTracer>();
 	tc::gpu::GPUBackend backend;
 	
-	m_pCameraRaysImage = new tc::BufferResource<tc::cpu::RGBA8, tc::Dim::D2>{ dim };
-	backend.uploadImage<tc::InternalFormat::RGBA32F> (*m_pCameraRaysImage);
+	// unit ray directions only need half floats, 8 bytes per pixel instead of 16.
+	m_pCameraRaysImage = new tc::BufferResource<tc::cpu::RGBA16F, tc::Dim::D2>{ dim };
+	backend.uploadImage<tc::InternalFormat::RGBA16F> (*m_pCameraRaysImage);
 
 	m_RayTracerKernel.outData.attach(m_pCameraRaysImage);
 	m_SphereRayTracer.rays.attach(m_pCameraRaysImage);
@@ -37,15 +40,15 @@ void RayTracerWindow::init(SurfaceRenderer& renderer)
 
 	m_pSpheres = std::make_unique<SphereBuffer>(4);
 	
-	(*m_pSpheres)[0] = { tc::vec4{ 0.0,0.75,3.0f, 0.8f}, tc::vec4(1, .5, 0.2, 1) };
-	(*m_pSpheres)[1] = { tc::vec4{ 0.7,-0.25,3,0.8f}, tc::vec4(0.1, 1, 0.1, 1) };
-	(*m_pSpheres)[2] = { tc::vec4{ 0,-50,48, 60.0 }, tc::vec4(0.1, 0.2, 1, 1)};
-	(*m_pSpheres)[3] = { tc::vec4{ -0.7,-0.25,3, 0.8f}, tc::vec4(1, 0.2, 1, 1) };
+	(*m_pSpheres)[0] = { tc::vec4{ 0.0f, 0.75f, 3.0f, 0.8f }, tc::vec4(1, .5, 0.2, 1) };
+	(*m_pSpheres)[1] = { tc::vec4{ 0.7f, -0.25f, 3.0f, 0.8f }, tc::vec4(0.1, 1, 0.1, 1) };
+	(*m_pSpheres)[2] = { tc::vec4{ 0.0f, -50.0f, 48.0f, 60.0f }, tc::vec4(0.1, 0.2, 1, 1)};
+	(*m_pSpheres)[3] = { tc::vec4{ -0.7f, -0.25f, 3.0f, 0.8f }, tc::vec4(1, 0.2, 1, 1) };
 
-	m_SphereRayTracer.nrOfSpheres = 4;
 	backend.uploadBuffer(*m_pSpheres);
 	m_SphereRayTracer.spheres.attach(m_pSpheres.get());
 	m_SphereRayTracer.outputTexture.attach(renderer.getRenderBuffer());
+	tc::gpu::GPUBackend::finishPrecompile();
 }
 
 void RayTracerWindow::compute(SurfaceRenderer& renderer)
@@ -66,7 +69,6 @@ void RayTracerWindow::compute(SurfaceRenderer& renderer)
 		backend.bindImage(m_SphereRayTracer.outputTexture);
 		backend.bindBuffer(m_SphereRayTracer.tBuffer);
 		backend.bindBuffer(m_SphereRayTracer.spheres);
-		backend.bindUniform(m_SphereRayTracer.nrOfSpheres);
 		backend.bindUniform(m_SphereRayTracer.lightPos);
 		backend.execute(m_SphereRayTracer, tc::uvec3{ dim.x,dim.y,1 });
 }
\ No newline at end of file
@@ -18,7 +18,7 @@ public:
 private:
 	RayTracerKernel m_RayTracerKernel;
 	SphereRayTracer m_SphereRayTracer;
-	tc::BufferResource<tc::cpu::RGBA8, tc::Dim::D2>* m_pCameraRaysImage;
+	tc::BufferResource<tc::cpu::RGBA16F, tc::Dim::D2>* m_pCameraRaysImage;
 	uint32_t m_FrameCount{ 0 };
 
 	using SphereBuffer = tc::BufferResource<SphereRayTracer::Sphere>;
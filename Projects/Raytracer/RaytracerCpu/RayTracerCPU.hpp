@@ -11,7 +11,7 @@ struct [[clang::annotate("kernel")]] RayTracerKernel
 	static constexpr char fileLocation[] = "raytracer_v2";
 
 	tc::uvec3 local_size{ 16, 16, 1 };
-	tc::ImageBinding<tc::InternalFormat::RGBA32F, tc::Dim::D2, tc::cpu::RGBA8, 1> outData;
+	tc::ImageBinding<tc::InternalFormat::RGBA32F, tc::Dim::D2, tc::cpu::RGBA32F, 1> outData;
 	tc::Uniform<float, 0> fieldOfView{ 1.2 };
 
 	void main()
@@ -30,20 +30,25 @@ struct [[clang::annotate("kernel")]] RayTracerKernel
 	}
 };
 
+struct Sphere {
+	tc::vec3 loc;
+	float R;
+	tc::vec4 color;
+};
+
+// the spheres are stored as a structure of arrays, the intersection loop only
+// streams through loc and R. Declared before the kernel, which instantiates
+// the buffer in main.
+TC_SOA_FIELDS(Sphere, loc, R, color);
+
 struct [[clang::annotate("kernel")]] SphereRayTracer
 {
 	static constexpr char fileLocation[] = "sphere_raytracer";
 	tc::uvec3 local_size{ 16,16,1 };
-	tc::ImageBinding<tc::InternalFormat::RGBA32F, tc::Dim::D2, tc::cpu::RGBA8, 0> rays;
+	tc::ImageBinding<tc::InternalFormat::RGBA32F, tc::Dim::D2, tc::cpu::RGBA32F, 0> rays;
 	tc::BufferBinding<float, 1> tBuffer;
-
-	struct Sphere {
-		tc::vec3 loc;
-		float R;
-		tc::vec4 color;
-	};
-	tc::BufferBinding<Sphere, 2> spheres;
-	tc::Uniform<int, 0> nrOfSpheres;
+	tc::BufferBinding<Sphere, 2, 0, tc::StorageLayout::SoA> spheres;
+	tc::SpecConstant<int, 0, 4> nrOfSpheres;
 
 	tc::ImageBinding<tc::InternalFormat::RGBA8, tc::Dim::D2, tc::cpu::RGBA8UI, 1> outputTexture;
 	tc::Uniform<tc::vec3, 1> lightPos{ tc::vec3{-0.25,3,0.2} };
@@ -98,7 +103,7 @@ struct [[clang::annotate("kernel")]] VisualizeRaysKernel
 {
 	static constexpr char fileLocation[] = "visualize_rays";
 	tc::uvec3 local_size{ 16, 16, 1 };
-	tc::ImageBinding<tc::InternalFormat::RGBA32F, tc::Dim::D2, tc::cpu::RGBA8, 0> inData;
+	tc::ImageBinding<tc::InternalFormat::RGBA32F, tc::Dim::D2, tc::cpu::RGBA32F, 0> inData;
 	tc::ImageBinding<tc::InternalFormat::RGBA8, tc::Dim::D2, tc::cpu::RGBA8UI, 1> outData;
 
 	void main()
@@ -25,7 +25,7 @@ void RayTracerWindow::init(SurfaceRenderer& renderer)
 	tc::ivec2 dim{ renderer.getWidth(),renderer.getHeight() };
 	ComputeBackend backend;
 
-	m_pCameraRaysImage = new tc::BufferResource<tc::cpu::RGBA8, tc::Dim::D2>{ dim };
+	m_pCameraRaysImage = new tc::BufferResource<tc::cpu::RGBA32F, tc::Dim::D2>{ dim };
 	backend.uploadImage<tc::InternalFormat::RGBA32F>(*m_pCameraRaysImage);
 
 	m_RayTracerKernel.outData.attach(m_pCameraRaysImage);
@@ -44,12 +44,11 @@ void RayTracerWindow::init(SurfaceRenderer& renderer)
 	(*m_pSpheres)[2] = { tc::vec3{ 0,-50,48}, 60.0 , tc::vec4(0.1, 0.2, 1, 1) };
 	(*m_pSpheres)[3] = { tc::vec3{ -0.7,-0.25,3}, 0.8 , tc::vec4(1, 0.2, 1, 1) };
 
-	m_SphereRayTracer.nrOfSpheres = 4;
 	backend.uploadBuffer(*m_pSpheres);
 	m_SphereRayTracer.spheres.attach(m_pSpheres.get());
 	m_SphereRayTracer.outputTexture.attach(renderer.getRenderBuffer());
 
-	std::cout << "Sizeof sphere struct " << sizeof(SphereRayTracer::Sphere) << std::endl;
+	std::cout << "Sizeof sphere struct " << sizeof(Sphere) << std::endl;
 }
 
 void RayTracerWindow::compute(SurfaceRenderer& renderer)
@@ -84,7 +83,6 @@ void RayTracerWindow::computeScene(SurfaceRenderer& renderer, tc::ivec2 dim)
 	backend.bindBuffer(m_SphereRayTracer.tBuffer);
 	backend.bindBuffer(m_SphereRayTracer.spheres);
 
-	backend.bindUniform(m_SphereRayTracer.nrOfSpheres);
 	backend.bindUniform(m_SphereRayTracer.lightPos);
 	
 	backend.execute(m_SphereRayTracer, tc::uvec3{ dim.x,dim.y,1 });
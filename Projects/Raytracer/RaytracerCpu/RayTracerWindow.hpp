@@ -9,6 +9,9 @@
 class RayTracerWindow
 {
 public:
+	// traces on the CPU backend only, so it can run in a pipelined loop.
+	static constexpr bool ComputesOnCPU = true;
+
 	RayTracerWindow(GLuint width, GLuint height);
 	~RayTracerWindow();
 
@@ -22,9 +25,9 @@ private:
 	RayTracerKernel m_RayTracerKernel;
 	SphereRayTracer m_SphereRayTracer;
 	
-	tc::BufferResource<tc::cpu::RGBA8, tc::Dim::D2>* m_pCameraRaysImage;
+	tc::BufferResource<tc::cpu::RGBA32F, tc::Dim::D2>* m_pCameraRaysImage;
 
-	using SphereBuffer = tc::BufferResource<SphereRayTracer::Sphere>;
+	using SphereBuffer = tc::BufferResource<Sphere, tc::Dim::D1, tc::StorageLayout::SoA>;
 	std::unique_ptr<SphereBuffer> m_pSpheres;
 
 	using TBuffer = tc::BufferResource<float>;
@@ -10,6 +10,8 @@ int main() {
 	try {
 		ComputeWindow<RayTracerWindow> window{ 640,480,"CPU Raytracer" };
 		window.init();
+		// the frame after the one on screen is traced on the CPU meanwhile.
+		window.setPipelineDepth(3);
 		window.renderLoop();
 	}
 	catch (const std::exception& e) {
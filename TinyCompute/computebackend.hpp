@@ -7,8 +7,11 @@
 #include <numeric>
 #include <concepts>
 #include <unordered_map>
+#include <chrono>
+#include <thread>
 
 #include "kernel_intrinsics.hpp"
+#include "tuning/autotune.hpp"
 
 namespace tc
 {
@@ -34,42 +37,56 @@ namespace tc
 			return m_Backend;
 		}
 
-		template<typename BufferType>
-		void uploadBuffer(BufferResource<BufferType>& resource )
+		template<typename BufferType, StorageLayout L>
+		void uploadBuffer(BufferResource<BufferType, Dim::D1, L>& resource )
 		{
 			static_cast<Derived*>(this)->uploadBufferImpl(resource);
 		}
 
-		template<typename BufferType>
-		void downloadBuffer(BufferResource<BufferType>& resource)
+		template<typename BufferType, StorageLayout L>
+		void downloadBuffer(BufferResource<BufferType, Dim::D1, L>& resource)
 		{
 			static_cast<Derived*>(this)->downloadBufferImpl(resource);
 		}
 
-		template<typename T, unsigned Binding, unsigned Set>
-		void bindBuffer(const tc::BufferBinding<T, Binding, Set>& buffer)
+		template<typename T, unsigned Binding, unsigned Set, StorageLayout L>
+		void bindBuffer(const tc::BufferBinding<T, Binding, Set, L>& buffer)
 		{
 			static_cast<Derived*>(this)->bindBufferImpl(buffer);
 		}
 
-		template<tc::InternalFormat G, tc::Dim D, tc::cpu::PixelConcept P, unsigned B, unsigned S>
-		void bindImage(const tc::ImageBinding<G, D, P, B, S>& image)
+		template<tc::InternalFormat G, tc::Dim D, tc::cpu::PixelConcept P, unsigned B, unsigned S, tc::StorageLayout L, tc::AddressMode A>
+		void bindImage(const tc::ImageBinding<G, D, P, B, S, L, A>& image)
 		{
 			static_cast<Derived*>(this)->bindImageImpl(image);
 		}
 
-		template<tc::InternalFormat G, tc::cpu::PixelConcept P>
-		void uploadImage(BufferResource<P,tc::Dim::D2>& buffer)
+		// uploads a 2D or 3D image.
+		template<tc::InternalFormat G, tc::cpu::PixelConcept P, tc::Dim D, tc::StorageLayout L>
+		void uploadImage(BufferResource<P,D,L>& buffer)
 		{
 			static_cast<Derived*>(this)->template uploadImageImpl<G,P>(buffer);
 		}
 
+		// downloads a 2D or 3D image that a kernel wrote on the GPU into its CPU pixels.
+		template<tc::cpu::PixelConcept P, tc::Dim D, tc::StorageLayout L>
+		void downloadImage(BufferResource<P, D, L>& buffer)
+		{
+			static_cast<Derived*>(this)->downloadImageImpl(buffer);
+		}
+
 		template<typename T, int Location>
 		void bindUniform(const tc::Uniform<T, Location>& uniform)
 		{
 			static_cast<Derived*>(this)->bindUniformImpl(uniform);
 		}
 
+		template<KernelEntry K, typename T, unsigned Id, T Default>
+		void specialize(K& k, const tc::SpecConstant<T, Id, Default>& constant, T value)
+		{
+			static_cast<Derived*>(this)->specializeImpl(k, constant, value);
+		}
+
 		template<KernelEntry K>
 		void useKernel(K& k)
 		{
@@ -86,6 +103,16 @@ namespace tc
 			static_cast<Derived*>(this)->executeImpl(k, totalWork);
 		
 		}
+
+		// Dispatches the number of work groups stored in args[first], args[first + 1]
+		// and args[first + 2], which an earlier kernel may have written.
+		template<KernelEntry K>
+		void executeIndirect(K& k, BufferResource<tc::uint>& args, std::size_t first = 0)
+		{
+			static_assert(HasLocalSize<K>,
+				"Kernel must have a 'tc::uvec3 local_size' member.");
+			static_cast<Derived*>(this)->executeIndirectImpl(k, args, first);
+		}
 	protected:
 		tc::uint ceil_div(tc::uint a, tc::uint b) {
 			return a / b + (a % b != 0);
@@ -110,32 +137,39 @@ namespace tc
 
 		}
 
-		template<typename BufferType>
-		void uploadBufferImpl(tc::BufferResource<BufferType>& buffer)
+		template<typename BufferType, StorageLayout L>
+		void uploadBufferImpl(tc::BufferResource<BufferType, Dim::D1, L>& buffer)
 		{
 			buffer.setBufferLocation(BufferLocation::CPU);
 		}
 
-		template<typename BufferType>
-		void downloadBufferImpl(tc::BufferResource<BufferType>& buffer)
+		template<typename BufferType, StorageLayout L>
+		void downloadBufferImpl(tc::BufferResource<BufferType, Dim::D1, L>& buffer)
 		{
 			buffer.setBufferLocation(BufferLocation::CPU);
 		}
 
-		template<typename T, unsigned Binding, unsigned Set>
-		void bindBufferImpl(const tc::BufferBinding<T, Binding, Set>& buffer)
+		template<typename T, unsigned Binding, unsigned Set, StorageLayout L>
+		void bindBufferImpl(const tc::BufferBinding<T, Binding, Set, L>& buffer)
 		{
 			buffer.getBufferData()->setBufferLocation(BufferLocation::CPU);
 		}
 
-		template<tc::InternalFormat G, tc::Dim D, tc::cpu::PixelConcept P, unsigned B, unsigned S>
-		void bindImageImpl(const tc::ImageBinding<G, D, P, B, S>& image)
+		template<tc::InternalFormat G, tc::Dim D, tc::cpu::PixelConcept P, unsigned B, unsigned S, tc::StorageLayout L, tc::AddressMode A>
+		void bindImageImpl(const tc::ImageBinding<G, D, P, B, S, L, A>& image)
 		{
 			image.getBufferData()->setBufferLocation(BufferLocation::CPU);
+			image.bindView();
 		}
 
-		template<InternalFormat format,typename BufferType> 
-		void uploadImageImpl(tc::BufferResource<BufferType,Dim::D2>& buffer)
+		template<InternalFormat format,typename BufferType,Dim D,StorageLayout L> 
+		void uploadImageImpl(tc::BufferResource<BufferType,D,L>& buffer)
+		{
+			buffer.setBufferLocation(BufferLocation::CPU);
+		}
+
+		template<tc::cpu::PixelConcept P, Dim D, StorageLayout L>
+		void downloadImageImpl(tc::BufferResource<P, D, L>& buffer)
 		{
 			buffer.setBufferLocation(BufferLocation::CPU);
 		}
@@ -147,11 +181,21 @@ namespace tc
 		}
 
 		template<KernelEntry K>
-		void useKernelImpl(K& k)
+		void useKernelImpl(K&)
 		{
 			// no op
 		}
 
+		// A SpecConstant is a constexpr on the CPU, its value is fixed by the kernel type.
+		template<KernelEntry K, typename T, unsigned Id, T Default>
+		void specializeImpl(K&, const tc::SpecConstant<T, Id, Default>&, T value)
+		{
+			if (value != Default) {
+				throw std::runtime_error("CPUBackend can not override SpecConstant " + std::to_string(Id)
+					+ ", change its default value in the kernel instead.");
+			}
+		}
+
 		inline tc::uvec3 unflatten3D(uint64_t i, tc::uvec3 dims) {
 			// dims = global size (X * Y * Z total)
 			uint64_t xy = uint64_t(dims.x) * dims.y;
@@ -170,39 +214,130 @@ namespace tc
 
 			const uint64_t totalWork =
 				uint64_t(globalWorkSize.x) * globalWorkSize.y * globalWorkSize.z;
-			auto range = std::views::iota(uint64_t{ 0 }, totalWork);
- 
-			auto kernelLambda = [&](const uint64_t xi) {
-				tc::gl_GlobalInvocationID = unflatten3D(xi, globalWorkSize);
+
+			// each task runs a chunk of consecutive invocations, the chunk size
+			// is tuned per kernel and problem size when autotuning is enabled.
+			uint64_t chunkSize = 1;
+			const std::string* pKey = nullptr;
+			std::optional<tc::tuning::Trial> trial;
+			if (m_Tuning.isActive()) {
+				pKey = &m_Tuning.key(K::fileLocation, static_cast<uint32_t>(m_Policy),
+					tc::tuning::sizeClass(globalWorkSize), [this] { return deviceName(); });
+				if (auto tuned = m_Tuning.find(*pKey)) {
+					chunkSize = tuned->x;
+				}
+				else if ((trial = m_Tuning.nextTrial(*pKey, tc::tuning::chunkSizeCandidates(totalWork)))) {
+					chunkSize = trial->value.x;
+				}
+			}
+
+			const tc::uvec3 localSize = kernel.local_size;
+			auto invoke = [&](const tc::uvec3 id) {
+				tc::gl_GlobalInvocationID = id;
+				tc::gl_WorkGroupID = tc::uvec3(id.x / localSize.x, id.y / localSize.y, id.z / localSize.z);
+				tc::gl_LocalInvocationID = tc::uvec3(id.x % localSize.x, id.y % localSize.y, id.z % localSize.z);
 				kernel.main();
 				};
+
+			auto start = std::chrono::steady_clock::now();
+			if (globalWorkSize.z > 1) {
+				// a volume is split in slabs of whole xy planes, a chunk is
+				// rounded to planes. The invocations of a task walk a slab
+				// row by row and stay in one part of a 3D image.
+				const uint64_t planeSize = uint64_t(globalWorkSize.x) * globalWorkSize.y;
+				const uint32_t slabDepth = static_cast<uint32_t>(std::clamp<uint64_t>(chunkSize / planeSize, 1, globalWorkSize.z));
+				const uint64_t slabCount = (globalWorkSize.z + slabDepth - 1) / slabDepth;
+				forEachChunk(slabCount, [&](const uint64_t slab) {
+					const uint32_t first = static_cast<uint32_t>(slab) * slabDepth;
+					const uint32_t end = std::min(globalWorkSize.z, first + slabDepth);
+					for (uint32_t z = first; z < end; ++z) {
+						for (uint32_t y = 0; y < globalWorkSize.y; ++y) {
+							for (uint32_t x = 0; x < globalWorkSize.x; ++x) {
+								invoke(tc::uvec3(x, y, z));
+							}
+						}
+					}
+					});
+			}
+			else {
+				const uint64_t chunkCount = (totalWork + chunkSize - 1) / chunkSize;
+				forEachChunk(chunkCount, [&](const uint64_t chunk) {
+					const uint64_t end = std::min(totalWork, (chunk + 1) * chunkSize);
+					for (uint64_t xi = chunk * chunkSize; xi < end; ++xi) {
+						invoke(unflatten3D(xi, globalWorkSize));
+					}
+					});
+			}
+
+			if (trial) {
+				std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+				m_Tuning.addSample(*pKey, trial->candidate, elapsed.count());
+			}
+		}
+
+		template<KernelEntry K>
+		void executeIndirectImpl(K& kernel, BufferResource<tc::uint>& args, std::size_t first)
+		{
+			const tc::uvec3 localSize = kernel.local_size;
+			const int32_t i = static_cast<int32_t>(first);
+			executeImpl(kernel, tc::uvec3(
+				args[i] * localSize.x,
+				args[i + 1] * localSize.y,
+				args[i + 2] * localSize.z));
+		}
+
+		// Autotuning times every chunk size candidate on the first executions
+		// of a kernel and stores the fastest one in the tuning file, tuning/cpu.txt
+		// unless another file is set. Once a file is set its values are used
+		// even when autotuning is disabled.
+		static void setAutotuneEnabled(bool enabled)
+		{
+			m_Tuning.setEnabled(enabled);
+		}
+
+		// an empty path unsets the file.
+		static void setAutotuneFile(const std::filesystem::path& file)
+		{
+			m_Tuning.setFile(file);
+		}
+	private:
+		// runs f(chunk) for every chunk below chunkCount with the execution policy.
+		template<typename F>
+		void forEachChunk(const uint64_t chunkCount, F&& f) const
+		{
+			auto range = std::views::iota(uint64_t{ 0 }, chunkCount);
 			switch (m_Policy)
 			{
 			case ExecutionPolicy::Par: {
 				std::for_each(std::execution::par
-					, range.begin(), range.end(), kernelLambda); 
+					, range.begin(), range.end(), f); 
 				break;
 			}
 			case ExecutionPolicy::Seq: {
 				std::for_each(std::execution::seq
-					, range.begin(), range.end(), kernelLambda); 
+					, range.begin(), range.end(), f); 
 				break;
 			}
 			case ExecutionPolicy::Par_unseq: {
 				std::for_each(std::execution::par_unseq
-					, range.begin(), range.end(), kernelLambda);
+					, range.begin(), range.end(), f);
 				break;
 			}
 			case ExecutionPolicy::Unseq: {
 				std::for_each(std::execution::unseq
-					, range.begin(), range.end(), kernelLambda); 
+					, range.begin(), range.end(), f); 
 				break;
 			}
 			};
-			
-				
 		}
-	private:
+
+		std::string deviceName() const
+		{
+			return "cpu" + std::to_string(std::thread::hardware_concurrency())
+				+ "-policy" + std::to_string(static_cast<int>(m_Policy));
+		}
+
 		ExecutionPolicy m_Policy;
+		static inline tc::tuning::TuningSession m_Tuning{ "tuning/cpu.txt" };
 	};
 }
@@ -0,0 +1,115 @@
+#pragma once
+#include <bit>
+#include <cstdint>
+
+// Storage for the small float formats of OpenGL images.
+//
+// half is the 16 bit float of RGBA16F and R16F: a sign bit, 5 exponent bits
+// and 10 mantissa bits. The packed formats R11F_G11F_B10F have no sign bit,
+// the same 5 exponent bits and 6 or 5 mantissa bits. All of them round to
+// nearest even like the GL conversion.
+namespace tc
+{
+	namespace detail
+	{
+		// a positive finite float below 2^16 as a 5 bit exponent and M mantissa bits.
+		template<unsigned M>
+		constexpr uint32_t encodeSmallFloat(uint32_t f) noexcept
+		{
+			// below the smallest normal 2^-14 the value is a denormal, adding a
+			// float whose last mantissa bit is worth 2^(-14 - M) rounds it to a
+			// multiple of that in the low bits.
+			if (f < (113u << 23)) {
+				constexpr uint32_t magic = (136u - M) << 23;
+				float rounded = std::bit_cast<float>(f) + std::bit_cast<float>(magic);
+				return std::bit_cast<uint32_t>(rounded) - magic;
+			}
+			const uint32_t mantissaOdd = (f >> (23 - M)) & 1u;
+			f += (static_cast<uint32_t>(15 - 127) << 23) + ((1u << (22 - M)) - 1u) + mantissaOdd;
+			return f >> (23 - M);
+		}
+
+		template<unsigned M>
+		constexpr float decodeSmallFloat(uint32_t bits) noexcept
+		{
+			const uint32_t exponent = bits >> M;
+			const uint32_t mantissa = bits & ((1u << M) - 1u);
+			if (exponent == 31) {
+				return std::bit_cast<float>(mantissa ? 0x7FC00000u : 0x7F800000u);
+			}
+			if (exponent == 0) {
+				// mantissa * 2^(-14 - M)
+				return static_cast<float>(mantissa) * std::bit_cast<float>((113u - M) << 23);
+			}
+			return std::bit_cast<float>(((exponent + 127 - 15) << 23) | (mantissa << (23 - M)));
+		}
+
+		// a float as an unsigned float with M mantissa bits, negative values
+		// become 0 and values past the largest one are clamped to it.
+		template<unsigned M>
+		constexpr uint32_t packUnsignedFloat(float v) noexcept
+		{
+			const uint32_t f = std::bit_cast<uint32_t>(v);
+			const uint32_t largest = (30u << M) | ((1u << M) - 1u);
+			if ((f & 0x7FFFFFFFu) > 0x7F800000u) {
+				return (31u << M) | (1u << (M - 1));
+			}
+			if (f & 0x80000000u) {
+				return 0;
+			}
+			if (f == 0x7F800000u) {
+				return 31u << M;
+			}
+			if (f >= std::bit_cast<uint32_t>(decodeSmallFloat<M>(largest))) {
+				return largest;
+			}
+			return encodeSmallFloat<M>(f);
+		}
+	}
+
+	struct half
+	{
+		constexpr half() = default;
+
+		explicit constexpr half(float v) noexcept
+			:bits{ fromFloat(v) }
+		{
+		}
+
+		constexpr operator float() const noexcept {
+			const float magnitude = detail::decodeSmallFloat<10>(bits & 0x7FFFu);
+			return (bits & 0x8000u) ? -magnitude : magnitude;
+		}
+
+		static constexpr half fromBits(uint16_t bits) noexcept {
+			half h;
+			h.bits = bits;
+			return h;
+		}
+
+		uint16_t bits{ 0 };
+
+	private:
+		static constexpr uint16_t fromFloat(float v) noexcept
+		{
+			uint32_t f = std::bit_cast<uint32_t>(v);
+			const uint32_t sign = (f >> 16) & 0x8000u;
+			f &= 0x7FFFFFFFu;
+			uint32_t magnitude;
+			if (f > 0x7F800000u) {
+				magnitude = 0x7E00u;
+			}
+			else if (f >= (143u << 23)) {
+				// 2^16 and up, and infinity.
+				magnitude = 0x7C00u;
+			}
+			else {
+				// rounding up past the largest half 65504 carries into infinity.
+				magnitude = detail::encodeSmallFloat<10>(f);
+			}
+			return static_cast<uint16_t>(sign | magnitude);
+		}
+	};
+
+	static_assert(sizeof(half) == 2, "half has to match GL_HALF_FLOAT.");
+}
@@ -2,6 +2,10 @@
 #include <limits>
 #include <type_traits>
 #include <array>
+#include <algorithm>
+#include <cstdint>
+
+#include "Half.hpp"
 
 namespace tc {
 	enum class InternalFormat {
@@ -9,7 +13,11 @@ namespace tc {
 		R32F,
 		RGBA8,
 		R8UI,
-		RGB8UI
+		RGB8UI,
+		RGBA16F,
+		R16F,
+		R11F_G11F_B10F,
+		RGB10_A2
 	};
 
 	enum class Scalar {
@@ -47,17 +55,70 @@ namespace tc {
 
 	enum class Channel { R = 0, G = 1, B = 2, A = 3, Min = 4, Max = 5};
 
+	template<typename T>
+	inline constexpr bool is_float_channel_v = std::is_floating_point_v<T> || std::is_same_v<T, half>;
+
 	template<typename T>
 	constexpr T channel_min() noexcept {
-		if constexpr (std::is_floating_point_v<T>) return T(0);
+		if constexpr (is_float_channel_v<T>) return T(0.0f);
 		else return std::numeric_limits<T>::min();
 	}
 
 	template<typename T>
 	constexpr T channel_max() noexcept {
-		if constexpr (std::is_floating_point_v<T>) return T(1);
+		if constexpr (is_float_channel_v<T>) return T(1.0f);
 		else return std::numeric_limits<T>::max();
 	}
+
+	template<class Src, class Dst>
+	struct ChannelConverter;
+
+	template<class T>
+	struct ChannelConverter<T, T> {
+		static constexpr T apply(T v) noexcept { return v; }
+	};
+
+	template<>
+	struct ChannelConverter<std::uint8_t, float> {
+		static constexpr float apply(std::uint8_t v) noexcept {
+			return float(v) * (1.0f / 255.0f);
+		}
+	};
+
+	template<>
+	struct ChannelConverter<std::uint8_t, std::uint32_t> {
+		static constexpr uint32_t apply(std::uint8_t v) noexcept {
+			return v;
+		}
+	};
+
+	template<>
+	struct ChannelConverter<std::uint32_t, std::uint8_t> {
+		static constexpr uint8_t apply(std::uint32_t v) noexcept {
+			return static_cast<uint8_t>(std::clamp(v, 0u, 255u));
+		}
+	};
+
+	template<>
+	struct ChannelConverter<float, std::uint8_t> {
+		static constexpr uint8_t apply(float v) noexcept {
+			return static_cast<uint8_t>(std::clamp(v, 0.0f, 1.0f) * 255.0f + 0.5f);
+		}
+	};
+
+	template<>
+	struct ChannelConverter<tc::half, float> {
+		static constexpr float apply(tc::half v) noexcept {
+			return float(v);
+		}
+	};
+
+	template<>
+	struct ChannelConverter<float, tc::half> {
+		static constexpr tc::half apply(float v) noexcept {
+			return tc::half(v);
+		}
+	};
 }
 
 namespace tc::cpu {
@@ -110,16 +171,133 @@ namespace tc::cpu {
 
 	};
 
-	using R8 = Pixel<float, 1>;
-	using RA8 = Pixel<float, 2>;
-	using RGB8 = Pixel<float, 3>;
-	using RGBA8 = Pixel<float, 4>;
+	// 8 bit normalized channels, the CPU side of RGBA8 and the other UNorm
+	// formats. A channel is stored as a byte and reads as byte / 255 through
+	// ChannelConverter<uint8_t, float> when the image has a float format.
+	template<int N>
+	struct UNorm8Pixel : Pixel<uint8_t, N> {
+		using Pixel<uint8_t, N>::Pixel;
+	};
+
+	using R8 = UNorm8Pixel<1>;
+	using RA8 = UNorm8Pixel<2>;
+	using RGB8 = UNorm8Pixel<3>;
+	using RGBA8 = UNorm8Pixel<4>;
+
+	using R32F = Pixel<float, 1>;
+	using RA32F = Pixel<float, 2>;
+	using RGB32F = Pixel<float, 3>;
+	using RGBA32F = Pixel<float, 4>;
 
 	using R8UI = Pixel<uint8_t, 1>;
 	using RA8UI = Pixel<uint8_t, 2>;
 	using RGB8UI = Pixel<uint8_t, 3>;
 	using RGBA8UI = Pixel<uint8_t, 4>;
 
+	using R16F = Pixel<half, 1>;
+	using RGBA16F = Pixel<half, 4>;
+
+	// Channels packed in the bits of one 32 bit word, the layout of the GL
+	// packed pixel types. Codec::Widths are the bits of R, G, B and A from the
+	// lowest bit up, Codec encodes and decodes a channel of W bits. Channels
+	// read and write floats, a missing alpha reads 1.
+	template<class Codec>
+	struct PackedPixel {
+		constexpr PackedPixel() = default;
+
+		constexpr PackedPixel(float r, float g = 0.0f, float b = 0.0f, float a = 1.0f)
+		{
+			set<Channel::R>(r);
+			set<Channel::G>(g);
+			set<Channel::B>(b);
+			set<Channel::A>(a);
+		}
+
+		template<Channel C>
+		constexpr float get() const noexcept
+		{
+			constexpr int channel = static_cast<int>(C);
+			constexpr unsigned width = Codec::Widths[channel];
+			if constexpr (width == 0) {
+				return C == Channel::A ? 1.0f : 0.0f;
+			}
+			else {
+				return Codec::template decode<width>((m_Bits >> offset(channel)) & mask(width));
+			}
+		}
+
+		template<Channel C>
+		constexpr void set(float value) noexcept
+		{
+			constexpr int channel = static_cast<int>(C);
+			constexpr unsigned width = Codec::Widths[channel];
+			if constexpr (width != 0) {
+				const uint32_t bits = Codec::template encode<width>(value) & mask(width);
+				m_Bits = (m_Bits & ~(mask(width) << offset(channel))) | (bits << offset(channel));
+			}
+		}
+
+		constexpr uint32_t bits() const noexcept {
+			return m_Bits;
+		}
+
+		template<Channel C>
+		using ChannelType = float;
+
+		static constexpr int NumChannels = Codec::Widths[3] == 0 ? 3 : 4;
+	private:
+		static constexpr unsigned offset(int channel) {
+			unsigned sum = 0;
+			for (int c = 0; c < channel; ++c) {
+				sum += Codec::Widths[c];
+			}
+			return sum;
+		}
+
+		static constexpr uint32_t mask(unsigned width) {
+			return width == 32 ? ~0u : (1u << width) - 1u;
+		}
+
+		uint32_t m_Bits{ 0 };
+	};
+
+	// unsigned floats with a 5 bit exponent, the rest of a channel is mantissa.
+	struct UnsignedFloatCodec {
+		static constexpr std::array<unsigned, 4> Widths{ 11, 11, 10, 0 };
+
+		template<unsigned W>
+		static constexpr uint32_t encode(float v) noexcept {
+			return detail::packUnsignedFloat<W - 5>(v);
+		}
+
+		template<unsigned W>
+		static constexpr float decode(uint32_t bits) noexcept {
+			return detail::decodeSmallFloat<W - 5>(bits);
+		}
+	};
+
+	// normalized unsigned integers, 0 is 0.0 and all ones is 1.0.
+	struct UNormCodec {
+		static constexpr std::array<unsigned, 4> Widths{ 10, 10, 10, 2 };
+
+		template<unsigned W>
+		static constexpr uint32_t encode(float v) noexcept {
+			constexpr float scale = float((1u << W) - 1u);
+			return static_cast<uint32_t>(std::clamp(v, 0.0f, 1.0f) * scale + 0.5f);
+		}
+
+		template<unsigned W>
+		static constexpr float decode(uint32_t bits) noexcept {
+			constexpr float scale = float((1u << W) - 1u);
+			return float(bits) * (1.0f / scale);
+		}
+	};
+
+	// GL_UNSIGNED_INT_10F_11F_11F_REV
+	using R11G11B10F = PackedPixel<UnsignedFloatCodec>;
+	// GL_UNSIGNED_INT_2_10_10_10_REV
+	using RGB10A2 = PackedPixel<UNormCodec>;
+
 	template<class P, Channel C>
 	concept ChannelConcept =
 		requires(P p) {
@@ -0,0 +1,336 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+#include <array>
+#include <type_traits>
+
+#if defined(__SSE4_1__) || defined(__AVX2__) || defined(__F16C__)
+#include <immintrin.h>
+#endif
+
+#include "ImageFormat.hpp"
+#include "Half.hpp"
+
+// Bulk conversion of pixel data.
+//
+// imageLoad and imageStore convert one channel at a time. The functions here
+// convert whole rows or images with SSE4.1, AVX2 and F16C when the compiler
+// targets them, and give the same results as ChannelConverter: 8 bit channels
+// are normalized to 0..1 and rounded back, halfs round to nearest even.
+// convertPixels picks the bulk path for two pixel types, or falls back to
+// ChannelConverter per channel for the packed pixels.
+namespace tc::convert
+{
+	// byte / 255 for count bytes.
+	inline void u8ToF32(const uint8_t* src, float* dst, std::size_t count)
+	{
+		std::size_t i = 0;
+#if defined(__AVX2__)
+		const __m256 scale8 = _mm256_set1_ps(1.0f / 255.0f);
+		for (; i + 8 <= count; i += 8) {
+			__m256i bytes = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i)));
+			_mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(bytes), scale8));
+		}
+#endif
+#if defined(__SSE4_1__)
+		const __m128 scale4 = _mm_set1_ps(1.0f / 255.0f);
+		for (; i + 4 <= count; i += 4) {
+			int32_t packed;
+			std::memcpy(&packed, src + i, sizeof(packed));
+			__m128i bytes = _mm_cvtepu8_epi32(_mm_cvtsi32_si128(packed));
+			_mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(bytes), scale4));
+		}
+#endif
+		for (; i < count; ++i) {
+			dst[i] = ChannelConverter<uint8_t, float>::apply(src[i]);
+		}
+	}
+
+	// clamps to 0..1 and rounds to the nearest byte.
+	inline void f32ToU8(const float* src, uint8_t* dst, std::size_t count)
+	{
+		std::size_t i = 0;
+#if defined(__AVX2__)
+		const __m256 zero8 = _mm256_setzero_ps();
+		const __m256 one8 = _mm256_set1_ps(1.0f);
+		const __m256 scale8 = _mm256_set1_ps(255.0f);
+		const __m256 half8 = _mm256_set1_ps(0.5f);
+		for (; i + 8 <= count; i += 8) {
+			__m256 v = _mm256_max_ps(_mm256_min_ps(_mm256_loadu_ps(src + i), one8), zero8);
+			__m256i ints = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(v, scale8), half8));
+			__m128i words = _mm_packus_epi32(_mm256_castsi256_si128(ints), _mm256_extracti128_si256(ints, 1));
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(words, words));
+		}
+#endif
+#if defined(__SSE4_1__)
+		const __m128 zero4 = _mm_setzero_ps();
+		const __m128 one4 = _mm_set1_ps(1.0f);
+		const __m128 scale4 = _mm_set1_ps(255.0f);
+		const __m128 half4 = _mm_set1_ps(0.5f);
+		for (; i + 4 <= count; i += 4) {
+			__m128 v = _mm_max_ps(_mm_min_ps(_mm_loadu_ps(src + i), one4), zero4);
+			__m128i ints = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(v, scale4), half4));
+			__m128i words = _mm_packus_epi32(ints, ints);
+			int32_t packed = _mm_cvtsi128_si32(_mm_packus_epi16(words, words));
+			std::memcpy(dst + i, &packed, sizeof(packed));
+		}
+#endif
+		for (; i < count; ++i) {
+			dst[i] = ChannelConverter<float, uint8_t>::apply(src[i]);
+		}
+	}
+
+	inline void f32ToF16(const float* src, half* dst, std::size_t count)
+	{
+		std::size_t i = 0;
+#if defined(__F16C__)
+		for (; i + 8 <= count; i += 8) {
+			__m128i halfs = _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), halfs);
+		}
+#endif
+		for (; i < count; ++i) {
+			dst[i] = half(src[i]);
+		}
+	}
+
+	inline void f16ToF32(const half* src, float* dst, std::size_t count)
+	{
+		std::size_t i = 0;
+#if defined(__F16C__)
+		for (; i + 8 <= count; i += 8) {
+			__m128i halfs = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+			_mm256_storeu_ps(dst + i, _mm256_cvtph_ps(halfs));
+		}
+#endif
+		for (; i < count; ++i) {
+			dst[i] = float(src[i]);
+		}
+	}
+
+	namespace detail
+	{
+		// bytes and halfs go through floats in chunks that stay in L1.
+		inline constexpr std::size_t ChunkSize = 256;
+	}
+
+	inline void u8ToF16(const uint8_t* src, half* dst, std::size_t count)
+	{
+		std::array<float, detail::ChunkSize> floats;
+		for (std::size_t i = 0; i < count; i += detail::ChunkSize) {
+			std::size_t n = std::min(detail::ChunkSize, count - i);
+			u8ToF32(src + i, floats.data(), n);
+			f32ToF16(floats.data(), dst + i, n);
+		}
+	}
+
+	inline void f16ToU8(const half* src, uint8_t* dst, std::size_t count)
+	{
+		std::array<float, detail::ChunkSize> floats;
+		for (std::size_t i = 0; i < count; i += detail::ChunkSize) {
+			std::size_t n = std::min(detail::ChunkSize, count - i);
+			f16ToF32(src + i, floats.data(), n);
+			f32ToU8(floats.data(), dst + i, n);
+		}
+	}
+
+	// adds an alpha channel to a run of RGB pixels.
+	template<typename T>
+	void expandRGBToRGBA(const T* src, T* dst, std::size_t pixels, T alpha)
+	{
+		std::size_t i = 0;
+#if defined(__SSE4_1__)
+		if constexpr (std::is_same_v<T, uint8_t>) {
+			// 4 pixels per step, the load of 16 bytes reads 4 past them.
+			const __m128i spread = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+			const __m128i alphas = _mm_set1_epi32(static_cast<int>(uint32_t{ alpha } << 24));
+			for (; i + 6 <= pixels; i += 4) {
+				__m128i rgb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 3 * i));
+				__m128i rgba = _mm_or_si128(_mm_shuffle_epi8(rgb, spread), alphas);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 4 * i), rgba);
+			}
+		}
+#endif
+		for (; i < pixels; ++i) {
+			dst[4 * i + 0] = src[3 * i + 0];
+			dst[4 * i + 1] = src[3 * i + 1];
+			dst[4 * i + 2] = src[3 * i + 2];
+			dst[4 * i + 3] = alpha;
+		}
+	}
+
+	// drops the alpha channel of a run of RGBA pixels.
+	template<typename T>
+	void shrinkRGBAToRGB(const T* src, T* dst, std::size_t pixels)
+	{
+		std::size_t i = 0;
+#if defined(__SSE4_1__)
+		if constexpr (std::is_same_v<T, uint8_t>) {
+			const __m128i pack = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+			for (; i + 4 <= pixels; i += 4) {
+				__m128i rgba = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 4 * i));
+				__m128i rgb = _mm_shuffle_epi8(rgba, pack);
+				_mm_storel_epi64(reinterpret_cast<__m128i*>(dst + 3 * i), rgb);
+				int32_t last = _mm_extract_epi32(rgb, 2);
+				std::memcpy(dst + 3 * i + 8, &last, sizeof(last));
+			}
+		}
+#endif
+		for (; i < pixels; ++i) {
+			dst[3 * i + 0] = src[4 * i + 0];
+			dst[3 * i + 1] = src[4 * i + 1];
+			dst[3 * i + 2] = src[4 * i + 2];
+		}
+	}
+
+	// swaps the first and third byte of every 4 byte pixel, RGBA to BGRA and
+	// back. src and dst may be the same.
+	inline void swizzleBGRA(const uint8_t* src, uint8_t* dst, std::size_t pixels)
+	{
+		std::size_t i = 0;
+#if defined(__AVX2__)
+		const __m256i swap8 = _mm256_setr_epi8(
+			2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+			2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+		for (; i + 8 <= pixels; i += 8) {
+			__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 4 * i));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 4 * i), _mm256_shuffle_epi8(v, swap8));
+		}
+#endif
+#if defined(__SSE4_1__)
+		const __m128i swap4 = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+		for (; i + 4 <= pixels; i += 4) {
+			__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 4 * i));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 4 * i), _mm_shuffle_epi8(v, swap4));
+		}
+#endif
+		for (; i < pixels; ++i) {
+			uint8_t r = src[4 * i + 0];
+			uint8_t b = src[4 * i + 2];
+			dst[4 * i + 0] = b;
+			dst[4 * i + 1] = src[4 * i + 1];
+			dst[4 * i + 2] = r;
+			dst[4 * i + 3] = src[4 * i + 3];
+		}
+	}
+
+	// Pixels that are an array of NumChannels channels of one type, the
+	// packed pixels are not.
+	template<class P>
+	struct PlainPixel : std::false_type {};
+
+	template<typename T, int N>
+	struct PlainPixel<tc::cpu::Pixel<T, N>> : std::true_type {
+		using ChannelType = T;
+		template<int M>
+		using WithChannels = tc::cpu::Pixel<T, M>;
+	};
+
+	template<int N>
+	struct PlainPixel<tc::cpu::UNorm8Pixel<N>> : std::true_type {
+		using ChannelType = uint8_t;
+		template<int M>
+		using WithChannels = tc::cpu::UNorm8Pixel<M>;
+	};
+
+	template<class P>
+	inline constexpr bool is_plain_pixel_v = PlainPixel<P>::value;
+
+	// count channels of type S to D.
+	template<typename S, typename D>
+	void convertChannels(const S* src, D* dst, std::size_t count)
+	{
+		if constexpr (std::is_same_v<S, D>) {
+			std::memcpy(dst, src, count * sizeof(S));
+		}
+		else if constexpr (std::is_same_v<S, uint8_t> && std::is_same_v<D, float>) {
+			u8ToF32(src, dst, count);
+		}
+		else if constexpr (std::is_same_v<S, float> && std::is_same_v<D, uint8_t>) {
+			f32ToU8(src, dst, count);
+		}
+		else if constexpr (std::is_same_v<S, float> && std::is_same_v<D, half>) {
+			f32ToF16(src, dst, count);
+		}
+		else if constexpr (std::is_same_v<S, half> && std::is_same_v<D, float>) {
+			f16ToF32(src, dst, count);
+		}
+		else if constexpr (std::is_same_v<S, uint8_t> && std::is_same_v<D, half>) {
+			u8ToF16(src, dst, count);
+		}
+		else if constexpr (std::is_same_v<S, half> && std::is_same_v<D, uint8_t>) {
+			f16ToU8(src, dst, count);
+		}
+		else {
+			for (std::size_t i = 0; i < count; ++i) {
+				dst[i] = ChannelConverter<S, D>::apply(src[i]);
+			}
+		}
+	}
+
+	namespace detail
+	{
+		template<tc::Channel C, class Src, class Dst>
+		void convertChannel(const Src& src, Dst& dst)
+		{
+			using S = typename Src::template ChannelType<C>;
+			using D = typename Dst::template ChannelType<C>;
+			dst.template set<C>(ChannelConverter<S, D>::apply(src.template get<C>()));
+		}
+	}
+
+	// Converts count pixels like imageStore(imageLoad()) would one channel at
+	// a time: a channel that Src lacks reads as its minimum, or maximum for
+	// alpha, and a channel that Dst lacks is dropped.
+	template<tc::cpu::PixelConcept Src, tc::cpu::PixelConcept Dst>
+	void convertPixels(const Src* src, Dst* dst, std::size_t count)
+	{
+		constexpr int SN = Src::NumChannels;
+		constexpr int DN = Dst::NumChannels;
+		constexpr bool bulk = is_plain_pixel_v<Src> && is_plain_pixel_v<Dst>
+			&& (SN == DN || (SN == 3 && DN == 4) || (SN == 4 && DN == 3));
+
+		if constexpr (bulk) {
+			using S = typename PlainPixel<Src>::ChannelType;
+			using D = typename PlainPixel<Dst>::ChannelType;
+			const S* s = reinterpret_cast<const S*>(src);
+			D* d = reinterpret_cast<D*>(dst);
+
+			if constexpr (SN == DN) {
+				convertChannels(s, d, count * SN);
+			}
+			else {
+				// reshape in the channel type of Src, then convert the channels.
+				std::array<S, detail::ChunkSize * 4> staged;
+				for (std::size_t i = 0; i < count; i += detail::ChunkSize) {
+					std::size_t n = std::min(detail::ChunkSize, count - i);
+					S* reshaped = staged.data();
+					if constexpr (std::is_same_v<S, D>) {
+						reshaped = d + i * DN;
+					}
+					if constexpr (SN == 3) {
+						expandRGBToRGBA(s + i * SN, reshaped, n, channel_max<S>());
+					}
+					else {
+						shrinkRGBAToRGB(s + i * SN, reshaped, n);
+					}
+					if constexpr (!std::is_same_v<S, D>) {
+						convertChannels(reshaped, d + i * DN, n * DN);
+					}
+				}
+			}
+		}
+		else {
+			for (std::size_t i = 0; i < count; ++i) {
+				Dst out{};
+				detail::convertChannel<tc::Channel::R>(src[i], out);
+				detail::convertChannel<tc::Channel::G>(src[i], out);
+				detail::convertChannel<tc::Channel::B>(src[i], out);
+				detail::convertChannel<tc::Channel::A>(src[i], out);
+				dst[i] = out;
+			}
+		}
+	}
+}
@@ -2,13 +2,20 @@
 #include <limits>
 #include <vector>
 #include <concepts>
+#include <string>
 #include <string_view>
 #include <stdexcept>
 #include <algorithm>
 #include <random>
+#include <tuple>
+#include <utility>
+#include <atomic>
+#include <span>
 
 #include "vec.hpp"
 #include "images/ImageFormat.hpp"
+#include "images/PixelConversion.hpp"
+#include "layout/soa.hpp"
 // ──────────────────────────────────────────────────────────────
 // 1.  Kernel entry‑point concept
 // ──────────────────────────────────────────────────────────────
@@ -32,6 +39,8 @@ namespace tc
 {
 	// Thread‑local slot that dispatcher writes before invoking kernel
 	inline thread_local tc::uvec3 gl_GlobalInvocationID(0, 0, 0);
+	inline thread_local tc::uvec3 gl_WorkGroupID(0, 0, 0);
+	inline thread_local tc::uvec3 gl_LocalInvocationID(0, 0, 0);
 
 	template<typename> struct is_vec_base_impl : std::false_type {};
 
@@ -98,6 +107,158 @@ namespace tc
 		}
 	};
 
+	// Order of the elements of a 2D or 3D BufferResource in memory.
+	// Linear is row-major. Tiled stores blocks of 8x8 (8x8x8 in 3D) elements
+	// contiguously and Morton interleaves the bits of the coordinates inside
+	// blocks of 16x16 (8x8x8) elements, both keep the neighbours of an element
+	// in the same few cache lines, which is what stencil kernels on the CPU need. Images on the GPU are always linear, the
+	// GPU backend converts when uploading.
+	// SoA applies to 1D buffers of structs, see layout/soa.hpp.
+	enum class StorageLayout {
+		Linear, Tiled, Morton, SoA
+	};
+
+	// What imageLoad returns for a coordinate outside the image. None leaves
+	// it undefined, debug builds throw on the CPU. ClampToEdge reads the
+	// nearest edge pixel, Repeat wraps around like a torus. Border reads zero
+	// in every channel on the CPU only: the transpiler leaves its imageLoad as
+	// it is and an out of range imageLoad is undefined in GLSL, unless the
+	// context has robust buffer access. Stores are not addressed, a stencil
+	// no longer needs a padded image for its neighbours.
+	enum class AddressMode {
+		None, ClampToEdge, Repeat, Border
+	};
+
+	namespace detail {
+		// spreads the lower 16 bits of v to the even bits.
+		constexpr uint32_t part1By1(uint32_t v) {
+			v &= 0x0000ffffu;
+			v = (v | (v << 8)) & 0x00ff00ffu;
+			v = (v | (v << 4)) & 0x0f0f0f0fu;
+			v = (v | (v << 2)) & 0x33333333u;
+			v = (v | (v << 1)) & 0x55555555u;
+			return v;
+		}
+
+		// spreads the lower 10 bits of v to every third bit.
+		constexpr uint32_t part1By2(uint32_t v) {
+			v &= 0x000003ffu;
+			v = (v | (v << 16)) & 0xff0000ffu;
+			v = (v | (v << 8)) & 0x0300f00fu;
+			v = (v | (v << 4)) & 0x030c30c3u;
+			v = (v | (v << 2)) & 0x09249249u;
+			return v;
+		}
+	}
+
+	template<tc::Dim D, StorageLayout L>
+	struct LayoutTraits;
+
+	template<tc::Dim D>
+	struct LayoutTraits<D, StorageLayout::Linear> {
+		using IndexType = typename DimTraits<D>::IndexType;
+
+		static constexpr int32_t storageSize(IndexType dim) {
+			return DimTraits<D>::product(dim);
+		}
+
+		static constexpr int32_t coordinateToIndex(IndexType coord, IndexType size) {
+			return DimTraits<D>::coordinateToIndex(coord, size);
+		}
+	};
+
+	template<>
+	struct LayoutTraits<tc::Dim::D2, StorageLayout::Tiled> {
+		using IndexType = tc::ivec2;
+		static constexpr int32_t TileShift = 3;
+		static constexpr int32_t TileMask = (1 << TileShift) - 1;
+
+		static constexpr int32_t tiles(int32_t extent) {
+			return (extent + TileMask) >> TileShift;
+		}
+
+		static constexpr int32_t storageSize(IndexType dim) {
+			return (tiles(dim.x) * tiles(dim.y)) << (2 * TileShift);
+		}
+
+		static constexpr int32_t coordinateToIndex(IndexType coord, IndexType size) {
+			int32_t tile = (coord.y >> TileShift) * tiles(size.x) + (coord.x >> TileShift);
+			return (tile << (2 * TileShift)) | ((coord.y & TileMask) << TileShift) | (coord.x & TileMask);
+		}
+	};
+
+	template<>
+	struct LayoutTraits<tc::Dim::D3, StorageLayout::Tiled> {
+		using IndexType = tc::ivec3;
+		static constexpr int32_t TileShift = 3;
+		static constexpr int32_t TileMask = (1 << TileShift) - 1;
+
+		static constexpr int32_t tiles(int32_t extent) {
+			return (extent + TileMask) >> TileShift;
+		}
+
+		static constexpr int32_t storageSize(IndexType dim) {
+			return (tiles(dim.x) * tiles(dim.y) * tiles(dim.z)) << (3 * TileShift);
+		}
+
+		static constexpr int32_t coordinateToIndex(IndexType coord, IndexType size) {
+			int32_t tile = ((coord.z >> TileShift) * tiles(size.y) + (coord.y >> TileShift)) * tiles(size.x)
+				+ (coord.x >> TileShift);
+			return (tile << (3 * TileShift))
+				| ((coord.z & TileMask) << (2 * TileShift))
+				| ((coord.y & TileMask) << TileShift)
+				| (coord.x & TileMask);
+		}
+	};
+
+	// Morton order inside fixed blocks of 16x16 (8x8x8 in 3D) elements, the
+	// blocks themselves are row-major like the tiles of Tiled. Only the edge
+	// blocks are padded, whatever the aspect ratio or size of the buffer.
+	template<>
+	struct LayoutTraits<tc::Dim::D2, StorageLayout::Morton> {
+		using IndexType = tc::ivec2;
+		static constexpr int32_t BlockShift = 4;
+		static constexpr int32_t BlockMask = (1 << BlockShift) - 1;
+
+		static constexpr int32_t blocks(int32_t extent) {
+			return (extent + BlockMask) >> BlockShift;
+		}
+
+		static constexpr int32_t storageSize(IndexType dim) {
+			return (blocks(dim.x) * blocks(dim.y)) << (2 * BlockShift);
+		}
+
+		static constexpr int32_t coordinateToIndex(IndexType coord, IndexType size) {
+			int32_t block = (coord.y >> BlockShift) * blocks(size.x) + (coord.x >> BlockShift);
+			uint32_t morton = detail::part1By1(coord.x & BlockMask) | (detail::part1By1(coord.y & BlockMask) << 1);
+			return (block << (2 * BlockShift)) | static_cast<int32_t>(morton);
+		}
+	};
+
+	template<>
+	struct LayoutTraits<tc::Dim::D3, StorageLayout::Morton> {
+		using IndexType = tc::ivec3;
+		static constexpr int32_t BlockShift = 3;
+		static constexpr int32_t BlockMask = (1 << BlockShift) - 1;
+
+		static constexpr int32_t blocks(int32_t extent) {
+			return (extent + BlockMask) >> BlockShift;
+		}
+
+		static constexpr int32_t storageSize(IndexType dim) {
+			return (blocks(dim.x) * blocks(dim.y) * blocks(dim.z)) << (3 * BlockShift);
+		}
+
+		static constexpr int32_t coordinateToIndex(IndexType coord, IndexType size) {
+			int32_t block = ((coord.z >> BlockShift) * blocks(size.y) + (coord.y >> BlockShift)) * blocks(size.x)
+				+ (coord.x >> BlockShift);
+			uint32_t morton = detail::part1By2(coord.x & BlockMask)
+				| (detail::part1By2(coord.y & BlockMask) << 1)
+				| (detail::part1By2(coord.z & BlockMask) << 2);
+			return (block << (3 * BlockShift)) | static_cast<int32_t>(morton);
+		}
+	};
+
 	template<UniformValue T, unsigned Location>
 	class Uniform
 	{
@@ -140,11 +301,34 @@ namespace tc
 		T m_Value;
 	};
 
-	template<typename T, tc::Dim D = tc::Dim::D1>
+	// Constant of a kernel that is known when the kernel is compiled.
+	// On the CPU it is a constexpr, the transpiler turns it into a constant that
+	// GPUBackend::specialize can override, with one program per set of values.
+	template<typename T, unsigned Id, T Default>
+		requires GLSLType<T>
+	class SpecConstant
+	{
+	public:
+		static constexpr T value = Default;
+
+		static constexpr T get() {
+			return value;
+		}
+
+		constexpr operator T() const {
+			return value;
+		}
+	};
+
+	template<typename T, tc::Dim D = tc::Dim::D1, StorageLayout L = StorageLayout::Linear>
+		requires (L == StorageLayout::SoA ? D == tc::Dim::D1 : (D != tc::Dim::D1 || L == StorageLayout::Linear))
 	class BufferResource
 	{
+		static_assert(L != StorageLayout::SoA,
+			"TC_SOA_FIELDS(T, ...) has to be declared before a structure of arrays buffer of T is used.");
 	public:
 		using dimType = typename DimTraits<D>::IndexType;
+		static constexpr StorageLayout Layout = L;
 
 		BufferResource()
 			:m_BufferSize{ 0 }
@@ -154,10 +338,19 @@ namespace tc
 
 		BufferResource(dimType bufferSize)
 			:m_BufferSize(bufferSize),
-			m_Data(Traits::product(bufferSize))
+			m_Data(Traits::storageSize(bufferSize))
 		{
 		}
 
+		// takes over storage that already holds the elements in the order of the layout
+		BufferResource(dimType bufferSize, std::vector<T>&& storage)
+			:m_BufferSize(bufferSize),
+			m_Data(std::move(storage))
+		{
+			if (m_Data.size() != static_cast<size_t>(Traits::storageSize(bufferSize)))
+				throw std::runtime_error("BufferResource: the storage does not match the buffer size.");
+		}
+
 		const T& operator[](dimType index) const
 		{
 			return m_Data[Traits::coordinateToIndex(index, m_BufferSize)];
@@ -168,7 +361,34 @@ namespace tc
 			return m_Data[Traits::coordinateToIndex(index, m_BufferSize)];
 		}
 
+		// Copies the elements in row-major order to dst, which holds
+		// product(getDimension()) elements.
+		void copyToLinear(T* dst) const
+		{
+			if constexpr (L == StorageLayout::Linear) {
+				std::copy(m_Data.begin(), m_Data.end(), dst);
+			}
+			else {
+				forEachLinear([&](dimType coord, int32_t linear) {
+					dst[linear] = (*this)[coord];
+					});
+			}
+		}
+
+		// Fills the buffer from elements in row-major order.
+		void copyFromLinear(const T* src)
+		{
+			if constexpr (L == StorageLayout::Linear) {
+				std::copy(src, src + m_Data.size(), m_Data.begin());
+			}
+			else {
+				forEachLinear([&](dimType coord, int32_t linear) {
+					(*this)[coord] = src[linear];
+					});
+			}
+		}
 
+		// number of stored elements, a tiled layout pads the edge tiles.
 		size_t size() const {
 			return m_Data.size();
 		}
@@ -177,6 +397,10 @@ namespace tc
 			return m_Data.data();
 		}
 
+		const T* data() const {
+			return m_Data.data();
+		}
+
 		unsigned int getSSBO_ID() const {
 			return m_SSBO_ID;
 		}
@@ -234,7 +458,29 @@ namespace tc
 		}
 
 	private:
-		using Traits = DimTraits<D>;
+		using Traits = LayoutTraits<D, L>;
+
+		template<typename F>
+		void forEachLinear(F&& f) const
+		{
+			if constexpr (D == tc::Dim::D2) {
+				for (int32_t y = 0; y < m_BufferSize.y; ++y) {
+					for (int32_t x = 0; x < m_BufferSize.x; ++x) {
+						f(dimType{ x, y }, y * m_BufferSize.x + x);
+					}
+				}
+			}
+			else {
+				for (int32_t z = 0; z < m_BufferSize.z; ++z) {
+					for (int32_t y = 0; y < m_BufferSize.y; ++y) {
+						for (int32_t x = 0; x < m_BufferSize.x; ++x) {
+							f(dimType{ x, y, z }, (z * m_BufferSize.y + y) * m_BufferSize.x + x);
+						}
+					}
+				}
+			}
+		}
+
 		dimType m_BufferSize;
 		std::vector<T> m_Data;
 		unsigned int m_SSBO_ID{ 0 };
@@ -242,7 +488,102 @@ namespace tc
 	};
 
 
-	template<typename T, unsigned Binding, unsigned Set = 0 >
+	// One array per member of T, operator[] returns a reference struct with the
+	// member names of T. Every array is a separate SSBO on the GPU.
+	// TC_SOA_FIELDS(T, ...) has to precede the first use of the buffer.
+	template<typename T>
+		requires soa::HasFields<T>
+	class BufferResource<T, tc::Dim::D1, StorageLayout::SoA>
+	{
+	public:
+		using dimType = typename DimTraits<tc::Dim::D1>::IndexType;
+		using Fields = soa::Fields<T>;
+		using reference = typename Fields::reference;
+		using const_reference = typename Fields::const_reference;
+		static constexpr StorageLayout Layout = StorageLayout::SoA;
+		static constexpr std::size_t FieldCount = Fields::Count;
+
+		BufferResource()
+			:m_BufferSize{ 0 }
+		{
+			// no size
+		}
+
+		BufferResource(dimType bufferSize)
+			:m_BufferSize(bufferSize)
+		{
+			std::apply([&](auto&... column) { (column.resize(bufferSize), ...); }, m_Columns);
+		}
+
+		const_reference operator[](dimType index) const
+		{
+			return std::apply([&](const auto&... column) { return const_reference{ column[index]... }; }, m_Columns);
+		}
+
+		reference operator[](dimType index)
+		{
+			return std::apply([&](auto&... column) { return reference{ column[index]... }; }, m_Columns);
+		}
+
+		size_t size() const {
+			return m_BufferSize;
+		}
+
+		// the array of member I.
+		template<std::size_t I>
+		auto& column() {
+			return std::get<I>(m_Columns);
+		}
+
+		template<std::size_t I>
+		const auto& column() const {
+			return std::get<I>(m_Columns);
+		}
+
+		unsigned int getSSBO_ID(std::size_t field) const {
+			return m_SSBO_IDs[field];
+		}
+
+		void setSSBO_ID(std::size_t field, unsigned int ssbo_id) {
+			m_SSBO_IDs[field] = ssbo_id;
+		}
+
+		dimType getDimension() const {
+			return m_BufferSize;
+		}
+
+		void swap(BufferResource& other) noexcept
+		{
+			using std::swap;
+			swap(m_BufferSize, other.m_BufferSize);
+			swap(m_SSBO_IDs, other.m_SSBO_IDs);
+			swap(m_Columns, other.m_Columns);
+		}
+
+		friend void swap(BufferResource& a, BufferResource& b) noexcept(noexcept(a.swap(b))) {
+			a.swap(b);
+		}
+
+		void setBufferLocation(BufferLocation loc) {
+			m_BufferLocation = loc;
+		}
+
+		bool isOnCPU() {
+			return m_BufferLocation == BufferLocation::CPU;
+		}
+
+		bool isOnGPU() {
+			return m_BufferLocation == BufferLocation::GPU;
+		}
+
+	private:
+		dimType m_BufferSize;
+		typename Fields::Columns m_Columns;
+		std::array<unsigned int, FieldCount> m_SSBO_IDs{};
+		BufferLocation m_BufferLocation{ BufferLocation::CPU };
+	};
+
+	template<typename T, unsigned Binding, unsigned Set = 0, StorageLayout L = StorageLayout::Linear>
 	class BufferBinding
 	{
 	public:
@@ -252,17 +593,19 @@ namespace tc
 
 		}
 
-		const T& operator[](unsigned idx) const
+		// an element, or a reference struct to the members of the element
+		// for a structure of arrays buffer.
+		decltype(auto) operator[](unsigned idx) const
 		{
-			return (*m_pBufferData)[idx];
+			return std::as_const(*m_pBufferData)[idx];
 		}
 
-		T& operator[](unsigned idx)
+		decltype(auto) operator[](unsigned idx)
 		{
 			return (*m_pBufferData)[idx];
 		}
 
-		void attach(BufferResource<T>* pData) {
+		void attach(BufferResource<T, tc::Dim::D1, L>* pData) {
 			m_pBufferData = pData;
 		}
 
@@ -270,22 +613,23 @@ namespace tc
 			return m_pBufferData->size();
 		}
 
-		BufferResource<T>* getBufferData() const {
+		BufferResource<T, tc::Dim::D1, L>* getBufferData() const {
 			return m_pBufferData;
 		}
 
 		template<unsigned B2, unsigned S2>
-		friend void swap(BufferBinding& a, BufferBinding<T, B2, S2>& b) noexcept {
+		friend void swap(BufferBinding& a, BufferBinding<T, B2, S2, L>& b) noexcept {
 			using std::swap;
 			swap(*a.getBufferData(), *b.getBufferData());
 		}
 
 		static const unsigned SET = Set;
 		static const unsigned BINDING = Binding;
+		static constexpr StorageLayout Layout = L;
 	private:
-		BufferResource<T>* m_pBufferData;
+		BufferResource<T, tc::Dim::D1, L>* m_pBufferData;
 
-		template<typename T, unsigned B1, unsigned S1>
+		template<typename U, unsigned B1, unsigned S1, StorageLayout L1>
 		friend class BufferBinding;
 	};
 
@@ -316,29 +660,140 @@ namespace tc
 	template<>
 	struct GPUFormatTraits<tc::InternalFormat::R32F> {
 		using ChannelType = float;
-		using VectorType = tc::uvec4;
+		using VectorType = tc::vec4;
+		static inline constexpr std::array<tc::Channel, 4> channels{ Channel::R, Channel::Min, Channel::Min, Channel::Max };
+	};
+
+	template<>
+	struct GPUFormatTraits<tc::InternalFormat::RGBA16F> {
+		using ChannelType = float;
+		using VectorType = tc::vec4;
+		static inline constexpr std::array<tc::Channel, 4> channels{ Channel::R, Channel::G, Channel::B, Channel::A };
+	};
+
+	template<>
+	struct GPUFormatTraits<tc::InternalFormat::R16F> {
+		using ChannelType = float;
+		using VectorType = tc::vec4;
 		static inline constexpr std::array<tc::Channel, 4> channels{ Channel::R, Channel::Min, Channel::Min, Channel::Max };
 	};
 
-	template<tc::InternalFormat G, tc::Dim D, tc::cpu::PixelConcept pixType, unsigned Binding, unsigned Set = 0 >
+	template<>
+	struct GPUFormatTraits<tc::InternalFormat::R11F_G11F_B10F> {
+		using ChannelType = float;
+		using VectorType = tc::vec4;
+		static inline constexpr std::array<tc::Channel, 4> channels{ Channel::R, Channel::G, Channel::B, Channel::Max };
+	};
+
+	template<>
+	struct GPUFormatTraits<tc::InternalFormat::RGB10_A2> {
+		using ChannelType = float;
+		using VectorType = tc::vec4;
+		static inline constexpr std::array<tc::Channel, 4> channels{ Channel::R, Channel::G, Channel::B, Channel::A };
+	};
+
+	// The pixels of an image as imageLoad and imageStore on the CPU see them:
+	// the first pixel and the size, so an access is the index computation of
+	// the layout and nothing else. It does not check anything, a view that
+	// outlives a resize or swap of its buffer points at the old pixels, which
+	// is why ImageBinding::view hands out a copy.
+	template<tc::cpu::PixelConcept P, tc::Dim D, StorageLayout L>
+	struct ImageView
+	{
+		using dimType = typename DimTraits<D>::IndexType;
+
+		P* base{ nullptr };
+		dimType size{};
+
+		P& operator[](dimType coord) const {
+			return base[LayoutTraits<D, L>::coordinateToIndex(coord, size)];
+		}
+
+		bool isViewOf(const P* data, dimType dimension) const {
+			if constexpr (D == tc::Dim::D1) {
+				return base == data && size == dimension;
+			}
+			else {
+				return base == data && tc::all(size == dimension);
+			}
+		}
+
+		// coord moved into the image by ClampToEdge or Repeat.
+		template<AddressMode A>
+		dimType address(dimType coord) const {
+			auto axis = [](int32_t c, int32_t extent) {
+				if constexpr (A == AddressMode::ClampToEdge) {
+					return std::clamp(c, 0, extent - 1);
+				}
+				else {
+					const int32_t r = c % extent;
+					return r < 0 ? r + extent : r;
+				}
+				};
+			if constexpr (D == tc::Dim::D1) {
+				return axis(coord, size);
+			}
+			else if constexpr (D == tc::Dim::D2) {
+				return dimType{ axis(coord.x, size.x), axis(coord.y, size.y) };
+			}
+			else {
+				return dimType{ axis(coord.x, size.x), axis(coord.y, size.y), axis(coord.z, size.z) };
+			}
+		}
+
+		bool contains(dimType coord) const {
+			if constexpr (D == tc::Dim::D1) {
+				return coord >= 0 && coord < size;
+			}
+			else if constexpr (D == tc::Dim::D2) {
+				return coord.x >= 0 && coord.y >= 0 && coord.x < size.x && coord.y < size.y;
+			}
+			else {
+				return coord.x >= 0 && coord.y >= 0 && coord.z >= 0
+					&& coord.x < size.x && coord.y < size.y && coord.z < size.z;
+			}
+		}
+	};
+
+	template<tc::InternalFormat G, tc::Dim D, tc::cpu::PixelConcept pixType, unsigned Binding, unsigned Set = 0,
+		StorageLayout L = StorageLayout::Linear, AddressMode A = AddressMode::None>
 	class ImageBinding
 	{
 	public:
+		using View = ImageView<pixType, D, L>;
+
 		ImageBinding()
 			:m_pBufferData{ nullptr }
 		{
 
 		}
 
-		void attach(BufferResource<pixType, D>* pData) {
+		void attach(BufferResource<pixType, D, L>* pData) {
 			m_pBufferData = pData;
+			bindView();
+		}
+
+		// takes the view of the attached buffer again, after it was resized or
+		// swapped. The CPU backend does this when the image is bound.
+		void bindView() const {
+			m_View = m_pBufferData ? View{ m_pBufferData->data(), m_pBufferData->getDimension() } : View{};
+		}
+
+		// the view taken when the image was bound, or a new one when the
+		// buffer was swapped or resized since. The cached view is not written
+		// here, invocations on several threads call this at the same time.
+		View view() const {
+			if (m_pBufferData && !m_View.isViewOf(m_pBufferData->data(), m_pBufferData->getDimension())) [[unlikely]] {
+				return View{ m_pBufferData->data(), m_pBufferData->getDimension() };
+			}
+			return m_View;
 		}
 
 		unsigned size() const {
 			return m_pBufferData->size();
 		}
 
-		BufferResource<pixType, D>* getBufferData() const {
+		BufferResource<pixType, D, L>* getBufferData() const {
 			return m_pBufferData;
 		}
 
@@ -346,44 +801,12 @@ namespace tc
 		inline static constexpr tc::Dim Dimension = D;
 		inline static constexpr unsigned BINDING = Binding;
 		inline static constexpr unsigned SET = Set;
+		inline static constexpr StorageLayout Layout = L;
+		inline static constexpr AddressMode Addressing = A;
 	private:
-		BufferResource<pixType, D>* m_pBufferData;
-	};
-
-	template<class Src, class Dst>
-	struct ChannelConverter;
-
-	template<class T>
-	struct ChannelConverter<T, T> {
-		static constexpr T apply(T v) noexcept { return v; }
-	};
-
-	template<>
-	struct ChannelConverter<std::uint8_t, float> {
-		static constexpr float apply(std::uint8_t v) noexcept {
-			return float(v) * (1.0f / 255.0f);
-		}
-	};
-
-	template<>
-	struct ChannelConverter<std::uint8_t, std::uint32_t> {
-		static constexpr uint32_t apply(std::uint8_t v) noexcept {
-			return v;
-		}
-	};
-
-	template<>
-	struct ChannelConverter<std::uint32_t, std::uint8_t> {
-		static constexpr uint8_t apply(std::uint32_t v) noexcept {
-			return static_cast<uint8_t>(std::clamp(v, 0u, 255u));
-		}
-	};
-
-	template<>
-	struct ChannelConverter<float, std::uint8_t> {
-		static constexpr uint8_t apply(float v) noexcept {
-			return static_cast<uint8_t>(std::clamp(v, 0.0f, 1.0f) * 255.0f + 0.5f);
-		}
+		BufferResource<pixType, D, L>* m_pBufferData;
+		// a cache of the buffer, not part of the state of the binding.
+		mutable View m_View;
 	};
 
 	template<Dim D>
@@ -420,32 +843,75 @@ namespace tc
 
 
 
-	template<tc::InternalFormat G, tc::Dim D, tc::cpu::PixelConcept P, unsigned B, unsigned S>
-	auto imageLoad(const ImageBinding<G, D, P, B, S>& image, tcVec<D> texCoord)
+	namespace detail
 	{
-		const auto* buf = image.getBufferData();
-		if (!buf) throw std::runtime_error("imageLoad: no buffer attached");
-
-		const P& px = (*buf)[texCoord];
+		// Debug builds check every image access, release builds trust the view.
+		template<tc::InternalFormat G, tc::Dim D, tc::cpu::PixelConcept P, unsigned B, unsigned S, StorageLayout L, AddressMode A>
+		void checkImageAccess(const ImageBinding<G, D, P, B, S, L, A>& image, tcVec<D> texCoord, const char* function,
+			bool addressed = false)
+		{
+			const auto* buf = image.getBufferData();
+			if (!buf) {
+				throw std::runtime_error(std::string(function) + ": no buffer attached");
+			}
+			if (!addressed && !image.view().contains(texCoord)) {
+				throw std::runtime_error(std::string(function) + ": coordinate outside the image");
+			}
+		}
+	}
 
-		using gpuTraits = GPUFormatTraits<G>;
-		using dst_t = typename gpuTraits::ChannelType;
-		using vec_t = typename gpuTraits::VectorType;
+	namespace detail
+	{
+		template<tc::InternalFormat G, tc::cpu::PixelConcept P>
+		auto loadPixel(const P& px)
+		{
+			using gpuTraits = GPUFormatTraits<G>;
+			using dst_t = typename gpuTraits::ChannelType;
+			using vec_t = typename gpuTraits::VectorType;
+
+			static_assert(std::size(gpuTraits::channels) == 4,
+				"GPUFormatTraits::channels must define 4 components.");
+
+			dst_t r = loadChannel<gpuTraits::channels[0], dst_t, P>(px);
+			dst_t g = loadChannel<gpuTraits::channels[1], dst_t, P>(px);
+			dst_t b = loadChannel<gpuTraits::channels[2], dst_t, P>(px);
+			dst_t a = loadChannel<gpuTraits::channels[3], dst_t, P>(px);
+			return vec_t{ r,g,b,a };
+		}
 
-		static_assert(std::size(gpuTraits::channels) == 4,
-			"GPUFormatTraits::channels must define 4 components.");
+		// the edge path of an addressed imageLoad, pixels inside the image do
+		// not pay for the addressing.
+		template<tc::InternalFormat G, AddressMode A, tc::cpu::PixelConcept P, tc::Dim D, StorageLayout L>
+		auto loadOutside(const ImageView<P, D, L>& view, tcVec<D> texCoord)
+		{
+			if constexpr (A == AddressMode::Border) {
+				return typename GPUFormatTraits<G>::VectorType{};
+			}
+			else {
+				return loadPixel<G>(view[view.template address<A>(texCoord)]);
+			}
+		}
+	}
 
-		dst_t r = loadChannel<gpuTraits::channels[0], dst_t, P>(px);
-		dst_t g = loadChannel<gpuTraits::channels[1], dst_t, P>(px);
-		dst_t b = loadChannel<gpuTraits::channels[2], dst_t, P>(px);
-		dst_t a = loadChannel<gpuTraits::channels[3], dst_t, P>(px);
-		return vec_t{ r,g,b,a };
+	template<tc::InternalFormat G, tc::Dim D, tc::cpu::PixelConcept P, unsigned B, unsigned S, StorageLayout L, AddressMode A>
+	auto imageLoad(const ImageBinding<G, D, P, B, S, L, A>& image, tcVec<D> texCoord)
+	{
+#ifndef NDEBUG
+		detail::checkImageAccess(image, texCoord, "imageLoad", A != AddressMode::None);
+#endif
+		const auto& view = image.view();
+		if constexpr (A != AddressMode::None) {
+			if (!view.contains(texCoord)) [[unlikely]] {
+				return detail::loadOutside<G, A>(view, texCoord);
+			}
+		}
+		return detail::loadPixel<G>(view[texCoord]);
 	}
 
-	template<tc::InternalFormat G, tc::Dim D, tc::cpu::PixelConcept P, unsigned B, unsigned S>
-	tcVec<D> imageSize(const ImageBinding<G, D, P, B, S>& image)
+	template<tc::InternalFormat G, tc::Dim D, tc::cpu::PixelConcept P, unsigned B, unsigned S, StorageLayout L, AddressMode A>
+	tcVec<D> imageSize(const ImageBinding<G, D, P, B, S, L, A>& image)
 	{
-		return image.getBufferData()->getDimension();
+		return image.view().size;
 	}
 
 	template<Channel C, class Src, tc::cpu::PixelConcept P>
@@ -454,21 +920,113 @@ namespace tc
 		px.template set<C>(ChannelConverter<Src, dst_t>::apply(value));
 	}
 
-	template<tc::InternalFormat G, tc::Dim D, tc::cpu::PixelConcept P, unsigned B, unsigned S>
+	template<tc::InternalFormat G, tc::Dim D, tc::cpu::PixelConcept P, unsigned B, unsigned S, StorageLayout L, AddressMode A>
 	void imageStore(
-		const ImageBinding<G, D, P, B, S>& image,
+		const ImageBinding<G, D, P, B, S, L, A>& image,
 		tcVec<D> texCoord,
 		typename GPUFormatTraits<G>::VectorType value
 	)
 	{
-		auto* buf = image.getBufferData();
-		if (!buf) throw std::runtime_error("imageStore: no buffer attached");
-
+#ifndef NDEBUG
+		detail::checkImageAccess(image, texCoord, "imageStore");
+#endif
 		using src_t = typename GPUFormatTraits<G>::ChannelType;
-		auto& px = (*buf)[texCoord];
+		auto& px = image.view()[texCoord];
 		channelStore<Channel::R, src_t, P>(px, value.x);
 		channelStore<Channel::G, src_t, P>(px, value.y);
 		channelStore<Channel::B, src_t, P>(px, value.z);
 		channelStore<Channel::A, src_t, P>(px, value.w);
 	}
+
+	namespace detail
+	{
+		// true when imageLoad reads the channels of P in order, the channels
+		// that P lacks as the defaults a pixel reads for them.
+		template<tc::InternalFormat G, tc::cpu::PixelConcept P>
+		constexpr bool loadsPixelInOrder()
+		{
+			constexpr auto channels = GPUFormatTraits<G>::channels;
+			for (int c = 0; c < 4; ++c) {
+				const Channel missing = c == 3 ? Channel::Max : Channel::Min;
+				if (channels[c] != Channel(c) && (c < P::NumChannels || channels[c] != missing)) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+		// a row of a float image can be converted in bulk between P and vec4.
+		template<tc::InternalFormat G, tc::cpu::PixelConcept P, StorageLayout L>
+		inline constexpr bool bulkRow = L == StorageLayout::Linear
+			&& std::same_as<typename GPUFormatTraits<G>::VectorType, tc::vec4>
+			&& std::same_as<typename GPUFormatTraits<G>::ChannelType, float>;
+	}
+
+	// imageLoad of values.size() pixels of a row, from texCoord to the right.
+	// Linear float images convert the whole row at once with tc::convert.
+	// Only for kernels that run on the CPU, GLSL has no counterpart.
+	template<tc::InternalFormat G, tc::Dim D, tc::cpu::PixelConcept P, unsigned B, unsigned S, StorageLayout L, AddressMode A>
+	void imageLoadRow(const ImageBinding<G, D, P, B, S, L, A>& image, tcVec<D> texCoord,
+		std::span<typename GPUFormatTraits<G>::VectorType> values)
+	{
+		if (values.empty()) {
+			return;
+		}
+		tcVec<D> last = texCoord;
+		last.x += static_cast<int32_t>(values.size() - 1);
+#ifndef NDEBUG
+		detail::checkImageAccess(image, texCoord, "imageLoadRow", A != AddressMode::None);
+		detail::checkImageAccess(image, last, "imageLoadRow", A != AddressMode::None);
+#endif
+		if constexpr (detail::bulkRow<G, P, L> && detail::loadsPixelInOrder<G, P>()) {
+			// an addressed row that leaves the image goes pixel by pixel.
+			if (A == AddressMode::None || (image.view().contains(texCoord) && image.view().contains(last))) {
+				static_assert(sizeof(tc::vec4) == sizeof(tc::cpu::RGBA32F));
+				const P* row = &image.view()[texCoord];
+				tc::convert::convertPixels(row, reinterpret_cast<tc::cpu::RGBA32F*>(values.data()), values.size());
+				return;
+			}
+		}
+		for (std::size_t i = 0; i < values.size(); ++i) {
+			tcVec<D> coord = texCoord;
+			coord.x += static_cast<int32_t>(i);
+			values[i] = imageLoad(image, coord);
+		}
+	}
+
+	// imageStore of values to a row of pixels, from texCoord to the right.
+	template<tc::InternalFormat G, tc::Dim D, tc::cpu::PixelConcept P, unsigned B, unsigned S, StorageLayout L, AddressMode A>
+	void imageStoreRow(const ImageBinding<G, D, P, B, S, L, A>& image, tcVec<D> texCoord,
+		std::span<const typename GPUFormatTraits<G>::VectorType> values)
+	{
+		if (values.empty()) {
+			return;
+		}
+#ifndef NDEBUG
+		tcVec<D> last = texCoord;
+		last.x += static_cast<int32_t>(values.size() - 1);
+		detail::checkImageAccess(image, texCoord, "imageStoreRow");
+		detail::checkImageAccess(image, last, "imageStoreRow");
+#endif
+		if constexpr (detail::bulkRow<G, P, L>) {
+			P* row = &image.view()[texCoord];
+			tc::convert::convertPixels(reinterpret_cast<const tc::cpu::RGBA32F*>(values.data()), row, values.size());
+		}
+		else {
+			for (std::size_t i = 0; i < values.size(); ++i) {
+				tcVec<D> coord = texCoord;
+				coord.x += static_cast<int32_t>(i);
+				imageStore(image, coord, values[i]);
+			}
+		}
+	}
+
+	// Adds data to a buffer element and returns the previous value, like the
+	// GLSL atomicAdd on an SSBO member: atomicAdd(counter[0], 1u).
+	template<typename T>
+		requires std::same_as<T, tc::uint> || std::same_as<T, tc::integer>
+	T atomicAdd(T& mem, T data)
+	{
+		return std::atomic_ref<T>(mem).fetch_add(data);
+	}
 }
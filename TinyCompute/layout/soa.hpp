@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <array>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+#include "../vec.hpp"
+#include "std430.hpp"
+
+// Structure of arrays storage of buffer element structs.
+//
+// TC_SOA_FIELDS(S, a, b, c) lists the members of S, in declaration order and
+// all of them. A BufferResource<S, Dim::D1, StorageLayout::SoA> then keeps one
+// array per member and its operator[] returns a reference struct with members
+// of the same names, so buffer[i].a reads like it does on an array of S.
+// On the GPU every member gets its own SSBO, member n of a BufferBinding with
+// binding B is bound at B + n.
+namespace tc::soa
+{
+	// Storage type of a member array, a vec3 array has the std430 stride of
+	// 16 bytes so the array can be uploaded as is.
+	template<typename T>
+	struct column_type {
+		using type = T;
+	};
+
+	template<typename T>
+	struct column_type<tc::vec_base<T, 3>> {
+		using type = tc::std430::vec<T, 3>;
+	};
+
+	template<typename T>
+	using column_t = typename column_type<std::remove_cv_t<T>>::type;
+
+	template<typename S>
+	struct Fields;
+
+	template<typename S>
+	concept HasFields = requires {
+		typename Fields<S>::reference;
+		typename Fields<S>::const_reference;
+	};
+
+	template<typename S, typename... M>
+	auto columnsOf(const std::tuple<M S::*...>&) -> std::tuple<std::vector<column_t<M>>...>;
+}
+
+#define TC_SOA_EXPAND(x) x
+#define TC_SOA_FOR_EACH_1(m, S, a) m(S, a)
+#define TC_SOA_FOR_EACH_2(m, S, a, ...) m(S, a) TC_SOA_EXPAND(TC_SOA_FOR_EACH_1(m, S, __VA_ARGS__))
+#define TC_SOA_FOR_EACH_3(m, S, a, ...) m(S, a) TC_SOA_EXPAND(TC_SOA_FOR_EACH_2(m, S, __VA_ARGS__))
+#define TC_SOA_FOR_EACH_4(m, S, a, ...) m(S, a) TC_SOA_EXPAND(TC_SOA_FOR_EACH_3(m, S, __VA_ARGS__))
+#define TC_SOA_FOR_EACH_5(m, S, a, ...) m(S, a) TC_SOA_EXPAND(TC_SOA_FOR_EACH_4(m, S, __VA_ARGS__))
+#define TC_SOA_FOR_EACH_6(m, S, a, ...) m(S, a) TC_SOA_EXPAND(TC_SOA_FOR_EACH_5(m, S, __VA_ARGS__))
+#define TC_SOA_FOR_EACH_7(m, S, a, ...) m(S, a) TC_SOA_EXPAND(TC_SOA_FOR_EACH_6(m, S, __VA_ARGS__))
+#define TC_SOA_FOR_EACH_8(m, S, a, ...) m(S, a) TC_SOA_EXPAND(TC_SOA_FOR_EACH_7(m, S, __VA_ARGS__))
+#define TC_SOA_FOR_EACH_9(m, S, a, ...) m(S, a) TC_SOA_EXPAND(TC_SOA_FOR_EACH_8(m, S, __VA_ARGS__))
+#define TC_SOA_FOR_EACH_10(m, S, a, ...) m(S, a) TC_SOA_EXPAND(TC_SOA_FOR_EACH_9(m, S, __VA_ARGS__))
+#define TC_SOA_FOR_EACH_11(m, S, a, ...) m(S, a) TC_SOA_EXPAND(TC_SOA_FOR_EACH_10(m, S, __VA_ARGS__))
+#define TC_SOA_FOR_EACH_12(m, S, a, ...) m(S, a) TC_SOA_EXPAND(TC_SOA_FOR_EACH_11(m, S, __VA_ARGS__))
+#define TC_SOA_SELECT(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, NAME, ...) NAME
+#define TC_SOA_FOR_EACH(m, S, ...) TC_SOA_EXPAND(TC_SOA_SELECT(__VA_ARGS__, \
+	TC_SOA_FOR_EACH_12, TC_SOA_FOR_EACH_11, TC_SOA_FOR_EACH_10, TC_SOA_FOR_EACH_9, \
+	TC_SOA_FOR_EACH_8, TC_SOA_FOR_EACH_7, TC_SOA_FOR_EACH_6, TC_SOA_FOR_EACH_5, \
+	TC_SOA_FOR_EACH_4, TC_SOA_FOR_EACH_3, TC_SOA_FOR_EACH_2, TC_SOA_FOR_EACH_1)(m, S, __VA_ARGS__))
+
+#define TC_SOA_MEMBER_POINTER(S, f) &S::f,
+#define TC_SOA_NAME(S, f) #f,
+#define TC_SOA_REFERENCE(S, f) tc::soa::column_t<decltype(S::f)>& f;
+#define TC_SOA_CONST_REFERENCE(S, f) const tc::soa::column_t<decltype(S::f)>& f;
+#define TC_SOA_LOAD(S, f) value.f = f;
+#define TC_SOA_STORE(S, f) f = value.f;
+
+// Lists the members of S for the structure of arrays storage, at most 12.
+#define TC_SOA_FIELDS(S, ...) \
+	template<> \
+	struct tc::soa::Fields<S> { \
+		static constexpr auto members = std::tuple{ TC_SOA_FOR_EACH(TC_SOA_MEMBER_POINTER, S, __VA_ARGS__) }; \
+		static constexpr std::size_t Count = std::tuple_size_v<decltype(members)>; \
+		static constexpr std::array<std::string_view, Count> names{ TC_SOA_FOR_EACH(TC_SOA_NAME, S, __VA_ARGS__) }; \
+		using Columns = decltype(tc::soa::columnsOf(members)); \
+		struct reference { \
+			TC_SOA_FOR_EACH(TC_SOA_REFERENCE, S, __VA_ARGS__) \
+			operator S() const { S value{}; TC_SOA_FOR_EACH(TC_SOA_LOAD, S, __VA_ARGS__) return value; } \
+			const reference& operator=(const S& value) const { TC_SOA_FOR_EACH(TC_SOA_STORE, S, __VA_ARGS__) return *this; } \
+		}; \
+		struct const_reference { \
+			TC_SOA_FOR_EACH(TC_SOA_CONST_REFERENCE, S, __VA_ARGS__) \
+			operator S() const { S value{}; TC_SOA_FOR_EACH(TC_SOA_LOAD, S, __VA_ARGS__) return value; } \
+		}; \
+	}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+#include "../vec.hpp"
+
+// std140 packing of the kernel uniforms.
+//
+// All tc::Uniform fields of a kernel are gathered in one uniform block, a
+// Uniform<T, Location> lives at byte offset SlotSize * Location of that block.
+// The transpiler emits the block with filler members so the GLSL layout
+// matches these offsets, the GPU backend packs the values with store().
+namespace tc::std140
+{
+	constexpr uint32_t SlotSize = 16;
+	constexpr unsigned UniformBlockBinding = 0;
+	constexpr const char* UniformBlockName = "_TCUniforms";
+
+	// base alignment of a scalar or vector, a vec3 is aligned as a vec4.
+	constexpr uint32_t baseAlignment(uint32_t scalarSize, uint32_t components) {
+		return scalarSize * (components == 3 ? 4 : components);
+	}
+
+	constexpr uint32_t byteSize(uint32_t scalarSize, uint32_t components) {
+		return scalarSize * components;
+	}
+
+	constexpr uint32_t slotOffset(unsigned location) {
+		return SlotSize * location;
+	}
+
+	// number of slots taken by a value, only dvec3 and dvec4 need two.
+	constexpr uint32_t slotCount(uint32_t scalarSize, uint32_t components) {
+		return (byteSize(scalarSize, components) + SlotSize - 1) / SlotSize;
+	}
+
+	template<typename T>
+	struct value_traits {
+		using scalar_type = T;
+		static constexpr uint32_t components = 1;
+	};
+
+	template<typename T, uint8_t N>
+	struct value_traits<tc::vec_base<T, N>> {
+		using scalar_type = T;
+		static constexpr uint32_t components = N;
+	};
+
+	// a GLSL bool occupies 4 bytes in a uniform block.
+	template<typename T>
+	constexpr uint32_t scalarSize() {
+		using S = typename value_traits<std::remove_cvref_t<T>>::scalar_type;
+		return std::is_same_v<S, bool> ? 4 : sizeof(S);
+	}
+
+	template<typename T>
+	constexpr uint32_t alignmentOf() {
+		return baseAlignment(scalarSize<T>(), value_traits<std::remove_cvref_t<T>>::components);
+	}
+
+	template<typename T>
+	constexpr uint32_t sizeOf() {
+		return byteSize(scalarSize<T>(), value_traits<std::remove_cvref_t<T>>::components);
+	}
+
+	template<typename T>
+	constexpr bool isValidLocation(unsigned location) {
+		return slotOffset(location) % alignmentOf<T>() == 0;
+	}
+
+	// writes the std140 representation of value to dst.
+	template<typename T>
+	void store(std::byte* dst, const T& value)
+	{
+		using traits = value_traits<std::remove_cvref_t<T>>;
+		using S = typename traits::scalar_type;
+		const S* src;
+		if constexpr (traits::components == 1) {
+			src = &value;
+		}
+		else {
+			src = value.data.data();
+		}
+
+		if constexpr (std::is_same_v<S, bool>) {
+			for (uint32_t i = 0; i < traits::components; ++i) {
+				uint32_t b = src[i] ? 1u : 0u;
+				std::memcpy(dst + i * sizeof(uint32_t), &b, sizeof(uint32_t));
+			}
+		}
+		else {
+			std::memcpy(dst, src, sizeof(S) * traits::components);
+		}
+	}
+}
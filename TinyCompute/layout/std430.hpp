@@ -0,0 +1,147 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <initializer_list>
+#include <span>
+#include <type_traits>
+
+#include "../vec.hpp"
+
+// std430 layout rules for the element structs of a BufferBinding.
+//
+// The C++ layout of an element struct is the reference, the transpiler adds
+// float fillers to the GLSL struct so every member ends up at its C++ offset.
+// That only works when every member is aligned as std430 requires, which is
+// what verify checks. The transpiler runs the same check on the clang record
+// layout, a static_assert on verify catches the mismatch in the C++ build.
+namespace tc::std430
+{
+	// base alignment of a scalar or vector, a vec3 is aligned as a vec4.
+	constexpr uint32_t baseAlignment(uint32_t scalarSize, uint32_t components) {
+		return scalarSize * (components == 3 ? 4 : components);
+	}
+
+	constexpr uint32_t byteSize(uint32_t scalarSize, uint32_t components) {
+		return scalarSize * components;
+	}
+
+	constexpr uint32_t alignUp(uint32_t offset, uint32_t alignment) {
+		return (offset + alignment - 1) / alignment * alignment;
+	}
+
+	// Vector types with the std430 alignment, a vec3 is 16 byte aligned so a
+	// struct member that follows it starts at the next 16 byte boundary.
+	template<typename T, uint8_t N>
+	struct alignas(baseAlignment(sizeof(T), N)) vec : tc::vec_base<T, N>
+	{
+		using base_type = tc::vec_base<T, N>;
+		using base_type::base_type;
+
+		constexpr vec() = default;
+		constexpr vec(const base_type& v) : base_type(v) {}
+	};
+
+	using vec2 = vec<float, 2>;
+	using vec3 = vec<float, 3>;
+	using vec4 = vec<float, 4>;
+
+	using dvec2 = vec<double, 2>;
+	using dvec3 = vec<double, 3>;
+	using dvec4 = vec<double, 4>;
+
+	using ivec2 = vec<std::int32_t, 2>;
+	using ivec3 = vec<std::int32_t, 3>;
+	using ivec4 = vec<std::int32_t, 4>;
+
+	using uvec2 = vec<std::uint32_t, 2>;
+	using uvec3 = vec<std::uint32_t, 3>;
+	using uvec4 = vec<std::uint32_t, 4>;
+
+	struct MemberInfo {
+		uint32_t offset;
+		uint32_t alignment;
+		uint32_t size;
+	};
+
+	enum class LayoutResult {
+		Ok,
+		// a member is not at a multiple of its std430 alignment.
+		Misaligned,
+		// a member starts before the previous one ends.
+		Overlap,
+		// the struct size is not a multiple of its std430 alignment, so the
+		// array stride in GLSL differs from sizeof.
+		Stride
+	};
+
+	// members in declaration order, structSize is sizeof the struct.
+	// pMember receives the index of the member that breaks the layout.
+	constexpr LayoutResult check(std::span<const MemberInfo> members, uint32_t structSize,
+		std::size_t* pMember = nullptr)
+	{
+		uint32_t cursor = 0;
+		uint32_t structAlignment = 4;
+		for (std::size_t i = 0; i < members.size(); ++i) {
+			const MemberInfo& m = members[i];
+			if (pMember != nullptr) {
+				*pMember = i;
+			}
+			if (m.offset % m.alignment != 0) {
+				return LayoutResult::Misaligned;
+			}
+			if (m.offset < cursor) {
+				return LayoutResult::Overlap;
+			}
+			cursor = m.offset + m.size;
+			structAlignment = std::max(structAlignment, m.alignment);
+		}
+		if (structSize < cursor || structSize % structAlignment != 0) {
+			return LayoutResult::Stride;
+		}
+		return LayoutResult::Ok;
+	}
+
+	constexpr LayoutResult check(std::initializer_list<MemberInfo> members, uint32_t structSize)
+	{
+		return check(std::span<const MemberInfo>(members.begin(), members.size()), structSize);
+	}
+
+	template<typename T>
+	struct value_traits;
+
+	template<typename T>
+		requires std::same_as<T, float> || std::same_as<T, double>
+			|| std::same_as<T, std::int32_t> || std::same_as<T, std::uint32_t>
+	struct value_traits<T> {
+		static constexpr uint32_t alignment = sizeof(T);
+		static constexpr uint32_t size = sizeof(T);
+	};
+
+	// a bool is 4 bytes in GLSL and 1 byte in C++, so it is not listed.
+	template<typename T, uint8_t N>
+		requires (!std::same_as<T, bool>)
+	struct value_traits<tc::vec_base<T, N>> {
+		static constexpr uint32_t alignment = baseAlignment(sizeof(T), N);
+		static constexpr uint32_t size = byteSize(sizeof(T), N);
+	};
+
+	template<typename T, uint8_t N>
+	struct value_traits<vec<T, N>> : value_traits<tc::vec_base<T, N>> {
+	};
+
+	template<typename T>
+	constexpr MemberInfo member(std::size_t offset) {
+		return { static_cast<uint32_t>(offset), value_traits<T>::alignment, value_traits<T>::size };
+	}
+
+	template<typename S>
+	constexpr bool verify(std::initializer_list<MemberInfo> members) {
+		return check(members, sizeof(S)) == LayoutResult::Ok;
+	}
+}
+
+// member info of S::name, for use in tc::std430::verify<S>(...)
+#define TC_STD430_MEMBER(S, name) \
+	tc::std430::member<std::remove_cv_t<decltype(S::name)>>(offsetof(S, name))
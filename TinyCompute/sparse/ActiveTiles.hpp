@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <execution>
+#include <span>
+#include <vector>
+
+#include "../vec.hpp"
+
+// Activity tracking for stencil kernels on a 2D grid.
+//
+// The grid is split in tiles. A step of the kernel records which tiles changed,
+// compact turns that into the list of tiles to run next: the changed tiles and
+// their eight neighbours, as the stencil of a cell only reaches into the tiles
+// around it. A tile that is not in the list keeps its cells, so the kernel has
+// to leave both of its ping pong buffers equal for such a tile, which a tile
+// that did not change does. On the GPU the same compaction is done by a kernel
+// with atomicAdd on the group count of an executeIndirect argument buffer.
+namespace tc::sparse
+{
+	class ActiveTiles
+	{
+	public:
+		ActiveTiles(tc::ivec2 gridSize, tc::ivec2 tileSize)
+			:m_TileSize{ tileSize },
+			m_TileCount{ (gridSize.x + tileSize.x - 1) / tileSize.x, (gridSize.y + tileSize.y - 1) / tileSize.y },
+			m_Changed(static_cast<std::size_t>(m_TileCount.x) * m_TileCount.y, 0),
+			m_Marked(m_Changed.size(), 0)
+		{
+		}
+
+		tc::ivec2 getTileSize() const {
+			return m_TileSize;
+		}
+
+		// tiles per row and per column.
+		tc::ivec2 getTileCount() const {
+			return m_TileCount;
+		}
+
+		uint32_t tileOf(tc::ivec2 cell) const {
+			return static_cast<uint32_t>((cell.y / m_TileSize.y) * m_TileCount.x + cell.x / m_TileSize.x);
+		}
+
+		// the first cell of the tile.
+		tc::ivec2 tileOrigin(uint32_t tile) const {
+			int t = static_cast<int>(tile);
+			return tc::ivec2{ (t % m_TileCount.x) * m_TileSize.x, (t / m_TileCount.x) * m_TileSize.y };
+		}
+
+		// can be called from several threads as long as they mark different tiles.
+		void markChanged(uint32_t tile) {
+			m_Changed[tile] = 1;
+		}
+
+		void activateAll() {
+			m_Active.resize(m_Changed.size());
+			for (uint32_t tile = 0; tile < m_Active.size(); ++tile) {
+				m_Active[tile] = tile;
+			}
+		}
+
+		// the active tiles become the changed tiles and their neighbours, in
+		// increasing order. Clears the changed tiles.
+		void compact()
+		{
+			for (uint32_t tile = 0; tile < m_Changed.size(); ++tile) {
+				if (!m_Changed[tile]) {
+					continue;
+				}
+				m_Changed[tile] = 0;
+				int tx = static_cast<int>(tile) % m_TileCount.x;
+				int ty = static_cast<int>(tile) / m_TileCount.x;
+				for (int y = std::max(ty - 1, 0); y <= std::min(ty + 1, m_TileCount.y - 1); ++y) {
+					for (int x = std::max(tx - 1, 0); x <= std::min(tx + 1, m_TileCount.x - 1); ++x) {
+						m_Marked[static_cast<std::size_t>(y) * m_TileCount.x + x] = 1;
+					}
+				}
+			}
+			m_Active.clear();
+			for (uint32_t tile = 0; tile < m_Marked.size(); ++tile) {
+				if (m_Marked[tile]) {
+					m_Marked[tile] = 0;
+					m_Active.push_back(tile);
+				}
+			}
+		}
+
+		std::span<const uint32_t> getActive() const {
+			return m_Active;
+		}
+
+		// runs f(tile) for every active tile in parallel.
+		template<typename F>
+		void forEachActive(F&& f) const
+		{
+			std::for_each(std::execution::par, m_Active.begin(), m_Active.end(), f);
+		}
+
+	private:
+		tc::ivec2 m_TileSize;
+		tc::ivec2 m_TileCount;
+		std::vector<uint8_t> m_Changed;
+		std::vector<uint8_t> m_Marked;
+		std::vector<uint32_t> m_Active;
+	};
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <execution>
+#include <ranges>
+#include <vector>
+
+#include "../vec.hpp"
+
+// Temporal blocking of 3x3 stencils on a 2D grid.
+//
+// Stepping a grid one generation per pass streams the whole grid through
+// memory every generation. stepMany splits the grid in tiles, copies a tile
+// with a halo of one cell per generation into a small local grid that stays in
+// cache, advances it all generations there and writes the tile back once.
+// The halo shrinks by one cell every generation, which costs some redundant
+// work at the tile borders and saves all but one pass over memory.
+namespace tc::stencil
+{
+	// A grid of size.x by size.y cells surrounded by pad boundary cells,
+	// rows are size.x + 2 * pad cells apart.
+	template<typename T>
+	struct Grid2D
+	{
+		T* data;
+		tc::ivec2 size;
+		int pad;
+
+		std::ptrdiff_t stride() const {
+			return size.x + 2 * pad;
+		}
+
+		T* at(int x, int y) const {
+			return data + (y + pad) * stride() + (x + pad);
+		}
+	};
+
+	struct Blocking
+	{
+		// elements per tile, without the halo.
+		tc::ivec2 tileSize{ 64, 64 };
+		// cells packed in one element along x and y, a bit packed row has 64
+		// cells per element along x. The halo is one element per that many
+		// generations.
+		tc::ivec2 cellsPerElement{ 1, 1 };
+	};
+
+	// Advances src generations steps into dst, the cells outside the grid keep
+	// the value boundary. src and dst do not overlap.
+	//
+	// rule(center, stride, out, count, first) writes the next value of count
+	// consecutive elements of a row to out, center points at the first of them
+	// in the current generation and stride is the distance between rows, so
+	// center[-stride - 1] is its north west neighbour. first is the grid
+	// coordinate of the first element. Working on a row lets the rule vectorize.
+	template<typename T, typename Rule>
+	void stepMany(Grid2D<const T> src, Grid2D<T> dst, unsigned generations, Rule rule,
+		Blocking blocking = {}, T boundary = T{})
+	{
+		const tc::ivec2 tileSize = blocking.tileSize;
+		const tc::ivec2 cells = blocking.cellsPerElement;
+		// elements at the edge of the local grid without a valid cell after i
+		// generations. The outer ring is never stepped, so from the first
+		// generation on its cells are not valid and i - 1 more cells are lost.
+		auto lostX = [&](int i) { return (i + cells.x - 1) / cells.x; };
+		auto lostY = [&](int i) { return (i + cells.y - 1) / cells.y; };
+		auto halo = [](int i, int c) { return i == 0 ? 0 : (i + 2 * c - 2) / c; };
+		const int g = static_cast<int>(generations);
+		const int haloX = halo(g, cells.x);
+		const int haloY = halo(g, cells.y);
+		const int tilesX = (src.size.x + tileSize.x - 1) / tileSize.x;
+		const int tilesY = (src.size.y + tileSize.y - 1) / tileSize.y;
+		auto tiles = std::views::iota(0, tilesX * tilesY);
+
+		std::for_each(std::execution::par, tiles.begin(), tiles.end(), [&](int tile) {
+			const int originX = (tile % tilesX) * tileSize.x;
+			const int originY = (tile / tilesX) * tileSize.y;
+			const int width = std::min(tileSize.x, src.size.x - originX);
+			const int height = std::min(tileSize.y, src.size.y - originY);
+
+			// local grid of the tile and its halo, local (0, 0) is grid
+			// (originX - haloX, originY - haloY).
+			const int localWidth = width + 2 * haloX;
+			const int localHeight = height + 2 * haloY;
+			const std::ptrdiff_t stride = localWidth;
+			thread_local std::vector<T> current;
+			thread_local std::vector<T> next;
+			current.assign(static_cast<std::size_t>(localWidth) * localHeight, boundary);
+			next.assign(current.size(), boundary);
+
+			// the part of the local grid that lies on the grid, in local coordinates.
+			const int firstX = std::max(0, haloX - originX);
+			const int endX = std::min(localWidth, src.size.x - originX + haloX);
+			const int firstY = std::max(0, haloY - originY);
+			const int endY = std::min(localHeight, src.size.y - originY + haloY);
+
+			for (int y = firstY; y < endY; ++y) {
+				const T* row = src.at(originX - haloX + firstX, originY - haloY + y);
+				std::copy(row, row + (endX - firstX), current.data() + y * stride + firstX);
+			}
+
+			// generation i is computed where generation i - 1 was valid, away
+			// from the edge of the local grid. Elements off the grid stay boundary.
+			for (int i = 1; i <= g; ++i) {
+				const int x0 = std::max(lostX(i), firstX);
+				const int x1 = std::min(localWidth - lostX(i), endX);
+				const int y0 = std::max(lostY(i), firstY);
+				const int y1 = std::min(localHeight - lostY(i), endY);
+				for (int y = y0; y < y1 && x0 < x1; ++y) {
+					rule(current.data() + y * stride + x0, stride, next.data() + y * stride + x0,
+						x1 - x0, tc::ivec2{ originX - haloX + x0, originY - haloY + y });
+				}
+				std::swap(current, next);
+			}
+
+			for (int y = 0; y < height; ++y) {
+				const T* row = current.data() + (y + haloY) * stride + haloX;
+				std::copy(row, row + width, dst.at(originX, originY + y));
+			}
+			});
+	}
+}
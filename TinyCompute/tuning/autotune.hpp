@@ -0,0 +1,356 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "../vec.hpp"
+
+// Autotuning of the work group size of a kernel.
+//
+// A Tuner runs every candidate a few times, in round robin so drift in clock
+// speed is spread over all of them, and picks the one with the lowest median.
+// The winner is stored per kernel, device and size class in a TuningTable,
+// which is persisted in a small text file so the next run starts tuned.
+// The GPU backend tunes local_size, the CPU backend the chunk size of its loop.
+// Nothing is looked up or measured until tuning is enabled or a tuning file is
+// set explicitly.
+namespace tc::tuning
+{
+	// Opts a kernel in to tuning its local_size on the GPU. A tuned size
+	// changes gl_WorkGroupID and gl_LocalInvocationID, only a kernel that does
+	// not depend on the size of its group should be tuned:
+	//   template<> struct tc::tuning::TuneLocalSize<MyKernel> : std::true_type {};
+	template<typename K>
+	struct TuneLocalSize : std::false_type {};
+
+	template<typename K>
+	inline constexpr bool tune_local_size_v = TuneLocalSize<K>::value;
+
+	// log2 of the number of invocations, problems of about the same size share
+	// their tuned value.
+	inline uint32_t sizeClass(const tc::uvec3& globalWorkSize)
+	{
+		uint64_t total = uint64_t(globalWorkSize.x) * globalWorkSize.y * globalWorkSize.z;
+		return total == 0 ? 0 : static_cast<uint32_t>(std::bit_width(total) - 1);
+	}
+
+	inline bool equal(const tc::uvec3& a, const tc::uvec3& b)
+	{
+		return a.x == b.x && a.y == b.y && a.z == b.z;
+	}
+
+	// Work group sizes with the same dimensionality as the problem.
+	inline std::vector<tc::uvec3> localSizeCandidates(const tc::uvec3& globalWorkSize,
+		uint32_t maxInvocations = 1024)
+	{
+		using size3 = std::array<uint32_t, 3>;
+		std::vector<size3> all;
+		if (globalWorkSize.z > 1) {
+			all = { {4,4,4}, {8,4,4}, {8,8,4}, {8,8,8}, {16,8,4} };
+		}
+		else if (globalWorkSize.y > 1) {
+			all = { {8,8,1}, {16,8,1}, {8,16,1}, {16,16,1}, {32,8,1}, {32,16,1}, {32,32,1} };
+		}
+		else {
+			all = { {32,1,1}, {64,1,1}, {128,1,1}, {256,1,1}, {512,1,1}, {1024,1,1} };
+		}
+		std::vector<tc::uvec3> candidates;
+		for (const size3& c : all) {
+			if (c[0] * c[1] * c[2] <= maxInvocations) {
+				candidates.emplace_back(c[0], c[1], c[2]);
+			}
+		}
+		return candidates;
+	}
+
+	// Number of invocations a CPU thread runs in one go, stored in x.
+	inline std::vector<tc::uvec3> chunkSizeCandidates(uint64_t totalWork)
+	{
+		std::vector<tc::uvec3> candidates;
+		for (uint32_t chunk : { 1u, 16u, 64u, 256u, 1024u, 4096u }) {
+			if (chunk == 1 || chunk <= totalWork) {
+				candidates.emplace_back(chunk, 1u, 1u);
+			}
+		}
+		return candidates;
+	}
+
+	class Tuner
+	{
+	public:
+		Tuner(std::vector<tc::uvec3> candidates, unsigned samplesPerCandidate = 5)
+			:m_Candidates{ std::move(candidates) },
+			m_Samples(m_Candidates.size()),
+			m_SamplesPerCandidate{ samplesPerCandidate }
+		{
+		}
+
+		// index of the candidate to run next, empty when every run was handed out.
+		std::optional<std::size_t> nextCandidate()
+		{
+			if (m_Issued >= m_Candidates.size() * m_SamplesPerCandidate) {
+				return std::nullopt;
+			}
+			return m_Issued++ % m_Candidates.size();
+		}
+
+		void addSample(std::size_t candidate, double nanoseconds)
+		{
+			m_Samples[candidate].push_back(nanoseconds);
+			++m_Received;
+		}
+
+		bool isDone() const
+		{
+			return m_Received >= m_Candidates.size() * m_SamplesPerCandidate;
+		}
+
+		const tc::uvec3& candidate(std::size_t index) const
+		{
+			return m_Candidates[index];
+		}
+
+		// candidate with the lowest median time, the median ignores the odd run
+		// that was interrupted by something else.
+		tc::uvec3 best() const
+		{
+			std::size_t bestIndex = 0;
+			std::optional<double> bestTime;
+			for (std::size_t i = 0; i < m_Candidates.size(); ++i) {
+				if (m_Samples[i].empty()) {
+					continue;
+				}
+				std::vector<double> sorted = m_Samples[i];
+				std::nth_element(sorted.begin(), sorted.begin() + sorted.size() / 2, sorted.end());
+				double median = sorted[sorted.size() / 2];
+				if (!bestTime || median < *bestTime) {
+					bestIndex = i;
+					bestTime = median;
+				}
+			}
+			return m_Candidates[bestIndex];
+		}
+
+	private:
+		std::vector<tc::uvec3> m_Candidates;
+		std::vector<std::vector<double>> m_Samples;
+		unsigned m_SamplesPerCandidate;
+		std::size_t m_Issued{ 0 };
+		std::size_t m_Received{ 0 };
+	};
+
+	// Tuned values keyed by kernel, device and size class.
+	// One entry per line: kernel, device and size class separated by tabs,
+	// followed by the x, y and z of the value.
+	class TuningTable
+	{
+	public:
+		static std::string makeKey(const std::string& kernel, const std::string& device, uint32_t sizeClass)
+		{
+			return kernel + "\t" + device + "\t" + std::to_string(sizeClass);
+		}
+
+		std::optional<tc::uvec3> find(const std::string& key) const
+		{
+			auto it = m_Entries.find(key);
+			if (it == m_Entries.end()) {
+				return std::nullopt;
+			}
+			return it->second;
+		}
+
+		void insert(const std::string& key, const tc::uvec3& value)
+		{
+			m_Entries.insert_or_assign(key, value);
+		}
+
+		std::size_t size() const
+		{
+			return m_Entries.size();
+		}
+
+		// merges the entries of the file, returns false when it can not be read.
+		bool load(const std::filesystem::path& file)
+		{
+			std::ifstream input{ file };
+			if (!input.is_open()) {
+				return false;
+			}
+			std::string line;
+			while (std::getline(input, line)) {
+				std::size_t valueStart = line.rfind('\t');
+				if (valueStart == std::string::npos) {
+					continue;
+				}
+				std::istringstream value{ line.substr(valueStart + 1) };
+				tc::uvec3 v;
+				if (value >> v.x >> v.y >> v.z) {
+					insert(line.substr(0, valueStart), v);
+				}
+			}
+			return true;
+		}
+
+		bool save(const std::filesystem::path& file) const
+		{
+			std::error_code ec;
+			if (file.has_parent_path()) {
+				std::filesystem::create_directories(file.parent_path(), ec);
+			}
+			std::ofstream output{ file, std::ios::trunc };
+			if (!output.is_open()) {
+				return false;
+			}
+			for (const auto& [key, v] : m_Entries) {
+				output << key << "\t" << v.x << " " << v.y << " " << v.z << "\n";
+			}
+			return true;
+		}
+
+	private:
+		std::unordered_map<std::string, tc::uvec3> m_Entries;
+	};
+
+	// A run of a candidate that is being measured.
+	struct Trial {
+		std::size_t candidate;
+		tc::uvec3 value;
+	};
+
+	// The tuning state of a backend: the persisted table and the tuners of the
+	// keys that are still being measured. Backends are used from several
+	// threads, every access to the state is locked.
+	class TuningSession
+	{
+	public:
+		// the file is used once tuning is enabled.
+		explicit TuningSession(const std::filesystem::path& file)
+			:m_File{ file }
+		{
+		}
+
+		void setEnabled(bool enabled) {
+			std::lock_guard lock{ m_Mutex };
+			m_Enabled = enabled;
+			m_Active = m_Enabled || m_FileSet;
+		}
+
+		bool isEnabled() const {
+			return m_Enabled;
+		}
+
+		// false while tuning is disabled and no file was set, the backends then
+		// skip every lookup.
+		bool isActive() const {
+			return m_Active;
+		}
+
+		// tuned values are read from and stored to the file, an empty path
+		// goes back to the file of the constructor. Values of the previous
+		// file are dropped.
+		void setFile(const std::filesystem::path& file) {
+			std::lock_guard lock{ m_Mutex };
+			if (file.empty()) {
+				m_FileSet = false;
+			}
+			else {
+				m_File = file;
+				m_FileSet = true;
+			}
+			m_Active = m_Enabled || m_FileSet;
+			m_Table = TuningTable{};
+			m_Tuners.clear();
+			m_Loaded = false;
+		}
+
+		std::filesystem::path getFile() const {
+			std::lock_guard lock{ m_Mutex };
+			return m_File;
+		}
+
+		// The key of the kernel in the table, built once per kernel, variant
+		// of the device and size class. device() returns the name of the device.
+		template<typename DeviceName>
+		const std::string& key(const char* kernel, uint32_t variant, uint32_t sizeClass, DeviceName&& device)
+		{
+			std::lock_guard lock{ m_Mutex };
+			const uint64_t id = (uint64_t(variant) << 32) | sizeClass;
+			auto [it, inserted] = m_Keys[kernel].try_emplace(id);
+			if (inserted) {
+				it->second = TuningTable::makeKey(kernel, device(), sizeClass);
+			}
+			return it->second;
+		}
+
+		// the tuned value, a finished tuning is used even when tuning is disabled.
+		std::optional<tc::uvec3> find(const std::string& key)
+		{
+			if (!m_Active) {
+				return std::nullopt;
+			}
+			std::lock_guard lock{ m_Mutex };
+			if (!m_Loaded) {
+				m_Table.load(m_File);
+				m_Loaded = true;
+			}
+			return m_Table.find(key);
+		}
+
+		// the next run of the tuner of the key, created with the candidates on
+		// first use. Empty when tuning is disabled or every run was handed out.
+		std::optional<Trial> nextTrial(const std::string& key, const std::vector<tc::uvec3>& candidates)
+		{
+			if (!m_Enabled) {
+				return std::nullopt;
+			}
+			std::lock_guard lock{ m_Mutex };
+			Tuner& tuner = m_Tuners.try_emplace(key, candidates).first->second;
+			std::optional<std::size_t> candidate = tuner.nextCandidate();
+			if (!candidate) {
+				return std::nullopt;
+			}
+			return Trial{ *candidate, tuner.candidate(*candidate) };
+		}
+
+		// stores the winner when the tuner of the key has all its samples.
+		void addSample(const std::string& key, std::size_t candidate, double nanoseconds)
+		{
+			std::lock_guard lock{ m_Mutex };
+			auto it = m_Tuners.find(key);
+			if (it == m_Tuners.end()) {
+				return;
+			}
+			it->second.addSample(candidate, nanoseconds);
+			if (it->second.isDone()) {
+				m_Table.insert(key, it->second.best());
+				m_Tuners.erase(it);
+				m_Table.save(m_File);
+			}
+		}
+
+	private:
+		mutable std::mutex m_Mutex;
+		std::filesystem::path m_File;
+		TuningTable m_Table;
+		std::unordered_map<std::string, Tuner> m_Tuners;
+		// kernel -> variant and size class -> key.
+		std::unordered_map<const char*, std::unordered_map<uint64_t, std::string>> m_Keys;
+		std::atomic<bool> m_Enabled{ false };
+		std::atomic<bool> m_Active{ false };
+		bool m_FileSet{ false };
+		bool m_Loaded{ false };
+	};
+}
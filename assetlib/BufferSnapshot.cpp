@@ -0,0 +1,122 @@
+#include "BufferSnapshot.h"
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+tc::assets::MappedFile::MappedFile(const std::filesystem::path& path)
+{
+    const std::string error = "Failed to map file: " + path.string();
+#ifdef _WIN32
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+        OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error(error);
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+        CloseHandle(file);
+        throw std::runtime_error(error);
+    }
+    m_Size = static_cast<size_t>(size.QuadPart);
+    if (m_Size > 0) {
+        // the view keeps the mapping and the file open.
+        HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping) {
+            m_Data = static_cast<const std::byte*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+            CloseHandle(mapping);
+        }
+    }
+    CloseHandle(file);
+#else
+    int file = open(path.c_str(), O_RDONLY);
+    if (file < 0) {
+        throw std::runtime_error(error);
+    }
+    struct stat status;
+    if (fstat(file, &status) != 0) {
+        close(file);
+        throw std::runtime_error(error);
+    }
+    m_Size = static_cast<size_t>(status.st_size);
+    if (m_Size > 0) {
+        void* mapped = mmap(nullptr, m_Size, PROT_READ, MAP_SHARED, file, 0);
+        if (mapped != MAP_FAILED) {
+            m_Data = static_cast<const std::byte*>(mapped);
+            // the pages are read front to back by a restore.
+            madvise(mapped, m_Size, MADV_SEQUENTIAL);
+        }
+    }
+    close(file);
+#endif
+    if (m_Size > 0 && !m_Data) {
+        throw std::runtime_error(error);
+    }
+}
+
+tc::assets::MappedFile::~MappedFile()
+{
+    if (!m_Data) {
+        return;
+    }
+#ifdef _WIN32
+    UnmapViewOfFile(m_Data);
+#else
+    munmap(const_cast<std::byte*>(m_Data), m_Size);
+#endif
+}
+
+std::ofstream tc::assets::beginSnapshot(const std::filesystem::path& path, const SnapshotHeader& header)
+{
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Failed to create snapshot: " + path.string());
+    }
+    static_assert(sizeof(SnapshotHeader) <= SnapshotAlignment, "The header has to fit before the payload.");
+    std::vector<char> page(header.payloadOffset, 0);
+    std::memcpy(page.data(), &header, sizeof(SnapshotHeader));
+    out.write(page.data(), page.size());
+    return out;
+}
+
+tc::assets::SnapshotHeader tc::assets::readSnapshotHeader(std::istream& in, const std::filesystem::path& path)
+{
+    SnapshotHeader header{};
+    in.read(reinterpret_cast<char*>(&header), sizeof(SnapshotHeader));
+    if (!in || std::memcmp(header.magic, SnapshotMagic, sizeof(SnapshotMagic)) != 0) {
+        throw std::runtime_error("Not a snapshot: " + path.string());
+    }
+    if (header.version > SnapshotVersion) {
+        throw std::runtime_error(path.string() + " is a snapshot of version " + std::to_string(header.version)
+            + ", this build reads up to version " + std::to_string(SnapshotVersion) + ".");
+    }
+    return header;
+}
+
+uint64_t tc::assets::hashSnapshotBytes(const std::byte* data, uint64_t size)
+{
+    // FNV-1a on 64 bit words, the tail is read as a zero padded word.
+    constexpr uint64_t Prime = 0x100000001b3ull;
+    uint64_t hash = 0xcbf29ce484222325ull ^ size;
+    uint64_t i = 0;
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        hash = (hash ^ word) * Prime;
+        hash ^= hash >> 29;
+    }
+    if (i < size) {
+        uint64_t word = 0;
+        std::memcpy(&word, data + i, size - i);
+        hash = (hash ^ word) * Prime;
+        hash ^= hash >> 29;
+    }
+    return hash;
+}
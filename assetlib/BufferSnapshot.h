@@ -0,0 +1,409 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+#include <string_view>
+#include <string>
+#include <memory>
+#include <vector>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <type_traits>
+#include <typeinfo>
+
+#include "vec.hpp"
+#include <kernel_intrinsics.hpp>
+
+// Snapshots of BufferResource contents in .tcbuf files.
+//
+// A file is a header of one page followed by the payload, which starts on a
+// page boundary so a mapping of the file can be read in place. A full snapshot
+// holds the stored elements of a buffer in its storage layout. A delta
+// snapshot holds the blocks that differ from a base and a hash of the base,
+// applyDeltaSnapshot writes them over a buffer that holds the same base.
+// Elements are written as they are in
+// memory, a snapshot is read back on a machine with the same byte order.
+namespace tc::assets {
+
+    enum class SnapshotKind : uint32_t {
+        Full, Delta
+    };
+
+    struct SnapshotHeader {
+        char magic[8];
+        uint32_t version;
+        SnapshotKind kind;
+        uint32_t elementSize;
+        uint32_t layout;
+        uint32_t dimensionCount;
+        int32_t dimension[3];
+        // stored elements, a tiled or Morton layout pads the edge tiles.
+        uint64_t elementCount;
+        uint64_t payloadOffset;
+        uint64_t payloadSize;
+        // a delta snapshot compares blocks of blockSize bytes.
+        uint64_t blockSize;
+        uint64_t blockCount;
+        // the C++ type of the elements, only for people reading the file.
+        char typeName[64];
+        // a delta snapshot from version 2 on: hashSnapshotBytes of the base.
+        // Zero in older files, it is after the fields of version 1.
+        uint64_t baseHash;
+    };
+
+    inline constexpr char SnapshotMagic[8] = { 'T', 'C', 'B', 'U', 'F', 0, 0, 0 };
+    inline constexpr uint32_t SnapshotVersion = 2;
+    inline constexpr uint64_t SnapshotAlignment = 4096;
+
+    // A read-only mapping of a whole file.
+    class MappedFile
+    {
+    public:
+        explicit MappedFile(const std::filesystem::path& path);
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        const std::byte* data() const {
+            return m_Data;
+        }
+
+        size_t size() const {
+            return m_Size;
+        }
+
+    private:
+        const std::byte* m_Data{ nullptr };
+        size_t m_Size{ 0 };
+    };
+
+    // writes the header and the padding up to the payload.
+    std::ofstream beginSnapshot(const std::filesystem::path& path, const SnapshotHeader& header);
+    SnapshotHeader readSnapshotHeader(std::istream& in, const std::filesystem::path& path);
+    // a 64 bit hash of the bytes, not for use against tampering.
+    uint64_t hashSnapshotBytes(const std::byte* data, uint64_t size);
+
+    namespace detail
+    {
+        template<typename T, tc::Dim D, tc::StorageLayout L>
+        SnapshotHeader makeSnapshotHeader(const tc::BufferResource<T, D, L>& resource, SnapshotKind kind)
+        {
+            SnapshotHeader header{};
+            std::memcpy(header.magic, SnapshotMagic, sizeof(header.magic));
+            header.version = SnapshotVersion;
+            header.kind = kind;
+            header.elementSize = sizeof(T);
+            header.layout = static_cast<uint32_t>(L);
+            header.dimensionCount = tc::dim_count_v<D>;
+            const auto size = resource.getDimension();
+            header.dimension[0] = header.dimension[1] = header.dimension[2] = 1;
+            if constexpr (D == tc::Dim::D1) {
+                header.dimension[0] = size;
+            }
+            else {
+                for (unsigned i = 0; i < tc::dim_count_v<D>; ++i) {
+                    header.dimension[i] = size[i];
+                }
+            }
+            header.elementCount = resource.size();
+            header.payloadOffset = SnapshotAlignment;
+            std::string_view(typeid(T).name()).copy(header.typeName, sizeof(header.typeName) - 1);
+            return header;
+        }
+
+        template<tc::Dim D>
+        auto snapshotDimension(const SnapshotHeader& header)
+        {
+            if constexpr (D == tc::Dim::D1) {
+                return header.dimension[0];
+            }
+            else if constexpr (D == tc::Dim::D2) {
+                return tc::ivec2{ header.dimension[0], header.dimension[1] };
+            }
+            else {
+                return tc::ivec3{ header.dimension[0], header.dimension[1], header.dimension[2] };
+            }
+        }
+
+        // throws when the snapshot does not hold elements of a BufferResource<T, D, L>.
+        template<typename T, tc::Dim D, tc::StorageLayout L>
+        void checkSnapshotHeader(const SnapshotHeader& header, SnapshotKind kind, const std::filesystem::path& path)
+        {
+            const std::string file = path.string();
+            if (header.kind != kind) {
+                throw std::runtime_error(file + " is not a " + (kind == SnapshotKind::Full ? "full" : "delta") + " snapshot.");
+            }
+            if (header.elementSize != sizeof(T) || header.dimensionCount != tc::dim_count_v<D>
+                || header.layout != static_cast<uint32_t>(L)) {
+                throw std::runtime_error(file + " holds a buffer of " + std::to_string(header.dimensionCount)
+                    + " dimensions, layout " + std::to_string(header.layout) + " and elements of "
+                    + std::to_string(header.elementSize) + " bytes (" + header.typeName + "), which does not match.");
+            }
+        }
+
+        // throws when the element count of a full snapshot does not match its
+        // dimension or its payload, so a bad header can not lead to reads
+        // past the payload.
+        template<typename T, tc::Dim D, tc::StorageLayout L>
+        void checkSnapshotPayload(const SnapshotHeader& header, const std::filesystem::path& path)
+        {
+            bool valid = header.payloadSize % sizeof(T) == 0 && header.payloadSize / sizeof(T) == header.elementCount;
+            for (unsigned i = 0; i < tc::dim_count_v<D>; ++i) {
+                valid = valid && header.dimension[i] > 0;
+            }
+            if (valid) {
+                const auto dimension = snapshotDimension<D>(header);
+                valid = header.elementCount == static_cast<uint64_t>(tc::LayoutTraits<D, L>::storageSize(dimension));
+            }
+            if (!valid) {
+                throw std::runtime_error(path.string() + " has a payload of " + std::to_string(header.payloadSize)
+                    + " bytes, which does not hold its " + std::to_string(header.elementCount) + " elements.");
+            }
+        }
+
+        template<typename T, tc::Dim D, tc::StorageLayout L>
+        void checkSnapshotSize(const SnapshotHeader& header, const tc::BufferResource<T, D, L>& resource,
+            const std::filesystem::path& path)
+        {
+            if (header.elementCount != resource.size()) {
+                throw std::runtime_error(path.string() + " holds " + std::to_string(header.elementCount)
+                    + " elements, the buffer " + std::to_string(resource.size()) + ".");
+            }
+        }
+
+        // throws unless the buffer has the extent of the snapshot, a 10x20
+        // buffer has as many elements as a 20x10 one.
+        template<typename T, tc::Dim D, tc::StorageLayout L>
+        void checkSnapshotDimension(const SnapshotHeader& header, const tc::BufferResource<T, D, L>& resource,
+            const std::filesystem::path& path)
+        {
+            const auto size = resource.getDimension();
+            bool same = true;
+            if constexpr (D == tc::Dim::D1) {
+                same = header.dimension[0] == size;
+            }
+            else {
+                for (unsigned i = 0; i < tc::dim_count_v<D>; ++i) {
+                    same = same && header.dimension[i] == size[i];
+                }
+            }
+            if (!same) {
+                throw std::runtime_error(path.string() + " is a snapshot of a buffer of another extent.");
+            }
+        }
+
+        // throws unless the block table of a delta snapshot fits the buffer
+        // and the payload, before anything is allocated for it. Returns the
+        // number of blocks of the buffer.
+        inline uint64_t checkDeltaBlocks(const SnapshotHeader& header, uint64_t bytes, const std::filesystem::path& path)
+        {
+            if (header.blockSize == 0) {
+                throw std::runtime_error(path.string() + " has a block size of 0.");
+            }
+            const uint64_t blocks = bytes / header.blockSize + (bytes % header.blockSize != 0);
+            if (header.blockCount > blocks || header.payloadSize / sizeof(uint64_t) < header.blockCount) {
+                throw std::runtime_error(path.string() + " has " + std::to_string(header.blockCount)
+                    + " blocks of " + std::to_string(header.blockSize) + " bytes, more than the buffer of "
+                    + std::to_string(bytes) + " bytes or its payload holds.");
+            }
+            return blocks;
+        }
+    }
+
+    template<typename T, tc::Dim D, tc::StorageLayout L>
+    void saveSnapshot(const tc::BufferResource<T, D, L>& resource, const std::filesystem::path& path)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "Only buffers of trivially copyable elements can be saved.");
+        SnapshotHeader header = detail::makeSnapshotHeader(resource, SnapshotKind::Full);
+        header.payloadSize = resource.size() * sizeof(T);
+
+        std::ofstream out = beginSnapshot(path, header);
+        out.write(reinterpret_cast<const char*>(resource.data()), header.payloadSize);
+        if (!out) {
+            throw std::runtime_error("Failed to write snapshot: " + path.string());
+        }
+    }
+
+    // reads a full snapshot into a buffer of the same size.
+    template<typename T, tc::Dim D, tc::StorageLayout L>
+    void restoreSnapshot(const std::filesystem::path& path, tc::BufferResource<T, D, L>& resource)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "Only buffers of trivially copyable elements can be loaded.");
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            throw std::runtime_error("Failed to open snapshot: " + path.string());
+        }
+        SnapshotHeader header = readSnapshotHeader(in, path);
+        detail::checkSnapshotHeader<T, D, L>(header, SnapshotKind::Full, path);
+        detail::checkSnapshotPayload<T, D, L>(header, path);
+        detail::checkSnapshotSize(header, resource, path);
+
+        in.seekg(static_cast<std::streamoff>(header.payloadOffset));
+        in.read(reinterpret_cast<char*>(resource.data()), resource.size() * sizeof(T));
+        if (!in) {
+            throw std::runtime_error("Snapshot is truncated: " + path.string());
+        }
+    }
+
+    template<typename T, tc::Dim D = tc::Dim::D1, tc::StorageLayout L = tc::StorageLayout::Linear>
+    std::unique_ptr<tc::BufferResource<T, D, L>> loadSnapshot(const std::filesystem::path& path)
+    {
+        SnapshotHeader header;
+        {
+            std::ifstream in(path, std::ios::binary);
+            if (!in) {
+                throw std::runtime_error("Failed to open snapshot: " + path.string());
+            }
+            header = readSnapshotHeader(in, path);
+        }
+        detail::checkSnapshotHeader<T, D, L>(header, SnapshotKind::Full, path);
+        detail::checkSnapshotPayload<T, D, L>(header, path);
+        auto resource = std::make_unique<tc::BufferResource<T, D, L>>(detail::snapshotDimension<D>(header));
+        restoreSnapshot(path, *resource);
+        return resource;
+    }
+
+    // A full snapshot mapped into memory, the elements are read from the page
+    // cache without a copy. Indexing uses the layout of the saved buffer.
+    template<typename T, tc::Dim D = tc::Dim::D1, tc::StorageLayout L = tc::StorageLayout::Linear>
+    class MappedSnapshot
+    {
+    public:
+        using dimType = typename tc::DimTraits<D>::IndexType;
+
+        explicit MappedSnapshot(const std::filesystem::path& path)
+            :m_File{ path }
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "Only buffers of trivially copyable elements can be mapped.");
+            if (m_File.size() < sizeof(SnapshotHeader)) {
+                throw std::runtime_error("Not a snapshot: " + path.string());
+            }
+            std::memcpy(&m_Header, m_File.data(), sizeof(SnapshotHeader));
+            if (std::memcmp(m_Header.magic, SnapshotMagic, sizeof(SnapshotMagic)) != 0) {
+                throw std::runtime_error("Not a snapshot: " + path.string());
+            }
+            detail::checkSnapshotHeader<T, D, L>(m_Header, SnapshotKind::Full, path);
+            detail::checkSnapshotPayload<T, D, L>(m_Header, path);
+            if (m_Header.payloadOffset % alignof(T) != 0 || m_Header.payloadOffset > m_File.size()
+                || m_Header.payloadSize > m_File.size() - m_Header.payloadOffset) {
+                throw std::runtime_error("Snapshot is truncated: " + path.string());
+            }
+        }
+
+        const T* data() const {
+            return reinterpret_cast<const T*>(m_File.data() + m_Header.payloadOffset);
+        }
+
+        size_t size() const {
+            return m_Header.elementCount;
+        }
+
+        dimType getDimension() const {
+            return detail::snapshotDimension<D>(m_Header);
+        }
+
+        const T& operator[](dimType index) const {
+            return data()[tc::LayoutTraits<D, L>::coordinateToIndex(index, getDimension())];
+        }
+
+        // copies the elements into a buffer of the same size.
+        void copyTo(tc::BufferResource<T, D, L>& resource) const {
+            if (resource.size() != size()) {
+                throw std::runtime_error("MappedSnapshot::copyTo: the buffer has a different size.");
+            }
+            std::memcpy(resource.data(), data(), size() * sizeof(T));
+        }
+
+    private:
+        MappedFile m_File;
+        SnapshotHeader m_Header{};
+    };
+
+    // Saves the blocks of resource that differ from base, the contents of the
+    // last full snapshot, for instance a MappedSnapshot of it. Checkpoints of a
+    // simulation that changes a small part of its state stay small.
+    template<typename T, tc::Dim D, tc::StorageLayout L, typename Base>
+    void saveDeltaSnapshot(const tc::BufferResource<T, D, L>& resource, const Base& base,
+        const std::filesystem::path& path, uint64_t blockSize = 64 * 1024)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "Only buffers of trivially copyable elements can be saved.");
+        if (base.size() != resource.size()) {
+            throw std::runtime_error("saveDeltaSnapshot: the base has a different size.");
+        }
+        if (blockSize == 0) {
+            throw std::runtime_error("saveDeltaSnapshot: the block size is 0.");
+        }
+        const auto* current = reinterpret_cast<const std::byte*>(resource.data());
+        const auto* previous = reinterpret_cast<const std::byte*>(base.data());
+        const uint64_t bytes = resource.size() * sizeof(T);
+        auto blockBytes = [&](uint64_t block) { return std::min(blockSize, bytes - block * blockSize); };
+
+        std::vector<uint64_t> changed;
+        for (uint64_t block = 0; block * blockSize < bytes; ++block) {
+            if (std::memcmp(current + block * blockSize, previous + block * blockSize, blockBytes(block)) != 0) {
+                changed.push_back(block);
+            }
+        }
+
+        SnapshotHeader header = detail::makeSnapshotHeader(resource, SnapshotKind::Delta);
+        header.blockSize = blockSize;
+        header.blockCount = changed.size();
+        header.baseHash = hashSnapshotBytes(previous, bytes);
+        // the indices of the changed blocks, then the blocks.
+        const uint64_t table = changed.size() * sizeof(uint64_t);
+        header.payloadSize = table;
+        for (uint64_t block : changed) {
+            header.payloadSize += blockBytes(block);
+        }
+
+        std::ofstream out = beginSnapshot(path, header);
+        out.write(reinterpret_cast<const char*>(changed.data()), table);
+        for (uint64_t block : changed) {
+            out.write(reinterpret_cast<const char*>(current + block * blockSize), blockBytes(block));
+        }
+        if (!out) {
+            throw std::runtime_error("Failed to write snapshot: " + path.string());
+        }
+    }
+
+    // writes the blocks of a delta snapshot over a buffer that holds its base,
+    // throws and leaves the buffer as it is when it holds something else.
+    template<typename T, tc::Dim D, tc::StorageLayout L>
+    void applyDeltaSnapshot(const std::filesystem::path& path, tc::BufferResource<T, D, L>& resource)
+    {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            throw std::runtime_error("Failed to open snapshot: " + path.string());
+        }
+        SnapshotHeader header = readSnapshotHeader(in, path);
+        detail::checkSnapshotHeader<T, D, L>(header, SnapshotKind::Delta, path);
+        detail::checkSnapshotSize(header, resource, path);
+        detail::checkSnapshotDimension(header, resource, path);
+        auto* current = reinterpret_cast<std::byte*>(resource.data());
+        const uint64_t bytes = resource.size() * sizeof(T);
+        const uint64_t blocks = detail::checkDeltaBlocks(header, bytes, path);
+        if (header.version >= 2 && hashSnapshotBytes(current, bytes) != header.baseHash) {
+            throw std::runtime_error("The buffer does not hold the base of the delta snapshot: " + path.string());
+        }
+
+        in.seekg(static_cast<std::streamoff>(header.payloadOffset));
+        std::vector<uint64_t> changed(header.blockCount);
+        in.read(reinterpret_cast<char*>(changed.data()), changed.size() * sizeof(uint64_t));
+        for (uint64_t block : changed) {
+            if (block >= blocks) {
+                throw std::runtime_error("Snapshot has a block outside the buffer: " + path.string());
+            }
+        }
+        for (uint64_t block : changed) {
+            in.read(reinterpret_cast<char*>(current + block * header.blockSize),
+                std::min(header.blockSize, bytes - block * header.blockSize));
+        }
+        if (!in) {
+            throw std::runtime_error("Snapshot is truncated: " + path.string());
+        }
+    }
+}
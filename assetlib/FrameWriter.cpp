@@ -0,0 +1,362 @@
+#include "FrameWriter.h"
+#include "ImageLoader.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <cstdio>
+#include <utility>
+
+namespace
+{
+    void appendText(std::vector<uint8_t>& out, const std::string& text)
+    {
+        out.insert(out.end(), text.begin(), text.end());
+    }
+
+    void appendBigEndian(std::vector<uint8_t>& out, uint32_t value)
+    {
+        out.push_back(static_cast<uint8_t>(value >> 24));
+        out.push_back(static_cast<uint8_t>(value >> 16));
+        out.push_back(static_cast<uint8_t>(value >> 8));
+        out.push_back(static_cast<uint8_t>(value));
+    }
+
+    void writeFile(const std::filesystem::path& path, const std::vector<uint8_t>& bytes)
+    {
+        std::ofstream file(path, std::ios::binary);
+        if (!file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size())) {
+            throw std::runtime_error("Failed to write frame: " + path.string());
+        }
+    }
+
+    uint8_t toByte(int value)
+    {
+        return static_cast<uint8_t>(std::clamp(value, 0, 255));
+    }
+}
+
+tc::assets::FrameWriter::FrameWriter(FrameWriterSettings settings)
+    :m_Settings{ std::move(settings) }
+{
+    m_Settings.queueSize = std::max<size_t>(m_Settings.queueSize, 1);
+    std::filesystem::create_directories(m_Settings.directory);
+    if (m_Settings.format == FrameFormat::Y4M) {
+        std::filesystem::path path = m_Settings.directory / (m_Settings.prefix + ".y4m");
+        m_Stream.open(path, std::ios::binary);
+        if (!m_Stream) {
+            throw std::runtime_error("Failed to open frame stream: " + path.string());
+        }
+    }
+
+    unsigned workers = m_Settings.workers;
+    if (workers == 0) {
+        workers = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (unsigned i = 0; i < workers; ++i) {
+        m_Workers.emplace_back([this]() { work(); });
+    }
+}
+
+tc::assets::FrameWriter::~FrameWriter()
+{
+    {
+        std::lock_guard lock(m_Mutex);
+        m_Stop = true;
+    }
+    m_QueueChanged.notify_all();
+    for (std::thread& worker : m_Workers) {
+        worker.join();
+    }
+}
+
+void tc::assets::FrameWriter::finish()
+{
+    std::unique_lock lock(m_Mutex);
+    m_QueueChanged.wait(lock, [this]() { return m_Queue.empty() && m_Busy == 0; });
+    if (m_Stream.is_open()) {
+        m_Stream.flush();
+    }
+    if (m_Error) {
+        std::rethrow_exception(std::exchange(m_Error, nullptr));
+    }
+}
+
+tc::assets::FrameWriter::Frame tc::assets::FrameWriter::takeFrame()
+{
+    std::lock_guard lock(m_Mutex);
+    if (m_Free.empty()) {
+        return Frame{};
+    }
+    Frame frame = std::move(m_Free.back());
+    m_Free.pop_back();
+    return frame;
+}
+
+void tc::assets::FrameWriter::push(Frame&& frame)
+{
+    {
+        std::unique_lock lock(m_Mutex);
+        m_QueueChanged.wait(lock, [this]() { return m_Queue.size() < m_Settings.queueSize; });
+        if (m_Error) {
+            std::rethrow_exception(std::exchange(m_Error, nullptr));
+        }
+        frame.index = m_NextFrame++;
+        m_Queue.push_back(std::move(frame));
+    }
+    m_QueueChanged.notify_all();
+}
+
+void tc::assets::FrameWriter::work()
+{
+    for (;;) {
+        Frame frame;
+        {
+            std::unique_lock lock(m_Mutex);
+            m_QueueChanged.wait(lock, [this]() { return m_Stop || !m_Queue.empty(); });
+            // the queue is drained before the workers stop.
+            if (m_Queue.empty()) {
+                return;
+            }
+            frame = std::move(m_Queue.front());
+            m_Queue.pop_front();
+            ++m_Busy;
+        }
+        m_QueueChanged.notify_all();
+
+        std::exception_ptr error;
+        try {
+            write(frame);
+        }
+        catch (...) {
+            error = std::current_exception();
+        }
+
+        {
+            std::lock_guard lock(m_Mutex);
+            if (error && !m_Error) {
+                m_Error = error;
+            }
+            --m_Busy;
+            m_Free.push_back(std::move(frame));
+        }
+        m_QueueChanged.notify_all();
+    }
+}
+
+void tc::assets::FrameWriter::write(Frame& frame)
+{
+    static_assert(sizeof(Pixel) == 4, "Frames are stored as 8 bit RGBA.");
+    const uint8_t* rgba = reinterpret_cast<const uint8_t*>(frame.pixels.data());
+    switch (m_Settings.format)
+    {
+    case FrameFormat::PNG:
+        writeImage(framePath(frame.index).string(), const_cast<uint8_t*>(rgba),
+            frame.size.x, frame.size.y, 4, frame.size.x * 4);
+        break;
+    case FrameFormat::PPM:
+        encodePPM(rgba, frame.size, frame.bytes);
+        writeFile(framePath(frame.index), frame.bytes);
+        break;
+    case FrameFormat::PAM:
+        encodePAM(rgba, frame.size, frame.bytes);
+        writeFile(framePath(frame.index), frame.bytes);
+        break;
+    case FrameFormat::QOI:
+        encodeQOI(rgba, frame.size, frame.bytes);
+        writeFile(framePath(frame.index), frame.bytes);
+        break;
+    case FrameFormat::Y4M:
+        writeStream(frame);
+        break;
+    }
+}
+
+// Frames are converted in parallel and written one after the other in the
+// order they were submitted. A frame always takes its turn, also when it
+// failed, so the frames after it are not blocked.
+void tc::assets::FrameWriter::writeStream(Frame& frame)
+{
+    std::exception_ptr error;
+    try {
+        encodeY4MFrame(reinterpret_cast<const uint8_t*>(frame.pixels.data()), frame.size, frame.bytes);
+    }
+    catch (...) {
+        error = std::current_exception();
+    }
+
+    {
+        std::unique_lock lock(m_StreamMutex);
+        m_StreamTurn.wait(lock, [&]() { return m_NextStreamFrame == frame.index; });
+        if (!error) {
+            if (frame.index == 0) {
+                m_StreamSize = frame.size;
+                std::vector<uint8_t> header;
+                appendText(header, "YUV4MPEG2 W" + std::to_string(frame.size.x) + " H" + std::to_string(frame.size.y)
+                    + " F" + std::to_string(m_Settings.framesPerSecond) + ":1 Ip A1:1 C420jpeg XCOLORRANGE=FULL\n");
+                m_Stream.write(reinterpret_cast<const char*>(header.data()), header.size());
+            }
+            if (frame.size.x != m_StreamSize.x || frame.size.y != m_StreamSize.y) {
+                error = std::make_exception_ptr(std::runtime_error(
+                    "Frame " + std::to_string(frame.index) + " does not have the size of the Y4M stream."));
+            }
+            else if (!m_Stream.write(reinterpret_cast<const char*>(frame.bytes.data()), frame.bytes.size())) {
+                error = std::make_exception_ptr(std::runtime_error("Failed to write to the Y4M stream."));
+            }
+        }
+        ++m_NextStreamFrame;
+    }
+    m_StreamTurn.notify_all();
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+std::filesystem::path tc::assets::FrameWriter::framePath(uint64_t index) const
+{
+    const char* extension = "";
+    switch (m_Settings.format)
+    {
+    case FrameFormat::PNG: extension = ".png"; break;
+    case FrameFormat::PPM: extension = ".ppm"; break;
+    case FrameFormat::PAM: extension = ".pam"; break;
+    case FrameFormat::QOI: extension = ".qoi"; break;
+    case FrameFormat::Y4M: extension = ".y4m"; break;
+    }
+    char number[32];
+    std::snprintf(number, sizeof(number), "_%06llu", static_cast<unsigned long long>(index));
+    return m_Settings.directory / (m_Settings.prefix + number + extension);
+}
+
+void tc::assets::encodePPM(const uint8_t* rgba, tc::ivec2 size, std::vector<uint8_t>& out)
+{
+    out.clear();
+    appendText(out, "P6\n" + std::to_string(size.x) + " " + std::to_string(size.y) + "\n255\n");
+    const size_t count = size_t(size.x) * size.y;
+    out.reserve(out.size() + count * 3);
+    for (size_t i = 0; i < count; ++i) {
+        out.insert(out.end(), rgba + 4 * i, rgba + 4 * i + 3);
+    }
+}
+
+void tc::assets::encodePAM(const uint8_t* rgba, tc::ivec2 size, std::vector<uint8_t>& out)
+{
+    out.clear();
+    appendText(out, "P7\nWIDTH " + std::to_string(size.x) + "\nHEIGHT " + std::to_string(size.y)
+        + "\nDEPTH 4\nMAXVAL 255\nTUPLTYPE RGB_ALPHA\nENDHDR\n");
+    out.insert(out.end(), rgba, rgba + size_t(size.x) * size.y * 4);
+}
+
+// The Quite OK Image format, see https://qoiformat.org/qoi-specification.pdf.
+void tc::assets::encodeQOI(const uint8_t* rgba, tc::ivec2 size, std::vector<uint8_t>& out)
+{
+    constexpr uint8_t OpIndex = 0x00;
+    constexpr uint8_t OpDiff = 0x40;
+    constexpr uint8_t OpLuma = 0x80;
+    constexpr uint8_t OpRun = 0xc0;
+    constexpr uint8_t OpRGB = 0xfe;
+    constexpr uint8_t OpRGBA = 0xff;
+
+    out.clear();
+    appendText(out, "qoif");
+    appendBigEndian(out, static_cast<uint32_t>(size.x));
+    appendBigEndian(out, static_cast<uint32_t>(size.y));
+    out.push_back(4);
+    out.push_back(0);
+
+    struct Color { uint8_t r, g, b, a; };
+    auto equal = [](Color c0, Color c1) { return c0.r == c1.r && c0.g == c1.g && c0.b == c1.b && c0.a == c1.a; };
+    Color index[64]{};
+    Color previous{ 0, 0, 0, 255 };
+    int run = 0;
+
+    const size_t count = size_t(size.x) * size.y;
+    for (size_t i = 0; i < count; ++i) {
+        const Color px{ rgba[4 * i], rgba[4 * i + 1], rgba[4 * i + 2], rgba[4 * i + 3] };
+        if (equal(px, previous)) {
+            ++run;
+            if (run == 62 || i + 1 == count) {
+                out.push_back(static_cast<uint8_t>(OpRun | (run - 1)));
+                run = 0;
+            }
+            continue;
+        }
+        if (run > 0) {
+            out.push_back(static_cast<uint8_t>(OpRun | (run - 1)));
+            run = 0;
+        }
+
+        const int hash = (px.r * 3 + px.g * 5 + px.b * 7 + px.a * 11) % 64;
+        if (equal(index[hash], px)) {
+            out.push_back(static_cast<uint8_t>(OpIndex | hash));
+        }
+        else {
+            index[hash] = px;
+            if (px.a == previous.a) {
+                const int8_t dr = static_cast<int8_t>(px.r - previous.r);
+                const int8_t dg = static_cast<int8_t>(px.g - previous.g);
+                const int8_t db = static_cast<int8_t>(px.b - previous.b);
+                const int drg = dr - dg;
+                const int dbg = db - dg;
+                if (dr > -3 && dr < 2 && dg > -3 && dg < 2 && db > -3 && db < 2) {
+                    out.push_back(static_cast<uint8_t>(OpDiff | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2)));
+                }
+                else if (drg > -9 && drg < 8 && dg > -33 && dg < 32 && dbg > -9 && dbg < 8) {
+                    out.push_back(static_cast<uint8_t>(OpLuma | (dg + 32)));
+                    out.push_back(static_cast<uint8_t>((drg + 8) << 4 | (dbg + 8)));
+                }
+                else {
+                    out.insert(out.end(), { OpRGB, px.r, px.g, px.b });
+                }
+            }
+            else {
+                out.insert(out.end(), { OpRGBA, px.r, px.g, px.b, px.a });
+            }
+        }
+        previous = px;
+    }
+    out.insert(out.end(), { 0, 0, 0, 0, 0, 0, 0, 1 });
+}
+
+void tc::assets::encodeY4MFrame(const uint8_t* rgba, tc::ivec2 size, std::vector<uint8_t>& out)
+{
+    const int w = size.x;
+    const int h = size.y;
+    const int cw = (w + 1) / 2;
+    const int ch = (h + 1) / 2;
+    out.clear();
+    appendText(out, "FRAME\n");
+    const size_t header = out.size();
+    out.resize(header + size_t(w) * h + 2 * size_t(cw) * ch);
+    uint8_t* y = out.data() + header;
+    uint8_t* u = y + size_t(w) * h;
+    uint8_t* v = u + size_t(cw) * ch;
+
+    // BT.601 full range in 8 bit fixed point.
+    for (int row = 0; row < h; ++row) {
+        const uint8_t* px = rgba + size_t(row) * w * 4;
+        for (int x = 0; x < w; ++x, px += 4) {
+            y[size_t(row) * w + x] = toByte((77 * px[0] + 150 * px[1] + 29 * px[2] + 128) >> 8);
+        }
+    }
+    // chroma of the average of every 2x2 block, the edge blocks of an odd size are smaller.
+    for (int cy = 0; cy < ch; ++cy) {
+        for (int cx = 0; cx < cw; ++cx) {
+            int r = 0, g = 0, b = 0, n = 0;
+            for (int dy = 0; dy < 2 && 2 * cy + dy < h; ++dy) {
+                for (int dx = 0; dx < 2 && 2 * cx + dx < w; ++dx) {
+                    const uint8_t* px = rgba + (size_t(2 * cy + dy) * w + 2 * cx + dx) * 4;
+                    r += px[0];
+                    g += px[1];
+                    b += px[2];
+                    ++n;
+                }
+            }
+            r /= n;
+            g /= n;
+            b /= n;
+            u[size_t(cy) * cw + cx] = toByte(((-43 * r - 85 * g + 128 * b + 128) >> 8) + 128);
+            v[size_t(cy) * cw + cx] = toByte(((128 * r - 107 * g - 21 * b + 128) >> 8) + 128);
+        }
+    }
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <cstdint>
+
+#include "vec.hpp"
+#include "images/ImageFormat.hpp"
+#include "images/PixelConversion.hpp"
+#include <kernel_intrinsics.hpp>
+#include <computebackend.hpp>
+
+namespace tc::assets {
+
+    // PNG is small and slow to encode. PPM and PAM are the raw pixels behind
+    // a text header, PPM without alpha. QOI compresses losslessly at a fraction
+    // of the cost of PNG. Y4M is one uncompressed YUV 4:2:0 stream that video
+    // encoders such as ffmpeg read directly.
+    enum class FrameFormat {
+        PNG, PPM, PAM, QOI, Y4M
+    };
+
+    struct FrameWriterSettings {
+        // frames are written as <prefix>_<frame>.<ext>, a Y4M stream as <prefix>.y4m.
+        std::filesystem::path directory{ "." };
+        std::string prefix{ "frame" };
+        FrameFormat format{ FrameFormat::QOI };
+        // frames waiting to be encoded, submit blocks while the queue is full.
+        size_t queueSize{ 8 };
+        // encoding threads, 0 uses one per core.
+        unsigned workers{ 0 };
+        // frame rate in the header of a Y4M stream.
+        unsigned framesPerSecond{ 30 };
+    };
+
+    // Records frames on worker threads. submit copies the pixels of a frame
+    // to 8 bit RGBA and returns, the frame is encoded and written while the
+    // caller goes on with the next one. submit(backend, frame) downloads a
+    // frame that a kernel rendered on the GPU first, submit(frame) only reads
+    // the CPU pixels of the buffer.
+    class FrameWriter
+    {
+    public:
+        explicit FrameWriter(FrameWriterSettings settings);
+        // writes the frames that are still queued.
+        ~FrameWriter();
+
+        FrameWriter(const FrameWriter&) = delete;
+        FrameWriter& operator=(const FrameWriter&) = delete;
+
+        template<tc::cpu::PixelConcept P, tc::StorageLayout L>
+        void submit(const tc::BufferResource<P, tc::Dim::D2, L>& frame)
+        {
+            static_assert(P::NumChannels >= 1 && P::NumChannels <= 4,
+                "Pixel NumChannels must be 1..4");
+            Frame f = takeFrame();
+            f.size = frame.getDimension();
+            f.pixels.resize(size_t(f.size.x) * f.size.y);
+            if constexpr (L == tc::StorageLayout::Linear) {
+                tc::convert::convertPixels(frame.data(), f.pixels.data(), f.pixels.size());
+            }
+            else {
+                std::vector<P> linear(f.pixels.size());
+                frame.copyToLinear(linear.data());
+                tc::convert::convertPixels(linear.data(), f.pixels.data(), f.pixels.size());
+            }
+            push(std::move(f));
+        }
+
+        // the download is a no op on the CPU backend.
+        template<typename B, tc::cpu::PixelConcept P, tc::StorageLayout L>
+        void submit(tc::ComputeBackend<B>& backend, tc::BufferResource<P, tc::Dim::D2, L>& frame)
+        {
+            backend.downloadImage(frame);
+            submit(frame);
+        }
+
+        // waits until every submitted frame is written, throws the first
+        // error of a worker.
+        void finish();
+
+        uint64_t getFrameCount() const {
+            return m_NextFrame;
+        }
+
+    private:
+        using Pixel = tc::cpu::UNorm8Pixel<4>;
+
+        struct Frame {
+            uint64_t index{ 0 };
+            tc::ivec2 size{ 0, 0 };
+            std::vector<Pixel> pixels;
+            // encoded file or Y4M frame.
+            std::vector<uint8_t> bytes;
+        };
+
+        // a recycled frame, so a long recording does not allocate per frame.
+        Frame takeFrame();
+        void push(Frame&& frame);
+        void work();
+        void write(Frame& frame);
+        void writeStream(Frame& frame);
+        std::filesystem::path framePath(uint64_t index) const;
+
+        FrameWriterSettings m_Settings;
+        uint64_t m_NextFrame{ 0 };
+
+        std::mutex m_Mutex;
+        std::condition_variable m_QueueChanged;
+        std::deque<Frame> m_Queue;
+        std::vector<Frame> m_Free;
+        size_t m_Busy{ 0 };
+        bool m_Stop{ false };
+        std::exception_ptr m_Error;
+
+        // the Y4M stream takes the frames in order.
+        std::mutex m_StreamMutex;
+        std::condition_variable m_StreamTurn;
+        uint64_t m_NextStreamFrame{ 0 };
+        std::ofstream m_Stream;
+        tc::ivec2 m_StreamSize{ 0, 0 };
+
+        std::vector<std::thread> m_Workers;
+    };
+
+    // The encoders of the formats, from 8 bit RGBA in row-major order to the
+    // bytes of a file. out is overwritten, its memory is reused.
+    void encodePPM(const uint8_t* rgba, tc::ivec2 size, std::vector<uint8_t>& out);
+    void encodePAM(const uint8_t* rgba, tc::ivec2 size, std::vector<uint8_t>& out);
+    void encodeQOI(const uint8_t* rgba, tc::ivec2 size, std::vector<uint8_t>& out);
+    // a FRAME of a Y4M stream in C420jpeg, full range BT.601. The stream
+    // header says XCOLORRANGE=FULL, else players take it as limited range.
+    void encodeY4MFrame(const uint8_t* rgba, tc::ivec2 size, std::vector<uint8_t>& out);
+}
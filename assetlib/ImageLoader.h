@@ -1,44 +1,115 @@
-
+#pragma once
 #include <string>
+#include <memory>
+#include <vector>
+#include <array>
+#include <span>
+#include <ranges>
+#include <algorithm>
+#include <execution>
+#include <exception>
 
 #include "vec.hpp"
 #include "images/ImageFormat.hpp"
+#include "images/PixelConversion.hpp"
 #include <kernel_intrinsics.hpp>
 
 namespace tc::assets {
     unsigned char* loadImage(const std::string& fileName,unsigned numChannels, tc::ivec2& dimension);
     void writeImage(const std::string& fileName, unsigned char* pImgData, unsigned w, unsigned h, unsigned channels, unsigned stride);
-    
+
     void freeImage(unsigned char* imgData);
 
+    struct ImageDataDeleter {
+        void operator()(unsigned char* imgData) const {
+            freeImage(imgData);
+        }
+    };
+
+    // pixels decoded by loadImage, freed with freeImage.
+    using ImageData = std::unique_ptr<unsigned char, ImageDataDeleter>;
+
+    template<tc::cpu::PixelConcept P>
+    using ImageResource = std::unique_ptr<tc::BufferResource<P, tc::Dim::D2>>;
+
+    // Decodes the file and fills the storage of the buffer from the decoded
+    // pixels without zero filling it first. stb can not decode into memory of
+    // the caller, so that is one copy (8 bit pixels) or one conversion pass on
+    // top of the decode; the decoded pixels live until then.
     template<tc::cpu::PixelConcept P>
-    tc::BufferResource<P, tc::Dim::D2>* loadImage(const std::string& filename)
+    ImageResource<P> loadImage(const std::string& filename)
     {
         static_assert(P::NumChannels >= 1 && P::NumChannels <= 4,
             "Pixel NumChannels must be 1..4");
 
         ivec2 dimension;
-        unsigned char* pixelData = loadImage(filename, P::NumChannels, dimension);
+        ImageData pixelData{ loadImage(filename, P::NumChannels, dimension) };
+
+        // the file has 8 bit channels, converted to the channels of P.
+        using FilePixel = tc::cpu::UNorm8Pixel<P::NumChannels>;
+        const size_t count = size_t(dimension.x) * dimension.y;
+        std::vector<P> storage;
+        storage.reserve(count);
+        if constexpr (sizeof(P) == sizeof(FilePixel) && tc::convert::is_plain_pixel_v<P>) {
+            const P* pixels = reinterpret_cast<const P*>(pixelData.get());
+            storage.assign(pixels, pixels + count);
+        }
+        else {
+            // converted through a chunk that stays in cache, appended without value-init
+            constexpr size_t ChunkSize = 1024;
+            std::array<P, ChunkSize> chunk;
+            const FilePixel* pixels = reinterpret_cast<const FilePixel*>(pixelData.get());
+            for (size_t first = 0; first < count; first += ChunkSize) {
+                const size_t n = std::min(ChunkSize, count - first);
+                tc::convert::convertPixels(pixels + first, chunk.data(), n);
+                storage.insert(storage.end(), chunk.begin(), chunk.begin() + n);
+            }
+        }
+        return std::make_unique<tc::BufferResource<P, tc::Dim::D2>>(dimension, std::move(storage));
+    }
 
-        using ResourceType = BufferResource<P, tc::Dim::D2>;
-        tc::uint w = static_cast<tc::uint>(dimension.x);
-        tc::uint h = static_cast<tc::uint>(dimension.y);
-        auto* buffer = new ResourceType(ivec2{w,h});
+    // Decodes the files in parallel, an image per file in the same order. A
+    // file that fails to load throws after all others are done.
+    template<tc::cpu::PixelConcept P>
+    std::vector<ImageResource<P>> loadImages(std::span<const std::string> filenames)
+    {
+        std::vector<ImageResource<P>> images(filenames.size());
+        std::vector<std::exception_ptr> errors(filenames.size());
+        auto files = std::views::iota(size_t{ 0 }, filenames.size());
+        std::for_each(std::execution::par, files.begin(), files.end(), [&](size_t i) {
+            try {
+                images[i] = loadImage<P>(filenames[i]);
+            }
+            catch (...) {
+                errors[i] = std::current_exception();
+            }
+            });
 
-        std::memcpy(buffer->data(), pixelData, w * h * sizeof(P));
-        
-        return buffer;
+        for (const std::exception_ptr& error : errors) {
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        }
+        return images;
     }
 
     template<tc::cpu::PixelConcept P>
-    void writeImage(const std::string& filename, 
+    void writeImage(const std::string& filename,
         tc::BufferResource<P, tc::Dim::D2>* pImage)
     {
         static_assert(P::NumChannels >= 1 && P::NumChannels <= 4,
             "Pixel NumChannels must be 1..4");
 
         tc::uvec2 dim = pImage->getDimension();
-        unsigned stride = dim.x * sizeof(P);
-        writeImage(filename, (unsigned char*)pImage->data(), dim.x, dim.y, P::NumChannels, stride);
+        using FilePixel = tc::cpu::UNorm8Pixel<P::NumChannels>;
+        unsigned stride = dim.x * sizeof(FilePixel);
+        if constexpr (sizeof(P) == sizeof(FilePixel) && tc::convert::is_plain_pixel_v<P>) {
+            writeImage(filename, (unsigned char*)pImage->data(), dim.x, dim.y, P::NumChannels, stride);
+        }
+        else {
+            std::vector<FilePixel> pixels(size_t(dim.x) * dim.y);
+            tc::convert::convertPixels(pImage->data(), pixels.data(), pixels.size());
+            writeImage(filename, (unsigned char*)pixels.data(), dim.x, dim.y, P::NumChannels, stride);
+        }
     }
-}
\ No newline at end of file
+}
@@ -14,3 +14,14 @@ concept HasCompute =
         { obj.init(renderer) } -> std::same_as<void>;
         { obj.compute(renderer) } -> std::same_as<void>;
     }; 
+
+// A compute object that only uses the CPU backend declares
+// static constexpr bool ComputesOnCPU = true; so ComputeWindow may call its
+// compute on a worker thread, which has no OpenGL context.
+template<typename T>
+concept CPUCompute =
+    HasCompute<T>
+    &&
+    requires {
+        requires T::ComputesOnCPU;
+    };
@@ -1,4 +1,6 @@
 #include "ComputeShader.hpp"
+#include "ProgramBinaryCache.hpp"
+#include "layout/std140.hpp"
 #include <fstream>
 #include <iostream>
 #include <sstream>
@@ -41,14 +43,19 @@ void ComputeShader::clear()
 ComputeShader::ComputeShader(ComputeShader&& other) noexcept
 	: m_FileLocation(std::move(other.m_FileLocation)),
 	m_SourceValid(other.m_SourceValid),
+	m_CompilePending(other.m_CompilePending),
+	m_pCache(other.m_pCache),
 	m_ShaderContents(std::move(other.m_ShaderContents)),
 	m_SourceLength(other.m_SourceLength),
 	m_ShaderID(other.m_ShaderID),
-	m_ComputeProgramID(other.m_ComputeProgramID)
+	m_ComputeProgramID(other.m_ComputeProgramID),
+	m_LocalSize(other.m_LocalSize),
+	m_UniformData(std::move(other.m_UniformData))
 {
 	other.m_ShaderID = 0;
 	other.m_ComputeProgramID = 0;
 	other.m_SourceValid = false;
+	other.m_CompilePending = false;
 }
 
 ComputeShader& ComputeShader::operator=(ComputeShader&& other) noexcept
@@ -60,62 +67,141 @@ ComputeShader& ComputeShader::operator=(ComputeShader&& other) noexcept
 		m_SourceValid = other.m_SourceValid;
 		m_ShaderContents = std::move(other.m_ShaderContents);
 		m_SourceLength = other.m_SourceLength;
+		m_CompilePending = other.m_CompilePending;
+		m_pCache = other.m_pCache;
 		m_ShaderID = other.m_ShaderID;
 		m_ComputeProgramID = other.m_ComputeProgramID;
+		m_LocalSize = other.m_LocalSize;
+		m_UniformData = std::move(other.m_UniformData);
 
 		// Reset the other object
 		other.m_ShaderID = 0;
 		other.m_ComputeProgramID = 0;
 		other.m_SourceValid = false;
+		other.m_CompilePending = false;
 	}
 	return *this;
 }
 
-void ComputeShader::compile()
+void ComputeShader::addDefines(const std::string& defines)
+{
+	if (defines.empty()) {
+		return;
+	}
+	// #version has to stay the first line of the shader.
+	std::size_t insertAt = 0;
+	if (m_ShaderContents.starts_with("#version")) {
+		std::size_t lineEnd = m_ShaderContents.find('\n');
+		insertAt = lineEnd == std::string::npos ? m_ShaderContents.size() : lineEnd + 1;
+	}
+	m_ShaderContents.insert(insertAt, defines);
+	m_SourceLength = static_cast<GLint>(m_ShaderContents.length());
+}
+
+void ComputeShader::compile(const ProgramBinaryCache* pCache)
+{
+	beginCompile(pCache);
+	finishCompile();
+}
+
+void ComputeShader::beginCompile(const ProgramBinaryCache* pCache)
 {
 	if (m_SourceValid)
 	{
 		clear();
+		m_pCache = pCache;
+		if (pCache != nullptr) {
+			m_ComputeProgramID = pCache->load(m_ShaderContents);
+			if (m_ComputeProgramID != 0) {
+				queryProgramInfo();
+				m_CompilePending = false;
+				return;
+			}
+		}
+
 		m_ShaderID = glCreateShader(GL_COMPUTE_SHADER);
 		const char* computeShaderSource = m_ShaderContents.c_str();
 
 		glShaderSource(m_ShaderID, 1, &computeShaderSource, &m_SourceLength);
 		glCompileShader(m_ShaderID);
 
-		// Check for compilation errors
-		GLint success;
-		glGetShaderiv(m_ShaderID, GL_COMPILE_STATUS, &success);
-		if (!success) {
-			// Retrieve and log the error message
-			std::array<char, 1024> infoLog;
-			glGetShaderInfoLog(m_ShaderID, static_cast<GLsizei>(infoLog.size()), nullptr, infoLog.data());
-			std::string errorMessage(infoLog.begin(), infoLog.end());
-			throw std::runtime_error("ERROR::SHADER::COMPUTE::COMPILATION_FAILED: " + m_FileLocation + "\n"
-				+ errorMessage);
-		}
-
-		// Link the shader into a program
+		// Link the shader into a program, the status is only queried in
+		// finishCompile because querying it waits for the driver.
 		m_ComputeProgramID = glCreateProgram();
 		glAttachShader(m_ComputeProgramID, m_ShaderID);
+		if (pCache != nullptr) {
+			glProgramParameteri(m_ComputeProgramID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+		}
 		glLinkProgram(m_ComputeProgramID);
+		m_CompilePending = true;
+	}
+}
 
-		// Check for linking errors
-		glGetProgramiv(m_ComputeProgramID, GL_LINK_STATUS, &success);
-		if (!success) {
-			std::array<char, 1024> infoLog;
-			glGetProgramInfoLog(m_ComputeProgramID, static_cast<GLsizei>(infoLog.size()), nullptr, infoLog.data());
-			std::string errorMessage(infoLog.begin(), infoLog.end());
-			throw std::runtime_error("ERROR::PROGRAM::COMPUTE::LINKING_FAILED\n" + errorMessage);
+bool ComputeShader::isCompileDone() const
+{
+	if (!m_CompilePending) {
+		return true;
+	}
+	if (!GLEW_KHR_parallel_shader_compile && !GLEW_ARB_parallel_shader_compile) {
+		// without the extension any status query blocks, so report done.
+		return true;
+	}
+	GLint done = GL_FALSE;
+	glGetProgramiv(m_ComputeProgramID, GL_COMPLETION_STATUS_KHR, &done);
+	return done == GL_TRUE;
+}
 
-		}
-		glGetProgramiv(m_ComputeProgramID, GL_COMPUTE_WORK_GROUP_SIZE, m_LocalSize.data());
-		// Shader has been linked with the compute program, so it's no longer necessary.
-		glDetachShader(m_ComputeProgramID, m_ShaderID);
-		glDeleteShader(m_ShaderID);
-		m_ShaderID = 0;
+void ComputeShader::finishCompile()
+{
+	if (!m_CompilePending) {
+		return;
+	}
+	m_CompilePending = false;
+
+	// Check for compilation errors
+	GLint success;
+	glGetShaderiv(m_ShaderID, GL_COMPILE_STATUS, &success);
+	if (!success) {
+		// Retrieve and log the error message
+		std::array<char, 1024> infoLog;
+		glGetShaderInfoLog(m_ShaderID, static_cast<GLsizei>(infoLog.size()), nullptr, infoLog.data());
+		std::string errorMessage(infoLog.begin(), infoLog.end());
+		throw std::runtime_error("ERROR::SHADER::COMPUTE::COMPILATION_FAILED: " + m_FileLocation + "\n"
+			+ errorMessage);
+	}
+
+	// Check for linking errors
+	glGetProgramiv(m_ComputeProgramID, GL_LINK_STATUS, &success);
+	if (!success) {
+		std::array<char, 1024> infoLog;
+		glGetProgramInfoLog(m_ComputeProgramID, static_cast<GLsizei>(infoLog.size()), nullptr, infoLog.data());
+		std::string errorMessage(infoLog.begin(), infoLog.end());
+		throw std::runtime_error("ERROR::PROGRAM::COMPUTE::LINKING_FAILED\n" + errorMessage);
+
+	}
+	queryProgramInfo();
+	// Shader has been linked with the compute program, so it's no longer necessary.
+	glDetachShader(m_ComputeProgramID, m_ShaderID);
+	glDeleteShader(m_ShaderID);
+	m_ShaderID = 0;
+
+	if (m_pCache != nullptr) {
+		m_pCache->store(m_ShaderContents, m_ComputeProgramID);
 	}
 }
 
+void ComputeShader::queryProgramInfo()
+{
+	glGetProgramiv(m_ComputeProgramID, GL_COMPUTE_WORK_GROUP_SIZE, m_LocalSize.data());
+
+	GLint blockSize = 0;
+	GLuint blockIndex = glGetUniformBlockIndex(m_ComputeProgramID, tc::std140::UniformBlockName);
+	if (blockIndex != GL_INVALID_INDEX) {
+		glGetActiveUniformBlockiv(m_ComputeProgramID, blockIndex, GL_UNIFORM_BLOCK_DATA_SIZE, &blockSize);
+	}
+	m_UniformData.assign(blockSize, std::byte{ 0 });
+}
+
 void ComputeShader::use() const
 {
 	glUseProgram(m_ComputeProgramID);
@@ -125,3 +211,17 @@ void ComputeShader::use() const
 		throw std::runtime_error("OpenGL Error in ComputeShader::use(): " + std::to_string(error));
 	}
 }
+
+bool ComputeShader::enableParallelCompile()
+{
+	// 0xFFFFFFFF lets the driver pick the number of compiler threads.
+	if (GLEW_KHR_parallel_shader_compile) {
+		glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+		return true;
+	}
+	if (GLEW_ARB_parallel_shader_compile) {
+		glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+		return true;
+	}
+	return false;
+}
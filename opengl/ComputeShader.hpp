@@ -1,8 +1,11 @@
 #pragma once
 #include <string>
 #include <array>
+#include <vector>
+#include <cstddef>
 #include "GL/glew.h"
 
+class ProgramBinaryCache;
 
 
 class ComputeShader
@@ -19,12 +22,44 @@ public:
 	ComputeShader(ComputeShader&& other) noexcept;
 	ComputeShader& operator=(ComputeShader&& other) noexcept;
 	
-	void compile();
+	// inserts preprocessor lines after the #version line, call before compiling.
+	void addDefines(const std::string& defines);
+	// compiles and links the shader, when a cache is given a stored program
+	// binary is used instead and a fresh compile is stored for the next run.
+	void compile(const ProgramBinaryCache* pCache = nullptr);
+	// submits the compile and link without waiting for the result, the driver
+	// can compile on its own threads when parallel shader compile is enabled.
+	void beginCompile(const ProgramBinaryCache* pCache = nullptr);
+	// true when finishCompile will not block.
+	bool isCompileDone() const;
+	// waits for a pending compile and checks the compile and link status.
+	void finishCompile();
+	bool isCompilePending() const {
+		return m_CompilePending;
+	}
 	void use() const;
+
+	// work group size of the linked program.
+	const std::array<GLint, 3>& getLocalSize() const {
+		return m_LocalSize;
+	}
+
+	// std140 copy of the uniform block of the kernel, empty when the kernel
+	// has no uniforms. Sized to the block after the program is linked.
+	std::vector<std::byte>& getUniformData() {
+		return m_UniformData;
+	}
+
+	// Enables GL_KHR_parallel_shader_compile (or the ARB variant), returns
+	// false when the driver supports neither.
+	static bool enableParallelCompile();
 private:
 	void clear();
+	void queryProgramInfo();
 	std::string m_FileLocation;
 	bool m_SourceValid{ false };
+	bool m_CompilePending{ false };
+	const ProgramBinaryCache* m_pCache{ nullptr };
 	std::string m_ShaderContents;
 	GLint m_SourceLength{ 0 };
 	// opengl specific --> resource that should be released
@@ -32,4 +67,5 @@ private:
 	GLuint m_ComputeProgramID = 0;
 	// reasonable default for workgroup sizes.
 	std::array<GLint, 3>  m_LocalSize = { 16,16,1 };
+	std::vector<std::byte> m_UniformData;
 };
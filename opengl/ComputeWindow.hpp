@@ -12,6 +12,16 @@
 #include <stdexcept>
 #include <iostream>
 #include <sstream>
+#include <iomanip>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <stop_token>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <exception>
 
 
 struct GLFWDeleter {
@@ -23,6 +33,14 @@ struct GLFWDeleter {
 	}
 };
 
+// Measured over the last second of the render loop.
+struct PipelineStatistics {
+	double computedPerSecond{ 0 };
+	double presentedPerSecond{ 0 };
+	// seconds from the start of computing a frame until it is on screen.
+	double latency{ 0 };
+};
+
 template<HasCompute C>
 class ComputeWindow
 {
@@ -32,17 +50,38 @@ public:
 	void init();
 	void renderLoop();
 
+	// The number of surface buffers. With more than one, the compute object
+	// computes the next frame on a worker thread while the window presents
+	// the last one, a computed frame waits in one of depth - 1 buffers. Only
+	// for compute objects that run on the CPU backend (see CPUCompute), the
+	// OpenGL context is current on the thread of the window, a depth above
+	// one throws for the others.
+	void setPipelineDepth(unsigned depth);
+
+	const PipelineStatistics& getPipelineStatistics() const {
+		return m_Statistics;
+	}
+
 	bool isMovingForward();
 	bool isMovingBack();
 	bool isMovingLeft();
 	bool isMovingRight();
 
 private:
+	void renderLoopPipelined();
 	void showFPS();
 	double m_LastTime{ 0 };
 	uint16_t m_NrOfFrames{ 0 };
 	bool m_VSync;
 
+	unsigned m_PipelineDepth{ 1 };
+	PipelineStatistics m_Statistics;
+	// counted by the thread that computes the frames.
+	std::atomic<uint32_t> m_NrOfComputedFrames{ 0 };
+	// the presented frames that were computed, and their summed latency.
+	uint32_t m_NrOfLatencySamples{ 0 };
+	double m_LatencySum{ 0 };
+
 	GLuint m_Width;
 	GLuint m_Height;
 	std::string m_Title;
@@ -104,9 +143,27 @@ void ComputeWindow<C>::init()
 	}
 }
 
+template<HasCompute C>
+void ComputeWindow<C>::setPipelineDepth(unsigned depth)
+{
+	if constexpr (!CPUCompute<C>) {
+		if (depth > 1) {
+			throw std::runtime_error("ComputeWindow::setPipelineDepth: the compute object does not declare ComputesOnCPU,"
+				" a pipelined loop would call it without an OpenGL context.");
+		}
+	}
+	m_PipelineDepth = depth == 0 ? 1 : depth;
+}
+
 template<HasCompute C>
 void ComputeWindow<C>::renderLoop()
 {
+	if constexpr (CPUCompute<C>) {
+		if (m_PipelineDepth > 1) {
+			renderLoopPipelined();
+			return;
+		}
+	}
 	while (!glfwWindowShouldClose(m_pWindow.get())) {
 		// Input handling
 		if (glfwGetKey(m_pWindow.get(), GLFW_KEY_ESCAPE) == GLFW_PRESS)
@@ -116,6 +173,7 @@ void ComputeWindow<C>::renderLoop()
 		glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
 		glClear(GL_COLOR_BUFFER_BIT);
 
+		const double started = glfwGetTime();
 		m_Compute.compute(m_SurfaceRenderer);
 		m_SurfaceRenderer.updateTexture();
 
@@ -124,10 +182,112 @@ void ComputeWindow<C>::renderLoop()
 		showFPS();
 		// Swap buffers and poll IO events
 		glfwSwapBuffers(m_pWindow.get());
+		m_LatencySum += glfwGetTime() - started;
+		++m_NrOfLatencySamples;
+		++m_NrOfComputedFrames;
 		glfwPollEvents();
 	}
 }
 
+template<HasCompute C>
+void ComputeWindow<C>::renderLoopPipelined()
+{
+	static_assert(CPUCompute<C>, "Only compute objects on the CPU backend can run in a pipelined loop.");
+	using RenderBuffer = SurfaceRenderer::RenderBuffer;
+	struct ComputedFrame {
+		std::unique_ptr<RenderBuffer> pixels;
+		double started;
+	};
+
+	std::mutex mutex;
+	std::condition_variable_any changed;
+	// buffers that take the pixels of the next computed frame, and the
+	// computed frames in the order they are presented.
+	std::vector<std::unique_ptr<RenderBuffer>> free;
+	std::deque<ComputedFrame> computed;
+	std::exception_ptr error;
+
+	const tc::ivec2 size = m_SurfaceRenderer.getRenderBuffer()->getDimension();
+	for (unsigned i = 1; i < m_PipelineDepth; ++i) {
+		free.push_back(std::make_unique<RenderBuffer>(size));
+	}
+
+	// declared after everything it uses: when the loop below throws, its
+	// destructor requests the stop, which wakes the wait, and joins.
+	std::jthread worker{ [&](std::stop_token stopToken) {
+		try {
+			while (!stopToken.stop_requested()) {
+				const double started = glfwGetTime();
+				m_Compute.compute(m_SurfaceRenderer);
+				++m_NrOfComputedFrames;
+
+				std::unique_lock lock{ mutex };
+				changed.wait(lock, stopToken, [&] { return !free.empty(); });
+				if (stopToken.stop_requested()) {
+					return;
+				}
+				std::unique_ptr<RenderBuffer> frame = std::move(free.back());
+				free.pop_back();
+				m_SurfaceRenderer.swapRenderBuffer(*frame);
+				computed.push_back({ std::move(frame), started });
+				changed.notify_all();
+			}
+		}
+		catch (...) {
+			std::lock_guard lock{ mutex };
+			error = std::current_exception();
+			changed.notify_all();
+		}
+	} };
+
+	while (!glfwWindowShouldClose(m_pWindow.get())) {
+		if (glfwGetKey(m_pWindow.get(), GLFW_KEY_ESCAPE) == GLFW_PRESS)
+			glfwSetWindowShouldClose(m_pWindow.get(), true);
+
+		// without a new frame the last one is drawn again, the window stays
+		// responsive while a slow frame is computed.
+		ComputedFrame frame{ nullptr, 0 };
+		{
+			std::unique_lock lock{ mutex };
+			changed.wait_for(lock, std::chrono::milliseconds(16), [&] { return error || !computed.empty(); });
+			if (error) {
+				break;
+			}
+			if (!computed.empty()) {
+				frame = std::move(computed.front());
+				computed.pop_front();
+			}
+		}
+		const bool hasFrame = frame.pixels != nullptr;
+		if (hasFrame) {
+			m_SurfaceRenderer.updateTexture(*frame.pixels);
+			{
+				std::lock_guard lock{ mutex };
+				free.push_back(std::move(frame.pixels));
+			}
+			changed.notify_all();
+		}
+
+		glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT);
+		m_SurfaceRenderer.drawQuadWithTexture();
+
+		showFPS();
+		glfwSwapBuffers(m_pWindow.get());
+		if (hasFrame) {
+			m_LatencySum += glfwGetTime() - frame.started;
+			++m_NrOfLatencySamples;
+		}
+		glfwPollEvents();
+	}
+
+	worker.request_stop();
+	worker.join();
+	if (error) {
+		std::rethrow_exception(error);
+	}
+}
+
 template<HasCompute C>
 void ComputeWindow<C>::showFPS() {
 	double currentTime = glfwGetTime();
@@ -138,12 +298,23 @@ void ComputeWindow<C>::showFPS() {
 
 		uint32_t fps = static_cast<uint32_t>(double(m_NrOfFrames) / delta);
 
+		m_Statistics.presentedPerSecond = double(m_NrOfFrames) / delta;
+		m_Statistics.computedPerSecond = double(m_NrOfComputedFrames.exchange(0)) / delta;
+		m_Statistics.latency = m_NrOfLatencySamples > 0 ? m_LatencySum / m_NrOfLatencySamples : 0.0;
+
 		std::stringstream ss;
 		ss << m_Title << " [" << fps << " FPS]";
+		if (m_PipelineDepth > 1) {
+			ss << std::fixed << std::setprecision(1)
+				<< " [" << m_Statistics.computedPerSecond << " frames/s computed, "
+				<< m_Statistics.latency * 1000.0 << " ms latency]";
+		}
 
 		glfwSetWindowTitle(m_pWindow.get(), ss.str().c_str());
 
 		m_NrOfFrames = 0;
+		m_NrOfLatencySamples = 0;
+		m_LatencySum = 0;
 		m_LastTime = currentTime;
 	}
 }
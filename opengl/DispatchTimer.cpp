@@ -0,0 +1,52 @@
+#include "DispatchTimer.hpp"
+
+namespace tc::gpu {
+
+	DispatchTimer::~DispatchTimer()
+	{
+		for (const PendingQuery& pending : m_Pending) {
+			m_FreeQueries.push_back(pending.query);
+		}
+		if (!m_FreeQueries.empty()) {
+			glDeleteQueries(static_cast<GLsizei>(m_FreeQueries.size()), m_FreeQueries.data());
+		}
+	}
+
+	void DispatchTimer::begin(const std::string& key, std::size_t candidate)
+	{
+		GLuint query = 0;
+		if (m_FreeQueries.empty()) {
+			glGenQueries(1, &query);
+		}
+		else {
+			query = m_FreeQueries.back();
+			m_FreeQueries.pop_back();
+		}
+		glBeginQuery(GL_TIME_ELAPSED, query);
+		m_Pending.push_back({ query, key, candidate });
+	}
+
+	void DispatchTimer::end()
+	{
+		glEndQuery(GL_TIME_ELAPSED);
+	}
+
+	void DispatchTimer::collect(const ResultCallback& onResult)
+	{
+		// queries finish in submission order, stop at the first one that is not ready.
+		std::size_t finished = 0;
+		for (; finished < m_Pending.size(); ++finished) {
+			const PendingQuery& pending = m_Pending[finished];
+			GLint available = GL_FALSE;
+			glGetQueryObjectiv(pending.query, GL_QUERY_RESULT_AVAILABLE, &available);
+			if (!available) {
+				break;
+			}
+			GLuint64 elapsed = 0;
+			glGetQueryObjectui64v(pending.query, GL_QUERY_RESULT, &elapsed);
+			onResult(pending.key, pending.candidate, static_cast<double>(elapsed));
+			m_FreeQueries.push_back(pending.query);
+		}
+		m_Pending.erase(m_Pending.begin(), m_Pending.begin() + finished);
+	}
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "GL/glew.h"
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace tc::gpu {
+
+	/*
+	 * Measures the GPU time of dispatches with GL_TIME_ELAPSED queries.
+	 *
+	 * Results are read back without stalling: collect only reports the queries
+	 * whose result is available, the others are checked again on the next call.
+	 * Finished query objects are reused.
+	 */
+	class DispatchTimer
+	{
+	public:
+		using ResultCallback = std::function<void(const std::string& key, std::size_t candidate, double nanoseconds)>;
+
+		DispatchTimer() = default;
+		~DispatchTimer();
+
+		DispatchTimer(const DispatchTimer&) = delete;
+		DispatchTimer& operator=(const DispatchTimer&) = delete;
+
+		// key and candidate are handed back by collect with the measured time.
+		void begin(const std::string& key, std::size_t candidate);
+		void end();
+
+		void collect(const ResultCallback& onResult);
+
+	private:
+		struct PendingQuery {
+			GLuint query;
+			std::string key;
+			std::size_t candidate;
+		};
+
+		std::vector<PendingQuery> m_Pending;
+		std::vector<GLuint> m_FreeQueries;
+	};
+}
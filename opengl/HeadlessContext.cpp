@@ -0,0 +1,153 @@
+#include "HeadlessContext.hpp"
+
+#include <GLFW/glfw3.h>
+
+#include <stdexcept>
+
+#if defined(__linux__) && !defined(GLEW_EGL)
+#include <dlfcn.h>
+#endif
+
+namespace tc::gpu {
+
+	namespace {
+		std::string glfwErrorText()
+		{
+			const char* description = nullptr;
+			glfwGetError(&description);
+			return description ? description : "unknown error";
+		}
+
+		GLFWwindow* createHiddenWindow(bool debug, int contextApi)
+		{
+			glfwDefaultWindowHints();
+			glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+			glfwWindowHint(GLFW_CONTEXT_CREATION_API, contextApi);
+			// compute shaders require 4.3
+			glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+			glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+			glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+			glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, debug ? GLFW_TRUE : GLFW_FALSE);
+			return glfwCreateWindow(1, 1, "TinyCompute", nullptr, nullptr);
+		}
+
+		// the null platform has no display, it only creates EGL (surfaceless
+		// Mesa) and OSMesa contexts.
+		bool initNullPlatform()
+		{
+			glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+			bool initialized = glfwInit();
+			glfwInitHint(GLFW_PLATFORM, GLFW_ANY_PLATFORM);
+			return initialized;
+		}
+
+		// GLEW built for GLX loads the entry points with glXGetProcAddress,
+		// they only reach an EGL context through the dispatch of libglvnd,
+		// which libEGL then has loaded.
+		bool canLoadForEGL()
+		{
+#if defined(__linux__) && !defined(GLEW_EGL)
+			void* dispatch = dlopen("libGLdispatch.so.0", RTLD_LAZY | RTLD_NOLOAD);
+			if (dispatch) {
+				dlclose(dispatch);
+			}
+			return dispatch != nullptr;
+#else
+			return true;
+#endif
+		}
+
+		std::string glString(GLenum name)
+		{
+			const GLubyte* value = glGetString(name);
+			return value ? reinterpret_cast<const char*>(value) : "";
+		}
+	}
+
+	HeadlessContext::HeadlessContext(bool debug, HeadlessApi api)
+	{
+		std::string error = "no context api was tried";
+		if (api == HeadlessApi::Any || api == HeadlessApi::Native) {
+			if (glfwInit()) {
+				m_pWindow = createHiddenWindow(debug, GLFW_NATIVE_CONTEXT_API);
+				m_Api = HeadlessApi::Native;
+				if (!m_pWindow) {
+					error = glfwErrorText();
+					glfwTerminate();
+				}
+			}
+			else {
+				error = glfwErrorText();
+			}
+		}
+
+		// no display, the null platform creates EGL and OSMesa contexts.
+		for (HeadlessApi fallback : { HeadlessApi::EGL, HeadlessApi::OSMesa }) {
+			if (m_pWindow || (api != HeadlessApi::Any && api != fallback)) {
+				continue;
+			}
+			if (!initNullPlatform()) {
+				error = "Failed to initialize GLFW: " + glfwErrorText();
+				continue;
+			}
+			m_pWindow = createHiddenWindow(debug, fallback == HeadlessApi::EGL ? GLFW_EGL_CONTEXT_API : GLFW_OSMESA_CONTEXT_API);
+			m_Api = fallback;
+			if (!m_pWindow) {
+				error = glfwErrorText();
+				glfwTerminate();
+			}
+		}
+		if (!m_pWindow) {
+			throw std::runtime_error("Failed to create a headless OpenGL 4.3 context: " + error);
+		}
+		glfwMakeContextCurrent(m_pWindow);
+		if (m_Api == HeadlessApi::EGL && !canLoadForEGL()) {
+			glfwDestroyWindow(m_pWindow);
+			glfwTerminate();
+			throw std::runtime_error("The EGL context needs libglvnd to load OpenGL with GLEW built for GLX, "
+				"configure with TINY_COMPUTE_GLEW_EGL on systems without it.");
+		}
+
+		glewExperimental = GL_TRUE; // Needed for core profile
+		// only the GL entry points, glewInit would also load the extensions of
+		// GLX or EGL and fails for a context of the other one.
+		GLenum glewStatus = glewContextInit();
+		if (glewStatus != GLEW_OK) {
+			glfwDestroyWindow(m_pWindow);
+			glfwTerminate();
+			throw std::runtime_error(std::string("GLEW Initialization failed: ") + reinterpret_cast<const char*>(glewGetErrorString(glewStatus)));
+		}
+		if (!GLEW_VERSION_4_3) {
+			std::string renderer = getRenderer();
+			glfwDestroyWindow(m_pWindow);
+			glfwTerminate();
+			throw std::runtime_error("OpenGL 4.3 is not supported by " + renderer);
+		}
+	}
+
+	HeadlessContext::~HeadlessContext()
+	{
+		glfwDestroyWindow(m_pWindow);
+		glfwTerminate();
+	}
+
+	void HeadlessContext::makeCurrent()
+	{
+		glfwMakeContextCurrent(m_pWindow);
+	}
+
+	void HeadlessContext::finish()
+	{
+		glFinish();
+	}
+
+	std::string HeadlessContext::getRenderer() const
+	{
+		return glString(GL_RENDERER);
+	}
+
+	std::string HeadlessContext::getVersion() const
+	{
+		return glString(GL_VERSION);
+	}
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "GL/glew.h"
+
+#include <string>
+
+struct GLFWwindow;
+
+namespace tc::gpu {
+
+	// How the context is created, Any tries them in this order.
+	enum class HeadlessApi {
+		Any,
+		// a hidden window on the display, GLX or WGL.
+		Native,
+		// EGL without a display, surfaceless on Mesa.
+		EGL,
+		// software rendering with llvmpipe.
+		OSMesa
+	};
+
+	/*
+	 * An OpenGL 4.3 core context without a visible window, so GPUBackend runs
+	 * in batch jobs, benchmarks and tests.
+	 *
+	 * With a display the context belongs to a hidden GLFW window. Without one
+	 * (servers, CI) GLFW falls back to its null platform: first an EGL context
+	 * on the surfaceless platform of Mesa, which renders on the GPU when the
+	 * render node is accessible, then an OSMesa context which renders with
+	 * llvmpipe. The context is current on the thread that created it.
+	 *
+	 * GLEW is built for GLX by default and loads OpenGL with glXGetProcAddress.
+	 * For the EGL context that needs libglvnd, whose dispatch forwards those
+	 * entry points to the current EGL context (current Mesa and NVIDIA drivers
+	 * ship it), and the constructor throws without it. Configuring with
+	 * TINY_COMPUTE_GLEW_EGL builds GLEW on eglGetProcAddress instead, which
+	 * suits EGL only builds on systems without libglvnd.
+	 */
+	class HeadlessContext
+	{
+	public:
+		explicit HeadlessContext(bool debug = false, HeadlessApi api = HeadlessApi::Any);
+		~HeadlessContext();
+
+		HeadlessContext(const HeadlessContext&) = delete;
+		HeadlessContext& operator=(const HeadlessContext&) = delete;
+
+		// makes the context current on the calling thread.
+		void makeCurrent();
+
+		// waits until every command that was issued is done, for timing a
+		// dispatch from the CPU.
+		void finish();
+
+		// as reported by the driver, "llvmpipe (LLVM ...)" on Mesa without a GPU.
+		std::string getRenderer() const;
+		std::string getVersion() const;
+
+		// the api the context was created with, never Any.
+		HeadlessApi getApi() const {
+			return m_Api;
+		}
+
+	private:
+		GLFWwindow* m_pWindow{ nullptr };
+		HeadlessApi m_Api{ HeadlessApi::Any };
+	};
+}
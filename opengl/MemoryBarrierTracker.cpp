@@ -0,0 +1,104 @@
+#include "MemoryBarrierTracker.hpp"
+
+namespace tc::gpu {
+
+	// Every way a shader write to an SSBO can be consumed later on.
+	constexpr GLbitfield gBufferWriteBits =
+		GL_SHADER_STORAGE_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT;
+
+	// Every way a shader write to an image can be consumed later on.
+	constexpr GLbitfield gTextureWriteBits =
+		GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT;
+
+	void MemoryBarrierTracker::bindStorageBuffer(GLuint binding, GLuint buffer)
+	{
+		m_BoundBuffers.insert_or_assign(binding, buffer);
+	}
+
+	void MemoryBarrierTracker::bindImage(GLuint unit, GLuint texture)
+	{
+		m_BoundImages.insert_or_assign(unit, texture);
+	}
+
+	void MemoryBarrierTracker::beforeDispatch()
+	{
+		for (const auto& [binding, buffer] : m_BoundBuffers) {
+			require(ResourceKind::Buffer, buffer, GL_SHADER_STORAGE_BARRIER_BIT);
+		}
+		for (const auto& [unit, texture] : m_BoundImages) {
+			require(ResourceKind::Texture, texture, GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+		}
+		flush();
+	}
+
+	void MemoryBarrierTracker::afterDispatch()
+	{
+		for (const auto& [binding, buffer] : m_BoundBuffers) {
+			markWritten(ResourceKind::Buffer, buffer);
+		}
+		for (const auto& [unit, texture] : m_BoundImages) {
+			markWritten(ResourceKind::Texture, texture);
+		}
+	}
+
+	void MemoryBarrierTracker::beforeBufferUpdate(GLuint buffer)
+	{
+		require(ResourceKind::Buffer, buffer, GL_BUFFER_UPDATE_BARRIER_BIT);
+		flush();
+	}
+
+	void MemoryBarrierTracker::beforeIndirectDispatch(GLuint buffer)
+	{
+		require(ResourceKind::Buffer, buffer, GL_COMMAND_BARRIER_BIT);
+		flush();
+	}
+
+	void MemoryBarrierTracker::beforeTextureUpdate(GLuint texture)
+	{
+		require(ResourceKind::Texture, texture, GL_TEXTURE_UPDATE_BARRIER_BIT);
+		flush();
+	}
+
+	void MemoryBarrierTracker::beforeTextureFetch(GLuint texture)
+	{
+		require(ResourceKind::Texture, texture, GL_TEXTURE_FETCH_BARRIER_BIT);
+		flush();
+	}
+
+	void MemoryBarrierTracker::markWritten(ResourceKind kind, GLuint name)
+	{
+		if (name == 0) {
+			return;
+		}
+		m_PendingWrites.insert_or_assign(key(kind, name),
+			kind == ResourceKind::Buffer ? gBufferWriteBits : gTextureWriteBits);
+	}
+
+	void MemoryBarrierTracker::require(ResourceKind kind, GLuint name, GLbitfield bits)
+	{
+		auto it = m_PendingWrites.find(key(kind, name));
+		if (it != m_PendingWrites.end()) {
+			m_RequiredBits |= it->second & bits;
+		}
+	}
+
+	void MemoryBarrierTracker::flush()
+	{
+		if (m_RequiredBits == 0) {
+			return;
+		}
+		glMemoryBarrier(m_RequiredBits);
+
+		// a barrier is global, it covers the pending writes of every resource.
+		for (auto it = m_PendingWrites.begin(); it != m_PendingWrites.end();) {
+			it->second &= ~m_RequiredBits;
+			if (it->second == 0) {
+				it = m_PendingWrites.erase(it);
+			}
+			else {
+				++it;
+			}
+		}
+		m_RequiredBits = 0;
+	}
+}
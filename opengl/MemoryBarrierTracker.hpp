@@ -0,0 +1,61 @@
+#pragma once
+
+#include "GL/glew.h"
+
+#include <cstdint>
+#include <unordered_map>
+
+namespace tc::gpu {
+
+	// SSBO names and texture names live in separate OpenGL namespaces,
+	// so the kind is part of the key of a tracked resource.
+	enum class ResourceKind : uint8_t {
+		Buffer, Texture
+	};
+
+	/*
+	 * Keeps track of which SSBOs and images have been written by a dispatch
+	 * and issues the narrowest glMemoryBarrier that makes those writes visible
+	 * to the next consumer that actually reads them.
+	 *
+	 * A kernel does not declare whether it reads or writes a binding, so every
+	 * resource bound to a dispatch is treated as written by that dispatch.
+	 */
+	class MemoryBarrierTracker
+	{
+	public:
+		void bindStorageBuffer(GLuint binding, GLuint buffer);
+		void bindImage(GLuint unit, GLuint texture);
+
+		// Issues the barrier needed by the resources bound for the next dispatch.
+		void beforeDispatch();
+		// Marks every resource bound to the last dispatch as written.
+		void afterDispatch();
+
+		// glBufferData, glBufferSubData, glMapBuffer, ...
+		void beforeBufferUpdate(GLuint buffer);
+		// glDispatchComputeIndirect reading its group counts from the buffer.
+		void beforeIndirectDispatch(GLuint buffer);
+		// glTexImage*, glTexSubImage*, glGetTexImage, ...
+		void beforeTextureUpdate(GLuint texture);
+		// sampling the texture in a draw call.
+		void beforeTextureFetch(GLuint texture);
+
+	private:
+		static uint64_t key(ResourceKind kind, GLuint name) {
+			return (uint64_t(kind) << 32) | name;
+		}
+
+		void markWritten(ResourceKind kind, GLuint name);
+		void require(ResourceKind kind, GLuint name, GLbitfield bits);
+		void flush();
+
+		// binding point / image unit -> object name, mirrors the GL binding state.
+		std::unordered_map<GLuint, GLuint> m_BoundBuffers;
+		std::unordered_map<GLuint, GLuint> m_BoundImages;
+
+		// resource -> barrier bits that have not been issued since its last write.
+		std::unordered_map<uint64_t, GLbitfield> m_PendingWrites;
+		GLbitfield m_RequiredBits{ 0 };
+	};
+}
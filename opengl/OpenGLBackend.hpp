@@ -3,12 +3,23 @@
 #include "GL/glew.h"
 
 #include "ComputeShader.hpp"
+#include "DispatchTimer.hpp"
+#include "MemoryBarrierTracker.hpp"
+#include "ProgramBinaryCache.hpp"
+#include "UniformRing.hpp"
 
 #include "computebackend.hpp"
 #include "kernel_intrinsics.hpp"
 #include "images/ImageFormat.hpp"
+#include "layout/std140.hpp"
+#include "tuning/autotune.hpp"
 
 #include <unordered_map>
+#include <map>
+#include <algorithm>
+#include <sstream>
+#include <iomanip>
+#include <limits>
 #include <cstring> // memcpy
 
 namespace tc::gpu {
@@ -32,6 +43,7 @@ namespace tc::gpu {
 				buffer.setSSBO_ID(bufferID);
 				std::cout << "Generated buffer with id " << bufferID << "\n";
 			}
+			m_Barriers.beforeBufferUpdate(buffer.getSSBO_ID());
 			glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer.getSSBO_ID());
 
 			// Allocate memory for the SSBO and upload the data
@@ -55,6 +67,7 @@ namespace tc::gpu {
 				return;
 			}
 
+			m_Barriers.beforeBufferUpdate(buffer.getSSBO_ID());
 			glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer.getSSBO_ID());
 
 			// Map the buffer to read from GPU
@@ -78,9 +91,65 @@ namespace tc::gpu {
 		{
 			unsigned int bufferID = buffer.getBufferData()->getSSBO_ID();
 			glBindBufferBase(GL_SHADER_STORAGE_BUFFER, Binding, bufferID);
+			m_Barriers.bindStorageBuffer(Binding, bufferID);
 			buffer.getBufferData()->setBufferLocation(BufferLocation::GPU);
 		}
 
+		// Every member array of a structure of arrays buffer is its own SSBO.
+		template<typename T>
+		void uploadBufferImpl(tc::BufferResource<T, tc::Dim::D1, tc::StorageLayout::SoA>& buffer)
+		{
+			forEachColumn(buffer, [&](std::size_t field, auto& column) {
+				unsigned int bufferID = buffer.getSSBO_ID(field);
+				if (bufferID == 0) {
+					glGenBuffers(1, &bufferID);
+					buffer.setSSBO_ID(field, bufferID);
+				}
+				m_Barriers.beforeBufferUpdate(bufferID);
+				glBindBuffer(GL_SHADER_STORAGE_BUFFER, bufferID);
+				glBufferData(GL_SHADER_STORAGE_BUFFER, column.size() * sizeof(column[0]), column.data(), GL_STATIC_DRAW);
+				});
+			glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+			buffer.setBufferLocation(BufferLocation::GPU);
+		}
+
+		template<typename T>
+		void downloadBufferImpl(tc::BufferResource<T, tc::Dim::D1, tc::StorageLayout::SoA>& buffer)
+		{
+			forEachColumn(buffer, [&](std::size_t field, auto& column) {
+				unsigned int bufferID = buffer.getSSBO_ID(field);
+				if (bufferID == 0) {
+					std::cerr << "Error: Trying to download from an uninitialized buffer.\n";
+					return;
+				}
+				m_Barriers.beforeBufferUpdate(bufferID);
+				glBindBuffer(GL_SHADER_STORAGE_BUFFER, bufferID);
+				void* ptr = glMapBuffer(GL_SHADER_STORAGE_BUFFER, GL_READ_ONLY);
+				if (!ptr) {
+					std::cerr << "Error: Failed to map SSBO for reading.\n";
+					return;
+				}
+				std::memcpy(column.data(), ptr, column.size() * sizeof(column[0]));
+				glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
+				});
+			glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+		}
+
+		// member n is bound at Binding + n, the transpiler declares the SSBOs
+		// of the members at the same bindings.
+		template<typename T, unsigned Binding, unsigned Set>
+		void bindBufferImpl(const tc::BufferBinding<T, Binding, Set, tc::StorageLayout::SoA>& buffer)
+		{
+			auto* pData = buffer.getBufferData();
+			for (std::size_t field = 0; field < pData->FieldCount; ++field) {
+				unsigned int bufferID = pData->getSSBO_ID(field);
+				GLuint binding = static_cast<GLuint>(Binding + field);
+				glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, bufferID);
+				m_Barriers.bindStorageBuffer(binding, bufferID);
+			}
+			pData->setBufferLocation(BufferLocation::GPU);
+		}
+
 		template<tc::InternalFormat G>
 		struct OpenGLFormatTraits;
 
@@ -102,6 +171,36 @@ namespace tc::gpu {
 			static constexpr uint8_t NumChannels = 1;
 		};
 
+		template<>
+		struct OpenGLFormatTraits<tc::InternalFormat::R32F> {
+			static constexpr GLuint internalType = GL_R32F;
+			static constexpr uint8_t NumChannels = 1;
+		};
+
+		template<>
+		struct OpenGLFormatTraits<tc::InternalFormat::RGBA16F> {
+			static constexpr GLuint internalType = GL_RGBA16F;
+			static constexpr uint8_t NumChannels = 4;
+		};
+
+		template<>
+		struct OpenGLFormatTraits<tc::InternalFormat::R16F> {
+			static constexpr GLuint internalType = GL_R16F;
+			static constexpr uint8_t NumChannels = 1;
+		};
+
+		template<>
+		struct OpenGLFormatTraits<tc::InternalFormat::R11F_G11F_B10F> {
+			static constexpr GLuint internalType = GL_R11F_G11F_B10F;
+			static constexpr uint8_t NumChannels = 3;
+		};
+
+		template<>
+		struct OpenGLFormatTraits<tc::InternalFormat::RGB10_A2> {
+			static constexpr GLuint internalType = GL_RGB10_A2;
+			static constexpr uint8_t NumChannels = 4;
+		};
+
 		template<tc::cpu::PixelConcept> struct OpenGLExternalTraits;
 
 		template<> struct OpenGLExternalTraits<tc::cpu::R8UI> {
@@ -110,12 +209,19 @@ namespace tc::gpu {
 			static constexpr int    channels = 1;
 		};
 
-		//template<> struct OpenGLExternalTraits<tc::R8> {
-		//	static constexpr GLenum format = GL_RED;              // UNorm path
-		//	static constexpr GLenum type = GL_UNSIGNED_BYTE;
-		//	static constexpr int    channels = 1;
-		//	static constexpr int    bytesPerPixel = 1;
-		//};
+		template<> struct OpenGLExternalTraits<tc::cpu::R8> {
+			static constexpr GLenum format = GL_RED;
+			static constexpr GLenum type = GL_UNSIGNED_BYTE;
+			static constexpr int    channels = 1;
+			static constexpr int    bytesPerPixel = 1;
+		};
+
+		template<> struct OpenGLExternalTraits<tc::cpu::RGBA8> {
+			static constexpr GLenum format = GL_RGBA;
+			static constexpr GLenum type = GL_UNSIGNED_BYTE;
+			static constexpr int    channels = 4;
+			static constexpr int    bytesPerPixel = 4;
+		};
 
 		template<> struct OpenGLExternalTraits<tc::cpu::RGBA8UI> {
 			static constexpr GLenum format = GL_RGBA;
@@ -124,20 +230,91 @@ namespace tc::gpu {
 			static constexpr int    bytesPerPixel = 4;
 		};
 
-		template<> struct OpenGLExternalTraits<tc::cpu::RGBA8> {
+		template<> struct OpenGLExternalTraits<tc::cpu::RGBA32F> {
 			static constexpr GLenum format = GL_RGBA;
 			static constexpr GLenum type = GL_FLOAT;
 			static constexpr int    channels = 4;
 			static constexpr int    bytesPerPixel = 16;
 		};
 
-		template<tc::InternalFormat G, tc::cpu::PixelConcept P>
-		void uploadImageImpl(tc::BufferResource<P, tc::Dim::D2>& buffer)
+		template<> struct OpenGLExternalTraits<tc::cpu::R16F> {
+			static constexpr GLenum format = GL_RED;
+			static constexpr GLenum type = GL_HALF_FLOAT;
+			static constexpr int    channels = 1;
+			static constexpr int    bytesPerPixel = 2;
+		};
+
+		template<> struct OpenGLExternalTraits<tc::cpu::RGBA16F> {
+			static constexpr GLenum format = GL_RGBA;
+			static constexpr GLenum type = GL_HALF_FLOAT;
+			static constexpr int    channels = 4;
+			static constexpr int    bytesPerPixel = 8;
+		};
+
+		template<> struct OpenGLExternalTraits<tc::cpu::R11G11B10F> {
+			static constexpr GLenum format = GL_RGB;
+			static constexpr GLenum type = GL_UNSIGNED_INT_10F_11F_11F_REV;
+			static constexpr int    channels = 3;
+			static constexpr int    bytesPerPixel = 4;
+		};
+
+		template<> struct OpenGLExternalTraits<tc::cpu::RGB10A2> {
+			static constexpr GLenum format = GL_RGBA;
+			static constexpr GLenum type = GL_UNSIGNED_INT_2_10_10_10_REV;
+			static constexpr int    channels = 4;
+			static constexpr int    bytesPerPixel = 4;
+		};
+
+		template<tc::cpu::PixelConcept P>
+		static constexpr bool hasExternalTraits = requires { OpenGLExternalTraits<P>::format; };
+
+		// the pixel that is uploaded for P: P itself when GL reads it, else the
+		// four channel pixel with the same channel type.
+		template<tc::cpu::PixelConcept P>
+		static auto uploadPixel()
+		{
+			if constexpr (hasExternalTraits<P>) {
+				return P{};
+			}
+			else {
+				return typename tc::convert::PlainPixel<P>::template WithChannels<4>{};
+			}
+		}
+
+		// Images are linear on the GPU, a tiled or Morton buffer is converted
+		// to a row-major copy first. Pixels that GL does not read are staged
+		// with tc::convert. An image gets immutable storage on its first
+		// upload, later uploads replace the texels while its extent and
+		// format stay the same and reallocate the texture otherwise.
+		template<tc::InternalFormat G, tc::cpu::PixelConcept P, tc::Dim D, tc::StorageLayout L>
+		void uploadImageImpl(tc::BufferResource<P, D, L>& buffer)
 		{
 			static_assert(P::NumChannels >= 1 && P::NumChannels <= 4,
 				"Pixel NumChannels must be 1..4");
-			unsigned int bufferID;
-			if ((bufferID = buffer.getSSBO_ID()) == 0)
+			static_assert(D == tc::Dim::D2 || D == tc::Dim::D3, "Only 2D and 3D images can be uploaded.");
+			constexpr GLenum target = D == tc::Dim::D3 ? GL_TEXTURE_3D : GL_TEXTURE_2D;
+			const auto dim = buffer.getDimension();
+			TextureStorage storage{ OpenGLFormatTraits<G>::internalType, dim.x, dim.y, 1 };
+			if constexpr (D == tc::Dim::D3) {
+				storage.depth = dim.z;
+			}
+			unsigned int bufferID = buffer.getSSBO_ID();
+			bool allocate = bufferID == 0;
+			if (!allocate)
+			{
+				// immutable storage can not be respecified, a texture whose
+				// extent or format changed is replaced by a new one.
+				auto allocated = m_TextureStorage.find(bufferID);
+				allocate = allocated == m_TextureStorage.end() || allocated->second != storage;
+				if (allocated != m_TextureStorage.end() && allocated->second != storage)
+				{
+					m_Barriers.beforeTextureUpdate(bufferID);
+					glDeleteTextures(1, &bufferID);
+					m_TextureStorage.erase(allocated);
+					bufferID = 0;
+				}
+			}
+			if (bufferID == 0)
 			{
 				glGenTextures(1, &bufferID);
 				buffer.setSSBO_ID(bufferID);
@@ -148,25 +325,60 @@ namespace tc::gpu {
 				throw std::runtime_error("Failed to generate texture.");
 			}
 
+			m_Barriers.beforeTextureUpdate(bufferID);
 			glActiveTexture(GL_TEXTURE0);
-			glBindTexture(GL_TEXTURE_2D, bufferID);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+			glBindTexture(target, bufferID);
+			glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+			glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+			if constexpr (D == tc::Dim::D3) {
+				glTexParameteri(target, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+			}
+			glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+			glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 
 			glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 			glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
 			glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
 			glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
 			// Upload texture data
-			tc::ivec2 dim = buffer.getDimension();
-			glTexImage2D(GL_TEXTURE_2D, 0,
-				OpenGLFormatTraits<G>::internalType,
-				dim.x, dim.y, 0,
-				OpenGLExternalTraits<P>::format, OpenGLExternalTraits<P>::type,
-				buffer.data()
-			);
+			const size_t count = static_cast<size_t>(tc::DimTraits<D>::product(dim));
+			const P* pixels = buffer.data();
+			std::vector<P> linear;
+			if constexpr (L != tc::StorageLayout::Linear) {
+				linear.resize(count);
+				buffer.copyToLinear(linear.data());
+				pixels = linear.data();
+			}
+			using U = decltype(uploadPixel<P>());
+			const void* uploadData = pixels;
+			std::vector<U> staged;
+			if constexpr (!std::is_same_v<U, P>) {
+				staged.resize(count);
+				tc::convert::convertPixels(pixels, staged.data(), count);
+				uploadData = staged.data();
+			}
+			if constexpr (D == tc::Dim::D3) {
+				glPixelStorei(GL_UNPACK_IMAGE_HEIGHT, 0);
+				glPixelStorei(GL_UNPACK_SKIP_IMAGES, 0);
+				if (allocate) {
+					glTexStorage3D(GL_TEXTURE_3D, 1, OpenGLFormatTraits<G>::internalType, dim.x, dim.y, dim.z);
+					m_TextureStorage[bufferID] = storage;
+				}
+				glTexSubImage3D(GL_TEXTURE_3D, 0, 0, 0, 0, dim.x, dim.y, dim.z,
+					OpenGLExternalTraits<U>::format, OpenGLExternalTraits<U>::type,
+					uploadData
+				);
+			}
+			else {
+				if (allocate) {
+					glTexStorage2D(GL_TEXTURE_2D, 1, OpenGLFormatTraits<G>::internalType, dim.x, dim.y);
+					m_TextureStorage[bufferID] = storage;
+				}
+				glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, dim.x, dim.y,
+					OpenGLExternalTraits<U>::format, OpenGLExternalTraits<U>::type,
+					uploadData
+				);
+			}
 			glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
 
 			GLenum error = glGetError();
@@ -174,79 +386,450 @@ namespace tc::gpu {
 			{
 				throw std::runtime_error("OpenGL Error in OpenGLBackend::uploadImageImpl : " + std::to_string(error));
 			}
-			glBindTexture(GL_TEXTURE_2D, 0);
+			glBindTexture(target, 0);
 			buffer.setBufferLocation(BufferLocation::GPU);
 		}
 
+		// Reads the texels of an image back with glGetTexImage, after the
+		// barrier for the dispatches that wrote it. Pixels that GL does not
+		// return are converted with tc::convert, a tiled or Morton buffer is
+		// filled from a row-major copy.
+		template<tc::cpu::PixelConcept P, tc::Dim D, tc::StorageLayout L>
+		void downloadImageImpl(tc::BufferResource<P, D, L>& buffer)
+		{
+			static_assert(D == tc::Dim::D2 || D == tc::Dim::D3, "Only 2D and 3D images can be downloaded.");
+			constexpr GLenum target = D == tc::Dim::D3 ? GL_TEXTURE_3D : GL_TEXTURE_2D;
+			const GLuint textureID = buffer.getSSBO_ID();
+			if (textureID == 0) {
+				throw std::runtime_error("downloadImage: the image was never uploaded.");
+			}
+
+			const auto dim = buffer.getDimension();
+			const size_t count = static_cast<size_t>(tc::DimTraits<D>::product(dim));
+			P* pixels = buffer.data();
+			std::vector<P> linear;
+			if constexpr (L != tc::StorageLayout::Linear) {
+				linear.resize(count);
+				pixels = linear.data();
+			}
+			using U = decltype(uploadPixel<P>());
+			void* readData = pixels;
+			std::vector<U> staged;
+			if constexpr (!std::is_same_v<U, P>) {
+				staged.resize(count);
+				readData = staged.data();
+			}
+
+			m_Barriers.beforeTextureUpdate(textureID);
+			glBindTexture(target, textureID);
+			// glGetTexImage writes the whole level, it has to fit the buffer.
+			GLint width = 0, height = 0, depth = 1;
+			glGetTexLevelParameteriv(target, 0, GL_TEXTURE_WIDTH, &width);
+			glGetTexLevelParameteriv(target, 0, GL_TEXTURE_HEIGHT, &height);
+			if constexpr (D == tc::Dim::D3) {
+				glGetTexLevelParameteriv(target, 0, GL_TEXTURE_DEPTH, &depth);
+			}
+			if (static_cast<size_t>(width) * height * depth != count || width != dim.x || height != dim.y) {
+				glBindTexture(target, 0);
+				throw std::runtime_error("downloadImage: the texture is " + std::to_string(width) + "x"
+					+ std::to_string(height) + "x" + std::to_string(depth) + ", the buffer has a different size.");
+			}
+			glPixelStorei(GL_PACK_ALIGNMENT, 1);
+			glPixelStorei(GL_PACK_ROW_LENGTH, 0);
+			glPixelStorei(GL_PACK_SKIP_ROWS, 0);
+			glPixelStorei(GL_PACK_SKIP_PIXELS, 0);
+			if constexpr (D == tc::Dim::D3) {
+				glPixelStorei(GL_PACK_IMAGE_HEIGHT, 0);
+				glPixelStorei(GL_PACK_SKIP_IMAGES, 0);
+			}
+			glGetTexImage(target, 0, OpenGLExternalTraits<U>::format, OpenGLExternalTraits<U>::type, readData);
+			glPixelStorei(GL_PACK_ALIGNMENT, 4);
+			glBindTexture(target, 0);
+
+			GLenum error = glGetError();
+			if (error != GL_NO_ERROR)
+			{
+				throw std::runtime_error("OpenGL Error in OpenGLBackend::downloadImageImpl : " + std::to_string(error));
+			}
+			if constexpr (!std::is_same_v<U, P>) {
+				tc::convert::convertPixels(staged.data(), pixels, count);
+			}
+			if constexpr (L != tc::StorageLayout::Linear) {
+				buffer.copyFromLinear(linear.data());
+			}
+		}
 
-		template<tc::InternalFormat G, tc::Dim D, tc::cpu::PixelConcept P, unsigned B, unsigned S>
-		void bindImageImpl(const tc::ImageBinding<G, D, P, B, S>& image)
+
+		template<tc::InternalFormat G, tc::Dim D, tc::cpu::PixelConcept P, unsigned B, unsigned S, tc::StorageLayout L, tc::AddressMode A>
+		void bindImageImpl(const tc::ImageBinding<G, D, P, B, S, L, A>& image)
 		{
 			unsigned int imageID = image.getBufferData()->getSSBO_ID();
 			unsigned int internalType = OpenGLFormatTraits<G>::internalType;
 			uint8_t binding = B;
-			glBindImageTexture(binding, imageID, 0, GL_FALSE, 0, GL_READ_WRITE, internalType);
+			// a 3D image is bound layered, so the kernel sees all of its slices.
+			const GLboolean layered = D == tc::Dim::D3 ? GL_TRUE : GL_FALSE;
+			glBindImageTexture(binding, imageID, 0, layered, 0, GL_READ_WRITE, internalType);
 			GLenum error = glGetError();
 			if (error != GL_NO_ERROR)
 			{
 				throw std::runtime_error("OpenGL Error in GLImage::bind(): " + std::to_string(error));
 			}
+			m_Barriers.bindImage(binding, imageID);
 			image.getBufferData()->setBufferLocation(BufferLocation::GPU);
 		}
 
+		// Stages the value in the std140 uniform block of the current kernel,
+		// the whole block is uploaded at once by the next execute.
 		template<int Location, typename T>
 		void bindUniformImpl(const tc::Uniform<T, Location>& uniform)
 		{
-			if constexpr (std::is_same_v<T, float>)
-				glUniform1f(Location, uniform.get());
-			else if constexpr (std::is_same_v<T, int>)
-				glUniform1i(Location, uniform.get());
-			else if constexpr (std::is_same_v <T, unsigned int>)
-				glUniform1ui(Location, uniform.get());
-			else if constexpr (std::is_same_v<T, vec_base<float,3>>)
-				glUniform3f(Location, uniform.get().x, uniform.get().y, uniform.get().z);
-			else
-				static_assert(false, "Unsupported uniform type for bindUniformImpl.");
+			static_assert(tc::std140::isValidLocation<T>(Location),
+				"Uniform location is not aligned for this type, double vectors need an even location.");
+			if (m_pCurrentShader == nullptr) {
+				throw std::runtime_error("bindUniform called before useKernel.");
+			}
+			std::vector<std::byte>& block = m_pCurrentShader->getUniformData();
+			constexpr uint32_t offset = tc::std140::slotOffset(Location);
+			// the uniform is not used by the kernel and was optimized away.
+			if (offset + tc::std140::sizeOf<T>() > block.size()) {
+				return;
+			}
+			tc::std140::store(block.data() + offset, uniform.get());
 		}
 
 		template<KernelEntry K>
 		void executeImpl(K& kernel, const tc::uvec3 globalWorkSize)
 		{
+			// a tuned local size runs a variant of the program that was compiled
+			// with that size, while tuning every candidate gets a turn. Only
+			// kernels that opt in with tc::tuning::TuneLocalSize are tuned.
+			tc::uvec3 localSize = kernel.local_size;
+			const std::string* pKey = nullptr;
+			std::optional<tc::tuning::Trial> trial;
+			if constexpr (tc::tuning::tune_local_size_v<K>) {
+				if (m_Tuning.isActive()) {
+					if (m_Tuning.isEnabled()) {
+						m_Timer.collect([](const std::string& k, std::size_t c, double nanoseconds) {
+							m_Tuning.addSample(k, c, nanoseconds);
+							});
+					}
+					pKey = &m_Tuning.key(K::fileLocation, 0, tc::tuning::sizeClass(globalWorkSize),
+						[] { return deviceName(); });
+					if (auto tuned = m_Tuning.find(*pKey)) {
+						localSize = *tuned;
+					}
+					else if ((trial = m_Tuning.nextTrial(*pKey,
+						tc::tuning::localSizeCandidates(globalWorkSize, maxInvocations())))) {
+						localSize = trial->value;
+					}
+				}
+			}
+
+			ComputeShader* pShader = m_pCurrentShader;
+			if (!tc::tuning::equal(localSize, kernel.local_size)) {
+				pShader = &beginCompile(K::fileLocation, &localSize);
+				pShader->finishCompile();
+				pShader->getUniformData() = m_pCurrentShader->getUniformData();
+				pShader->use();
+			}
 
-			GLuint workGroupCountX = ceil_div(globalWorkSize.x, kernel.local_size.x);
-			GLuint workGroupCountY = ceil_div(globalWorkSize.y, kernel.local_size.y);
-			GLuint workGroupCountZ = ceil_div(globalWorkSize.z, kernel.local_size.z);
+			// the program knows its real size, a kernel transpiled without the
+			// TC_LOCAL_SIZE defines keeps the size of its source.
+			const std::array<GLint, 3>& programSize = pShader->getLocalSize();
+			GLuint workGroupCountX = ceil_div(globalWorkSize.x, programSize[0]);
+			GLuint workGroupCountY = ceil_div(globalWorkSize.y, programSize[1]);
+			GLuint workGroupCountZ = ceil_div(globalWorkSize.z, programSize[2]);
+			std::vector<std::byte>& uniforms = pShader->getUniformData();
+			if (!uniforms.empty()) {
+				m_UniformRing.bind(tc::std140::UniformBlockBinding, uniforms.data(), uniforms.size());
+			}
+			// Make the writes of earlier dispatches visible to the bound resources.
+			m_Barriers.beforeDispatch();
 			// Dispatch compute shader
+			if (trial) {
+				m_Timer.begin(*pKey, trial->candidate);
+			}
 			glDispatchCompute(workGroupCountX, workGroupCountY, workGroupCountZ);
+			if (trial) {
+				m_Timer.end();
+			}
+			m_Barriers.afterDispatch();
 			GLenum error = glGetError();
 			if (error != GL_NO_ERROR)
 			{
 				throw std::runtime_error("OpenGL Error in ComputeShader::dispatchCompute(): " + std::to_string(error));
 			}
+			if (pShader != m_pCurrentShader) {
+				m_pCurrentShader->use();
+			}
+		}
+
+		// The group counts are read by the GPU, so the kernel runs with its own
+		// local_size and is not tuned.
+		template<KernelEntry K>
+		void executeIndirectImpl(K& kernel, tc::BufferResource<tc::uint>& args, std::size_t first)
+		{
+			if (args.getSSBO_ID() == 0) {
+				throw std::runtime_error("executeIndirect: the argument buffer is not on the GPU.");
+			}
+			std::vector<std::byte>& uniforms = m_pCurrentShader->getUniformData();
+			if (!uniforms.empty()) {
+				m_UniformRing.bind(tc::std140::UniformBlockBinding, uniforms.data(), uniforms.size());
+			}
+			m_Barriers.beforeDispatch();
+			m_Barriers.beforeIndirectDispatch(args.getSSBO_ID());
+			glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, args.getSSBO_ID());
+			glDispatchComputeIndirect(static_cast<GLintptr>(first * sizeof(tc::uint)));
+			glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, 0);
+			m_Barriers.afterDispatch();
+			GLenum error = glGetError();
+			if (error != GL_NO_ERROR)
+			{
+				throw std::runtime_error("OpenGL Error in ComputeShader::dispatchComputeIndirect(): " + std::to_string(error));
+			}
 		}
 
 		template<KernelEntry K>
 		void useKernelImpl(K& kernel)
 		{
 			// check if kernel was compiled.
-			checkKernel(kernel);
-			ComputeShader& shader = m_CompiledPrograms[kernel.fileLocation];
+			ComputeShader& shader = checkKernel(kernel);
 			shader.use();
+			m_pCurrentShader = &shader;
+			m_CurrentKernel = kernel.fileLocation;
+		}
+
+		// Overrides the value of a SpecConstant, every combination of values
+		// gets its own program in which the constant is folded.
+		// When the kernel is in use it switches to the program of the new
+		// values and keeps the uniforms bound so far, otherwise the next
+		// useKernel picks it up.
+		template<KernelEntry K, typename T, unsigned Id, T Default>
+		void specializeImpl(K& kernel, const tc::SpecConstant<T, Id, Default>&, T value)
+		{
+			std::string fileLocation = kernel.fileLocation;
+			std::map<unsigned, std::string>& values = m_Specializations[fileLocation];
+			if (value == Default) {
+				values.erase(Id);
+			}
+			else {
+				values.insert_or_assign(Id, glslLiteral(value));
+			}
+
+			std::string key = fileLocation;
+			for (const auto& [id, literal] : values) {
+				key += "|" + std::to_string(id) + "=" + literal;
+			}
+			m_ProgramKeys.insert_or_assign(fileLocation, key);
+
+			if (m_pCurrentShader != nullptr && m_CurrentKernel == fileLocation) {
+				ComputeShader& shader = checkKernel(kernel);
+				if (&shader != m_pCurrentShader) {
+					shader.getUniformData() = m_pCurrentShader->getUniformData();
+					shader.use();
+					m_pCurrentShader = &shader;
+				}
+			}
+		}
+
+		// Call before sampling the image in a draw call, issues a texture fetch
+		// barrier when a dispatch wrote to the image.
+		template<tc::cpu::PixelConcept P, tc::Dim D, tc::StorageLayout L>
+		void prepareTextureFetch(const tc::BufferResource<P, D, L>& image)
+		{
+			prepareTextureFetch(image.getSSBO_ID());
+		}
+
+		void prepareTextureFetch(GLuint texture)
+		{
+			m_Barriers.beforeTextureFetch(texture);
+		}
+
+		// Call before replacing the texels of the image outside of uploadImage,
+		// e.g. from a pixel unpack buffer.
+		template<tc::cpu::PixelConcept P, tc::Dim D, tc::StorageLayout L>
+		void prepareTextureUpdate(const tc::BufferResource<P, D, L>& image)
+		{
+			prepareTextureUpdate(image.getSSBO_ID());
+		}
+
+		void prepareTextureUpdate(GLuint texture)
+		{
+			m_Barriers.beforeTextureUpdate(texture);
+		}
+
+		// Starts compiling the programs of the given kernels, so they are ready
+		// before the first frame instead of being compiled on first use.
+		// With parallel shader compile the driver compiles in the background,
+		// poll isPrecompileDone to overlap the compiles with other work.
+		template<KernelEntry... K>
+		static void precompile()
+		{
+			if (!m_ParallelCompileChecked) {
+				ComputeShader::enableParallelCompile();
+				m_ParallelCompileChecked = true;
+			}
+			(beginCompile(K::fileLocation), ...);
+		}
+
+		static bool isPrecompileDone()
+		{
+			return std::ranges::all_of(m_CompiledPrograms, [](const auto& entry) {
+				return entry.second.isCompileDone();
+				});
+		}
+
+		// Waits for every pending compile, throws on the first compile error.
+		static void finishPrecompile()
+		{
+			for (auto& [key, shader] : m_CompiledPrograms) {
+				shader.finishCompile();
+			}
+		}
+
+		// Linked programs are cached on disk, keyed by source and driver.
+		static void setProgramCacheDirectory(const std::filesystem::path& directory)
+		{
+			m_BinaryCache.setDirectory(directory);
+		}
+
+		static void setProgramCacheEnabled(bool enabled)
+		{
+			m_BinaryCache.setEnabled(enabled);
+		}
+
+		// Autotuning times the local size candidates on the first executions of
+		// a kernel and stores the fastest one per device and problem size class,
+		// in tuning/gpu.txt unless another file is set. Once a file is set, later
+		// runs compile the kernel with the stored size, also when autotuning is
+		// disabled. Only kernels that opt in with tc::tuning::TuneLocalSize are
+		// tuned, they must not depend on their local_size for correctness.
+		static void setAutotuneEnabled(bool enabled)
+		{
+			m_Tuning.setEnabled(enabled);
+		}
+
+		// an empty path unsets the file.
+		static void setAutotuneFile(const std::filesystem::path& file)
+		{
+			m_Tuning.setFile(file);
 		}
 	private:
 		template<KernelEntry K>
-		void checkKernel(K& kernel)
+		ComputeShader& checkKernel(K& kernel)
 		{
-			if (m_CompiledPrograms.find(kernel.fileLocation) == m_CompiledPrograms.end())
-			{
-				std::string fileLoc = std::string(kernel.fileLocation) + ".comp";
-				ComputeShader shader{ fileLoc };
-				shader.compile();
-				std::string key = kernel.fileLocation;
-				m_CompiledPrograms.insert_or_assign(key, std::move(shader));
+			ComputeShader& shader = beginCompile(kernel.fileLocation);
+			// blocks when a precompile of this kernel is still running.
+			shader.finishCompile();
+			return shader;
+		}
+
+		// Returns the program of the kernel for its current specialization,
+		// the compile is started when there is none yet. pLocalSize overrides
+		// the local_size of the kernel.
+		static ComputeShader& beginCompile(const std::string& fileLocation, const tc::uvec3* pLocalSize = nullptr)
+		{
+			auto keyIt = m_ProgramKeys.find(fileLocation);
+			std::string key = keyIt != m_ProgramKeys.end() ? keyIt->second : fileLocation;
+			if (pLocalSize != nullptr) {
+				key += "|local_size=" + std::to_string(pLocalSize->x) + "," + std::to_string(pLocalSize->y)
+					+ "," + std::to_string(pLocalSize->z);
 			}
+			auto it = m_CompiledPrograms.find(key);
+			if (it != m_CompiledPrograms.end()) {
+				return it->second;
+			}
+
+			ComputeShader shader{ fileLocation + ".comp" };
+			std::string defines;
+			for (const auto& [id, literal] : m_Specializations[fileLocation]) {
+				defines += "#define TC_SPEC_" + std::to_string(id) + " " + literal + "\n";
+			}
+			if (pLocalSize != nullptr) {
+				defines += "#define TC_LOCAL_SIZE_X " + std::to_string(pLocalSize->x) + "\n"
+					+ "#define TC_LOCAL_SIZE_Y " + std::to_string(pLocalSize->y) + "\n"
+					+ "#define TC_LOCAL_SIZE_Z " + std::to_string(pLocalSize->z) + "\n";
+			}
+			shader.addDefines(defines);
+			shader.beginCompile(&m_BinaryCache);
+			return m_CompiledPrograms.insert_or_assign(key, std::move(shader)).first->second;
+		}
+
+		static const std::string& deviceName()
+		{
+			static const std::string name = [] {
+				const GLubyte* vendor = glGetString(GL_VENDOR);
+				const GLubyte* renderer = glGetString(GL_RENDERER);
+				return std::string(vendor ? reinterpret_cast<const char*>(vendor) : "")
+					+ " " + (renderer ? reinterpret_cast<const char*>(renderer) : "");
+				}();
+			return name;
+		}
+
+		static uint32_t maxInvocations()
+		{
+			static const uint32_t count = [] {
+				GLint invocations = 1024;
+				glGetIntegerv(GL_MAX_COMPUTE_WORK_GROUP_INVOCATIONS, &invocations);
+				return static_cast<uint32_t>(invocations);
+				}();
+			return count;
+		}
+
+		template<typename T, typename F>
+		static void forEachColumn(tc::BufferResource<T, tc::Dim::D1, tc::StorageLayout::SoA>& buffer, F&& f)
+		{
+			using Resource = tc::BufferResource<T, tc::Dim::D1, tc::StorageLayout::SoA>;
+			[&]<std::size_t... I>(std::index_sequence<I...>) {
+				(f(I, buffer.template column<I>()), ...);
+			}(std::make_index_sequence<Resource::FieldCount>{});
 		}
 
+		template<typename T>
+		static std::string glslLiteral(T value)
+		{
+			if constexpr (std::is_same_v<T, bool>) {
+				return value ? "true" : "false";
+			}
+			else if constexpr (std::is_floating_point_v<T>) {
+				std::ostringstream literal;
+				literal << std::showpoint << std::setprecision(std::numeric_limits<T>::max_digits10) << value;
+				return literal.str() + (std::is_same_v<T, double> ? "lf" : "");
+			}
+			else if constexpr (std::is_unsigned_v<T>) {
+				return std::to_string(value) + "u";
+			}
+			else {
+				return std::to_string(value);
+			}
+		}
+
+		// programs are keyed by file location and the overridden SpecConstants.
 		static inline std::unordered_map<std::string, ComputeShader> m_CompiledPrograms;
+		// file location -> SpecConstant id -> GLSL literal of the override.
+		static inline std::unordered_map<std::string, std::map<unsigned, std::string>> m_Specializations;
+		// file location -> key of the program for the current overrides.
+		static inline std::unordered_map<std::string, std::string> m_ProgramKeys;
+		// GPUBackend objects are short lived, the hazards have to outlive them.
+		static inline MemoryBarrierTracker m_Barriers;
+		// the immutable storage allocated for each texture by uploadImage
+		struct TextureStorage
+		{
+			GLenum internalFormat;
+			GLsizei width;
+			GLsizei height;
+			GLsizei depth;
+			bool operator==(const TextureStorage&) const = default;
+		};
+		static inline std::unordered_map<GLuint, TextureStorage> m_TextureStorage;
+		static inline ProgramBinaryCache m_BinaryCache{ "shadercache" };
+		static inline bool m_ParallelCompileChecked{ false };
+		// uniforms of all kernels stream through one ring buffered UBO.
+		static inline UniformRing m_UniformRing;
+		static inline ComputeShader* m_pCurrentShader{ nullptr };
+		// file location of the kernel of m_pCurrentShader.
+		static inline std::string m_CurrentKernel;
+		static inline tc::tuning::TuningSession m_Tuning{ "tuning/gpu.txt" };
+		static inline DispatchTimer m_Timer;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,170 @@
+#include "ProgramBinaryCache.hpp"
+#include <fstream>
+#include <iostream>
+#include <vector>
+#include <array>
+#include <cstdio>
+
+namespace {
+	constexpr std::array<char, 4> gMagic = { 'T','C','P','B' };
+	constexpr uint32_t gVersion = 1;
+
+	struct BinaryHeader {
+		std::array<char, 4> magic;
+		uint32_t version;
+		uint64_t sourceHash;
+		uint64_t driverHash;
+		uint32_t binaryFormat;
+		uint32_t binaryLength;
+	};
+
+	std::string glString(GLenum name)
+	{
+		const GLubyte* value = glGetString(name);
+		return value ? reinterpret_cast<const char*>(value) : "";
+	}
+
+	bool isSupportedFormat(GLenum binaryFormat)
+	{
+		GLint numFormats = 0;
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats);
+		std::vector<GLint> formats(numFormats);
+		if (numFormats > 0) {
+			glGetIntegerv(GL_PROGRAM_BINARY_FORMATS, formats.data());
+		}
+		for (GLint format : formats) {
+			if (static_cast<GLenum>(format) == binaryFormat) {
+				return true;
+			}
+		}
+		return false;
+	}
+}
+
+ProgramBinaryCache::ProgramBinaryCache(const std::filesystem::path& directory)
+	:m_Directory{ directory }
+{
+}
+
+bool ProgramBinaryCache::isEnabled() const
+{
+	if (!m_Enabled) {
+		return false;
+	}
+	GLint numFormats = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats);
+	return numFormats > 0;
+}
+
+uint64_t ProgramBinaryCache::hash(const std::string& text)
+{
+	// 64 bit FNV-1a
+	uint64_t h = 14695981039346656037ull;
+	for (unsigned char c : text) {
+		h ^= c;
+		h *= 1099511628211ull;
+	}
+	return h;
+}
+
+uint64_t ProgramBinaryCache::driverHash() const
+{
+	return hash(glString(GL_VENDOR) + "|" + glString(GL_RENDERER) + "|" + glString(GL_VERSION));
+}
+
+std::filesystem::path ProgramBinaryCache::entryPath(uint64_t sourceHash) const
+{
+	std::array<char, 17> name{};
+	std::snprintf(name.data(), name.size(), "%016llx", static_cast<unsigned long long>(sourceHash));
+	return m_Directory / (std::string(name.data()) + ".bin");
+}
+
+GLuint ProgramBinaryCache::load(const std::string& source) const
+{
+	if (!isEnabled()) {
+		return 0;
+	}
+	const uint64_t sourceHash = hash(source);
+	std::ifstream input{ entryPath(sourceHash), std::ios::binary };
+	if (!input.is_open()) {
+		return 0;
+	}
+
+	BinaryHeader header{};
+	input.read(reinterpret_cast<char*>(&header), sizeof(header));
+	if (!input
+		|| header.magic != gMagic
+		|| header.version != gVersion
+		|| header.sourceHash != sourceHash
+		|| header.driverHash != driverHash())
+	{
+		return 0;
+	}
+
+	// glProgramBinary raises GL_INVALID_ENUM for a format the driver no
+	// longer accepts.
+	if (!isSupportedFormat(header.binaryFormat)) {
+		return 0;
+	}
+
+	std::vector<char> binary(header.binaryLength);
+	input.read(binary.data(), binary.size());
+	if (!input) {
+		return 0;
+	}
+
+	GLuint program = glCreateProgram();
+	// clears an earlier error so the one after glProgramBinary is its own.
+	glGetError();
+	glProgramBinary(program, header.binaryFormat, binary.data(), static_cast<GLsizei>(binary.size()));
+	GLenum error = glGetError();
+
+	// the driver may reject a binary at any time, e.g. after an update.
+	GLint success = GL_FALSE;
+	glGetProgramiv(program, GL_LINK_STATUS, &success);
+	if (error != GL_NO_ERROR || !success) {
+		glDeleteProgram(program);
+		return 0;
+	}
+	return program;
+}
+
+void ProgramBinaryCache::store(const std::string& source, GLuint program) const
+{
+	if (!isEnabled()) {
+		return;
+	}
+	GLint length = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0) {
+		return;
+	}
+
+	std::vector<char> binary(length);
+	GLenum binaryFormat = 0;
+	glGetProgramBinary(program, length, nullptr, &binaryFormat, binary.data());
+
+	const uint64_t sourceHash = hash(source);
+	BinaryHeader header{ gMagic, gVersion, sourceHash, driverHash(),
+		static_cast<uint32_t>(binaryFormat), static_cast<uint32_t>(length) };
+
+	std::error_code ec;
+	std::filesystem::create_directories(m_Directory, ec);
+	std::filesystem::path path = entryPath(sourceHash);
+	std::filesystem::path tmpPath = path;
+	tmpPath += ".tmp";
+	{
+		std::ofstream output{ tmpPath, std::ios::binary | std::ios::trunc };
+		if (!output.is_open()) {
+			std::cerr << "Warning: could not write program binary " << tmpPath << "\n";
+			return;
+		}
+		output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		output.write(binary.data(), binary.size());
+	}
+	// rename, so a concurrent reader never sees a half written entry.
+	std::filesystem::rename(tmpPath, path, ec);
+	if (ec) {
+		std::filesystem::remove(tmpPath, ec);
+	}
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <string>
+#include <filesystem>
+#include <cstdint>
+#include "GL/glew.h"
+
+/*
+ * Persistent cache of linked program binaries (glGetProgramBinary / glProgramBinary).
+ *
+ * An entry is keyed by a hash of the shader source and a hash of the driver
+ * (vendor, renderer and version string), so a driver update or a changed kernel
+ * falls back to a normal source compile and refreshes the entry.
+ */
+class ProgramBinaryCache
+{
+public:
+	explicit ProgramBinaryCache(const std::filesystem::path& directory);
+
+	// Returns a linked program created from the cached binary, or 0 on a miss.
+	GLuint load(const std::string& source) const;
+	// Stores the binary of a linked program, the program must have been linked
+	// with GL_PROGRAM_BINARY_RETRIEVABLE_HINT set.
+	void store(const std::string& source, GLuint program) const;
+
+	void setDirectory(const std::filesystem::path& directory) {
+		m_Directory = directory;
+	}
+
+	const std::filesystem::path& getDirectory() const {
+		return m_Directory;
+	}
+
+	void setEnabled(bool enabled) {
+		m_Enabled = enabled;
+	}
+
+	// false when disabled or when the driver does not support any binary format.
+	bool isEnabled() const;
+
+private:
+	static uint64_t hash(const std::string& text);
+	uint64_t driverHash() const;
+	std::filesystem::path entryPath(uint64_t sourceHash) const;
+
+	std::filesystem::path m_Directory;
+	bool m_Enabled{ true };
+};
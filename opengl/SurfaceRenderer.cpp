@@ -5,6 +5,7 @@
 #include <stdexcept>
 #include <fstream>
 #include <sstream>
+#include <cstring> // memcpy
 
 SurfaceRenderer::SurfaceRenderer(GLuint w, GLuint h)
 	:
@@ -32,13 +33,28 @@ SurfaceRenderer::~SurfaceRenderer()
 	{
 		glDeleteBuffers(1, &m_VertexBufferObject);
 	}
+	for (GLsync& fence : m_PixelBufferFences) {
+		if (fence) {
+			glDeleteSync(fence);
+			fence = nullptr;
+		}
+	}
+	if (m_PixelBuffers[0] != 0)
+	{
+		glDeleteBuffers(static_cast<GLsizei>(m_PixelBuffers.size()), m_PixelBuffers.data());
+	}
 }
 
 void SurfaceRenderer::init()
 {
 	createShaderProgram();
-	
-	updateTexture();
+
+	// allocates the immutable storage of the texture, later frames only
+	// replace its texels.
+	tc::gpu::GPUBackend gpu;
+	gpu.uploadImage<tc::InternalFormat::RGBA8>(m_FullScreenImage);
+	m_TextureID = m_FullScreenImage.getSSBO_ID();
+	createPixelBuffers();
 	setupQuad();
 }
 
@@ -46,9 +62,86 @@ void SurfaceRenderer::updateTexture()
 {
 	if (m_FullScreenImage.isOnCPU())
 	{
-		tc::gpu::GPUBackend gpu;
-		gpu.uploadImage<tc::InternalFormat::RGBA8>(m_FullScreenImage);
+		streamTexture(m_FullScreenImage.data());
+		m_FullScreenImage.setBufferLocation(tc::BufferLocation::GPU);
+	}
+}
+
+void SurfaceRenderer::updateTexture(const RenderBuffer& frame)
+{
+	if (!tc::all(frame.getDimension() == m_FullScreenImage.getDimension())) {
+		throw std::runtime_error("SurfaceRenderer::updateTexture: the frame does not have the size of the texture.");
+	}
+	streamTexture(frame.data());
+}
+
+void SurfaceRenderer::swapRenderBuffer(RenderBuffer& frame)
+{
+	if (!tc::all(frame.getDimension() == m_FullScreenImage.getDimension())) {
+		throw std::runtime_error("SurfaceRenderer::swapRenderBuffer: the frame does not have the size of the render buffer.");
 	}
+	// a texture of the frame would be lost, the render buffer keeps its own.
+	if (frame.getSSBO_ID() != 0) {
+		throw std::runtime_error("SurfaceRenderer::swapRenderBuffer: the frame must not have a texture.");
+	}
+	const bool imageOnCPU = m_FullScreenImage.isOnCPU();
+	const bool frameOnCPU = frame.isOnCPU();
+	m_FullScreenImage.swap(frame);
+	m_FullScreenImage.setSSBO_ID(frame.getSSBO_ID());
+	frame.setSSBO_ID(0);
+	// where the pixels are up to date moves with them.
+	m_FullScreenImage.setBufferLocation(frameOnCPU ? tc::BufferLocation::CPU : tc::BufferLocation::GPU);
+	frame.setBufferLocation(imageOnCPU ? tc::BufferLocation::CPU : tc::BufferLocation::GPU);
+}
+
+void SurfaceRenderer::createPixelBuffers()
+{
+	const GLsizeiptr size = GLsizeiptr(m_Width) * m_Height * sizeof(tc::cpu::RGBA8UI);
+	glGenBuffers(static_cast<GLsizei>(m_PixelBuffers.size()), m_PixelBuffers.data());
+	for (GLuint pixelBuffer : m_PixelBuffers) {
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixelBuffer);
+		glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+	}
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+void SurfaceRenderer::streamTexture(const tc::cpu::RGBA8UI* pixels)
+{
+	using Traits = tc::gpu::GPUBackend::OpenGLExternalTraits<tc::cpu::RGBA8UI>;
+	const GLsizeiptr size = GLsizeiptr(m_Width) * m_Height * sizeof(tc::cpu::RGBA8UI);
+	const size_t index = m_NextPixelBuffer;
+	m_NextPixelBuffer = (m_NextPixelBuffer + 1) % m_PixelBuffers.size();
+
+	// the copy out of this buffer was issued PixelBufferCount frames ago and
+	// is normally done, the wait only blocks when the GPU falls behind.
+	GLsync& fence = m_PixelBufferFences[index];
+	if (fence) {
+		while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1'000'000) == GL_TIMEOUT_EXPIRED) {
+		}
+		glDeleteSync(fence);
+		fence = nullptr;
+	}
+
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_PixelBuffers[index]);
+	void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size,
+		GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+	if (!mapped) {
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		throw std::runtime_error("Failed to map the pixel unpack buffer.");
+	}
+	std::memcpy(mapped, pixels, size);
+	glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+	// the texels are copied from the bound unpack buffer, glTexSubImage2D
+	// returns without waiting for the copy.
+	tc::gpu::GPUBackend gpu;
+	gpu.prepareTextureUpdate(m_TextureID);
+	glBindTexture(GL_TEXTURE_2D, m_TextureID);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, m_Width, m_Height, Traits::format, Traits::type, nullptr);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+	fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
 }
 
 void SurfaceRenderer::createShaderProgram()
@@ -99,11 +192,14 @@ void SurfaceRenderer::setupQuad()
 
 void SurfaceRenderer::drawQuadWithTexture()
 {
+	tc::gpu::GPUBackend gpu;
+	gpu.prepareTextureFetch(m_TextureID);
+
 	glUseProgram(m_ProgramID);
 	glUniform1i(m_screenTextureLoc, 0);
 
 	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, m_FullScreenImage.getSSBO_ID());
+	glBindTexture(GL_TEXTURE_2D, m_TextureID);
 
 	// Draw the quad
 	glBindVertexArray(m_VertexArrayObject);
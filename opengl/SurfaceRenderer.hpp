@@ -2,6 +2,7 @@
 
 #include "GL/glew.h"
 #include <string_view>
+#include <array>
 #include <computebackend.hpp>
 #include <vec.hpp>
 #include <images/ImageFormat.hpp>
@@ -39,6 +40,8 @@ class SurfaceRenderer
 {
 
 public:
+    using RenderBuffer = tc::BufferResource<tc::cpu::RGBA8UI, tc::Dim::D2>;
+
 	SurfaceRenderer(GLuint width, GLuint height);
     ~SurfaceRenderer();
 
@@ -52,14 +55,25 @@ public:
     SurfaceRenderer& operator=(SurfaceRenderer&&) = delete;
 
     void init();
+    // Brings the texture up to date with the render buffer. An image that a
+    // GPU kernel wrote is already in the texture and is drawn as is, a frame
+    // of the CPU streams through a ring of pixel unpack buffers.
     void updateTexture();
+    // Streams a frame that was computed on the CPU into the texture, the
+    // render buffer is left as it is. Throws when the frame has another size.
+    void updateTexture(const RenderBuffer& frame);
     void drawQuadWithTexture();
 
-    tc::BufferResource<tc::cpu::RGBA8UI, tc::Dim::D2>* getRenderBuffer() 
+    RenderBuffer* getRenderBuffer() 
     {
         return &m_FullScreenImage;
     }
 
+    // Exchanges the pixels of the render buffer with those of frame, without
+    // a copy, along with where they are up to date. The texture stays with
+    // the render buffer, frame must have the same size and no texture.
+    void swapRenderBuffer(RenderBuffer& frame);
+
     GLuint getWidth() const {
         return m_Width;
     }
@@ -71,6 +85,8 @@ private:
     GLuint compileShader(const std::string_view& shaderSource, GLenum shaderType) const;
     void createShaderProgram();
     void setupQuad();
+    void createPixelBuffers();
+    void streamTexture(const tc::cpu::RGBA8UI* pixels);
     GLint m_screenTextureLoc{ 0 };
 
     std::array<float,24> quadVertices = {
@@ -86,10 +102,20 @@ private:
 
     GLuint m_Width;
     GLuint m_Height;
-    tc::BufferResource<tc::cpu::RGBA8UI, tc::Dim::D2> m_FullScreenImage;
+    RenderBuffer m_FullScreenImage;
+    // the texture of the render buffer, kept apart so drawing does not read
+    // the render buffer while a frame is computed into it.
+    GLuint m_TextureID{ 0 };
 
     // To release in destructor.
     GLuint m_ProgramID;
     GLuint m_VertexArrayObject;
     GLuint m_VertexBufferObject;
+
+    // the copy out of a pixel buffer runs while the next frames are computed,
+    // its fence is waited for before the buffer is written again.
+    static constexpr size_t PixelBufferCount = 3;
+    std::array<GLuint, PixelBufferCount> m_PixelBuffers{};
+    std::array<GLsync, PixelBufferCount> m_PixelBufferFences{};
+    size_t m_NextPixelBuffer{ 0 };
 };
\ No newline at end of file
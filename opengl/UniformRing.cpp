@@ -0,0 +1,44 @@
+#include "UniformRing.hpp"
+
+namespace tc::gpu {
+
+	UniformRing::~UniformRing()
+	{
+		if (m_BufferID != 0) {
+			glDeleteBuffers(1, &m_BufferID);
+			m_BufferID = 0;
+		}
+	}
+
+	void UniformRing::create()
+	{
+		glGenBuffers(1, &m_BufferID);
+		glBindBuffer(GL_UNIFORM_BUFFER, m_BufferID);
+		glBufferData(GL_UNIFORM_BUFFER, m_Capacity, nullptr, GL_STREAM_DRAW);
+		glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &m_Alignment);
+		m_Offset = 0;
+	}
+
+	void UniformRing::bind(GLuint binding, const void* data, GLsizeiptr size)
+	{
+		if (m_BufferID == 0) {
+			create();
+		}
+		else {
+			glBindBuffer(GL_UNIFORM_BUFFER, m_BufferID);
+		}
+
+		GLintptr offset = (m_Offset + m_Alignment - 1) / m_Alignment * m_Alignment;
+		if (offset + size > m_Capacity) {
+			// orphan the storage, the driver keeps the old one alive for
+			// the dispatches that still read from it.
+			glBufferData(GL_UNIFORM_BUFFER, m_Capacity, nullptr, GL_STREAM_DRAW);
+			offset = 0;
+		}
+		glBufferSubData(GL_UNIFORM_BUFFER, offset, size, data);
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+		glBindBufferRange(GL_UNIFORM_BUFFER, binding, m_BufferID, offset, size);
+		m_Offset = offset + size;
+	}
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "GL/glew.h"
+
+namespace tc::gpu {
+
+	/*
+	 * Streams uniform block data into one uniform buffer.
+	 *
+	 * Every upload goes to the next aligned range of the buffer, so a dispatch
+	 * that is still in flight keeps reading its own range. When the buffer is
+	 * full it is orphaned and the ring starts over at offset 0.
+	 */
+	class UniformRing
+	{
+	public:
+		UniformRing() = default;
+		~UniformRing();
+
+		UniformRing(const UniformRing&) = delete;
+		UniformRing& operator=(const UniformRing&) = delete;
+
+		// Uploads size bytes and binds the range to the uniform block binding.
+		void bind(GLuint binding, const void* data, GLsizeiptr size);
+
+	private:
+		void create();
+
+		GLuint m_BufferID{ 0 };
+		GLsizeiptr m_Capacity{ 64 * 1024 };
+		GLintptr m_Offset{ 0 };
+		GLint m_Alignment{ 256 };
+	};
+}
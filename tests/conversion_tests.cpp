@@ -0,0 +1,147 @@
+// conversion_tests.cpp
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "vec.hpp"
+#include "kernel_intrinsics.hpp"
+#include "images/PixelConversion.hpp"
+
+TEST(PixelConversionTest, BytesAndFloats)
+{
+	// odd counts so the vector loops and the scalar tail both run.
+	std::vector<uint8_t> bytes(301);
+	for (size_t i = 0; i < bytes.size(); ++i) {
+		bytes[i] = static_cast<uint8_t>(i * 7);
+	}
+	std::vector<float> floats(bytes.size());
+	tc::convert::u8ToF32(bytes.data(), floats.data(), bytes.size());
+	for (size_t i = 0; i < bytes.size(); ++i) {
+		ASSERT_EQ(floats[i], (tc::ChannelConverter<uint8_t, float>::apply(bytes[i])));
+	}
+
+	std::mt19937 random{ 3 };
+	std::uniform_real_distribution<float> range{ -0.5f, 1.5f };
+	for (float& f : floats) {
+		f = range(random);
+	}
+	tc::convert::f32ToU8(floats.data(), bytes.data(), floats.size());
+	for (size_t i = 0; i < floats.size(); ++i) {
+		ASSERT_EQ(bytes[i], (tc::ChannelConverter<float, uint8_t>::apply(floats[i])));
+	}
+}
+
+TEST(PixelConversionTest, HalfsAndFloats)
+{
+	std::mt19937 random{ 5 };
+	std::uniform_real_distribution<float> range{ -70000.0f, 70000.0f };
+	std::vector<float> floats(157);
+	for (float& f : floats) {
+		f = range(random) * (random() % 2 ? 1.0f : 1.0e-6f);
+	}
+	std::vector<tc::half> halfs(floats.size());
+	tc::convert::f32ToF16(floats.data(), halfs.data(), floats.size());
+	for (size_t i = 0; i < floats.size(); ++i) {
+		ASSERT_EQ(halfs[i].bits, tc::half(floats[i]).bits);
+	}
+
+	std::vector<float> back(floats.size());
+	tc::convert::f16ToF32(halfs.data(), back.data(), halfs.size());
+	for (size_t i = 0; i < floats.size(); ++i) {
+		ASSERT_EQ(back[i], float(halfs[i]));
+	}
+}
+
+TEST(PixelConversionTest, ExpandShrinkAndSwizzle)
+{
+	const size_t pixels = 19;
+	std::vector<uint8_t> rgb(pixels * 3);
+	for (size_t i = 0; i < rgb.size(); ++i) {
+		rgb[i] = static_cast<uint8_t>(i);
+	}
+	std::vector<uint8_t> rgba(pixels * 4);
+	tc::convert::expandRGBToRGBA(rgb.data(), rgba.data(), pixels, uint8_t{ 200 });
+	for (size_t p = 0; p < pixels; ++p) {
+		ASSERT_EQ(rgba[4 * p + 0], rgb[3 * p + 0]);
+		ASSERT_EQ(rgba[4 * p + 1], rgb[3 * p + 1]);
+		ASSERT_EQ(rgba[4 * p + 2], rgb[3 * p + 2]);
+		ASSERT_EQ(rgba[4 * p + 3], 200);
+	}
+
+	std::vector<uint8_t> shrunk(pixels * 3);
+	tc::convert::shrinkRGBAToRGB(rgba.data(), shrunk.data(), pixels);
+	EXPECT_EQ(shrunk, rgb);
+
+	std::vector<uint8_t> bgra = rgba;
+	tc::convert::swizzleBGRA(bgra.data(), bgra.data(), pixels);
+	for (size_t p = 0; p < pixels; ++p) {
+		ASSERT_EQ(bgra[4 * p + 0], rgba[4 * p + 2]);
+		ASSERT_EQ(bgra[4 * p + 1], rgba[4 * p + 1]);
+		ASSERT_EQ(bgra[4 * p + 2], rgba[4 * p + 0]);
+		ASSERT_EQ(bgra[4 * p + 3], rgba[4 * p + 3]);
+	}
+}
+
+TEST(PixelConversionTest, ConvertPixels)
+{
+	// RGB bytes to RGBA floats, the missing alpha becomes 1.
+	std::vector<tc::cpu::RGB8> rgb(37);
+	for (size_t i = 0; i < rgb.size(); ++i) {
+		rgb[i] = tc::cpu::RGB8{ uint8_t(i), uint8_t(255 - i), uint8_t(3 * i) };
+	}
+	std::vector<tc::cpu::RGBA32F> rgba(rgb.size());
+	tc::convert::convertPixels(rgb.data(), rgba.data(), rgb.size());
+	using toFloat = tc::ChannelConverter<uint8_t, float>;
+	for (size_t i = 0; i < rgb.size(); ++i) {
+		ASSERT_EQ(rgba[i].get<tc::Channel::R>(), toFloat::apply(uint8_t(i)));
+		ASSERT_EQ(rgba[i].get<tc::Channel::G>(), toFloat::apply(uint8_t(255 - i)));
+		ASSERT_EQ(rgba[i].get<tc::Channel::B>(), toFloat::apply(uint8_t(3 * i)));
+		ASSERT_EQ(rgba[i].get<tc::Channel::A>(), 1.0f);
+	}
+
+	// and to halfs and a packed format, then back.
+	std::vector<tc::cpu::RGBA16F> halfs(rgba.size());
+	tc::convert::convertPixels(rgba.data(), halfs.data(), rgba.size());
+	std::vector<tc::cpu::RGB10A2> packed(rgba.size());
+	tc::convert::convertPixels(halfs.data(), packed.data(), halfs.size());
+	std::vector<tc::cpu::RGB8> back(rgba.size());
+	tc::convert::convertPixels(packed.data(), back.data(), packed.size());
+	for (size_t i = 0; i < rgb.size(); ++i) {
+		ASSERT_EQ(back[i].get<tc::Channel::R>(), rgb[i].get<tc::Channel::R>());
+		ASSERT_EQ(back[i].get<tc::Channel::G>(), rgb[i].get<tc::Channel::G>());
+		ASSERT_EQ(back[i].get<tc::Channel::B>(), rgb[i].get<tc::Channel::B>());
+	}
+}
+
+TEST(PixelConversionTest, ImageRows)
+{
+	tc::BufferResource<tc::cpu::RGBA8, tc::Dim::D2> buffer{ tc::ivec2{ 40, 3 } };
+	tc::ImageBinding<tc::InternalFormat::RGBA8, tc::Dim::D2, tc::cpu::RGBA8, 0> image;
+	image.attach(&buffer);
+
+	std::vector<tc::vec4> values(33);
+	for (size_t i = 0; i < values.size(); ++i) {
+		values[i] = tc::vec4{ i / 33.0f, 0.5f, 1.2f, -0.1f * i };
+	}
+	tc::imageStoreRow(image, tc::ivec2{ 5, 1 }, std::span<const tc::vec4>{ values });
+
+	tc::BufferResource<tc::cpu::RGBA8, tc::Dim::D2> expected{ tc::ivec2{ 40, 3 } };
+	tc::ImageBinding<tc::InternalFormat::RGBA8, tc::Dim::D2, tc::cpu::RGBA8, 0> reference;
+	reference.attach(&expected);
+	for (size_t i = 0; i < values.size(); ++i) {
+		tc::imageStore(reference, tc::ivec2{ 5 + int(i), 1 }, values[i]);
+	}
+
+	std::vector<tc::vec4> loaded(values.size());
+	tc::imageLoadRow(image, tc::ivec2{ 5, 1 }, std::span<tc::vec4>{ loaded });
+	for (size_t i = 0; i < values.size(); ++i) {
+		tc::vec4 one = tc::imageLoad(reference, tc::ivec2{ 5 + int(i), 1 });
+		ASSERT_EQ(loaded[i].x, one.x);
+		ASSERT_EQ(loaded[i].y, one.y);
+		ASSERT_EQ(loaded[i].z, one.z);
+		ASSERT_EQ(loaded[i].w, one.w);
+	}
+}
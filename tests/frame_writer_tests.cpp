@@ -0,0 +1,267 @@
+// frame_writer_tests.cpp
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "vec.hpp"
+#include "kernel_intrinsics.hpp"
+#include "computebackend.hpp"
+#include "FrameWriter.h"
+
+namespace {
+	std::vector<uint8_t> readFile(const std::filesystem::path& path)
+	{
+		std::ifstream file{ path, std::ios::binary };
+		return { std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+	}
+
+	std::string text(const std::vector<uint8_t>& bytes, size_t count)
+	{
+		return std::string(bytes.begin(), bytes.begin() + std::min(count, bytes.size()));
+	}
+
+	uint32_t bigEndian(const uint8_t* p)
+	{
+		return uint32_t(p[0]) << 24 | uint32_t(p[1]) << 16 | uint32_t(p[2]) << 8 | p[3];
+	}
+
+	// straight from the QOI specification.
+	std::vector<uint8_t> decodeQOI(const std::vector<uint8_t>& bytes, tc::ivec2& size)
+	{
+		size = tc::ivec2{ int(bigEndian(&bytes[4])), int(bigEndian(&bytes[8])) };
+		std::vector<uint8_t> rgba(size_t(size.x) * size.y * 4);
+		uint8_t index[64][4]{};
+		uint8_t px[4]{ 0, 0, 0, 255 };
+		size_t p = 14;
+		int run = 0;
+		for (size_t i = 0; i < rgba.size(); i += 4) {
+			if (run > 0) {
+				--run;
+			}
+			else {
+				const uint8_t b = bytes[p++];
+				if (b == 0xfe) {
+					px[0] = bytes[p++]; px[1] = bytes[p++]; px[2] = bytes[p++];
+				}
+				else if (b == 0xff) {
+					px[0] = bytes[p++]; px[1] = bytes[p++]; px[2] = bytes[p++]; px[3] = bytes[p++];
+				}
+				else if ((b & 0xc0) == 0x00) {
+					std::copy(index[b], index[b] + 4, px);
+				}
+				else if ((b & 0xc0) == 0x40) {
+					px[0] += ((b >> 4) & 3) - 2;
+					px[1] += ((b >> 2) & 3) - 2;
+					px[2] += (b & 3) - 2;
+				}
+				else if ((b & 0xc0) == 0x80) {
+					const int dg = (b & 0x3f) - 32;
+					const uint8_t b2 = bytes[p++];
+					px[0] += dg - 8 + ((b2 >> 4) & 0x0f);
+					px[1] += dg;
+					px[2] += dg - 8 + (b2 & 0x0f);
+				}
+				else {
+					run = b & 0x3f;
+				}
+				std::copy(px, px + 4, index[(px[0] * 3 + px[1] * 5 + px[2] * 7 + px[3] * 11) % 64]);
+			}
+			std::copy(px, px + 4, &rgba[i]);
+		}
+		return rgba;
+	}
+
+	using Frame = tc::BufferResource<tc::cpu::RGBA8UI, tc::Dim::D2>;
+
+	Frame solidFrame(tc::ivec2 size, uint8_t gray)
+	{
+		Frame frame{ size };
+		for (size_t i = 0; i < frame.size(); ++i) {
+			frame.data()[i] = tc::cpu::RGBA8UI{ gray, gray, gray, 255 };
+		}
+		return frame;
+	}
+}
+
+TEST(FrameWriterTest, EncodePPMAndPAM)
+{
+	const std::vector<uint8_t> rgba{ 1, 2, 3, 4, 5, 6, 7, 8 };
+	std::vector<uint8_t> out;
+	tc::assets::encodePPM(rgba.data(), tc::ivec2{ 2, 1 }, out);
+	const std::string ppmHeader = "P6\n2 1\n255\n";
+	ASSERT_EQ(text(out, ppmHeader.size()), ppmHeader);
+	EXPECT_EQ(std::vector<uint8_t>(out.begin() + ppmHeader.size(), out.end()),
+		(std::vector<uint8_t>{ 1, 2, 3, 5, 6, 7 }));
+
+	tc::assets::encodePAM(rgba.data(), tc::ivec2{ 1, 2 }, out);
+	const std::string pamHeader = "P7\nWIDTH 1\nHEIGHT 2\nDEPTH 4\nMAXVAL 255\nTUPLTYPE RGB_ALPHA\nENDHDR\n";
+	ASSERT_EQ(text(out, pamHeader.size()), pamHeader);
+	EXPECT_EQ(std::vector<uint8_t>(out.begin() + pamHeader.size(), out.end()), rgba);
+}
+
+TEST(FrameWriterTest, QOIRoundTrip)
+{
+	// runs, small and luma differences, recurring colors and alpha changes.
+	const tc::ivec2 size{ 37, 11 };
+	std::vector<uint8_t> rgba(size_t(size.x) * size.y * 4);
+	for (int y = 0; y < size.y; ++y) {
+		for (int x = 0; x < size.x; ++x) {
+			uint8_t* px = &rgba[(size_t(y) * size.x + x) * 4];
+			const bool flat = x < 20 && y < 4;
+			px[0] = flat ? 10 : uint8_t(x * 3 + y);
+			px[1] = flat ? 20 : uint8_t(x * 5 - y * 9);
+			px[2] = flat ? 30 : uint8_t((x % 4) * 60);
+			px[3] = (x + y) % 7 == 0 ? 128 : 255;
+		}
+	}
+	std::vector<uint8_t> out;
+	tc::assets::encodeQOI(rgba.data(), size, out);
+	ASSERT_EQ(text(out, 4), "qoif");
+	EXPECT_EQ(out[12], 4);
+	EXPECT_EQ(std::vector<uint8_t>(out.end() - 8, out.end()), (std::vector<uint8_t>{ 0, 0, 0, 0, 0, 0, 0, 1 }));
+	EXPECT_LT(out.size(), rgba.size());
+
+	tc::ivec2 decodedSize;
+	EXPECT_EQ(decodeQOI(out, decodedSize), rgba);
+	EXPECT_EQ(decodedSize.x, size.x);
+	EXPECT_EQ(decodedSize.y, size.y);
+}
+
+TEST(FrameWriterTest, Y4MFrame)
+{
+	// 3x3 has smaller chroma blocks at the right and bottom edge.
+	std::vector<uint8_t> rgba(3 * 3 * 4, 255);
+	rgba[0] = 255; rgba[1] = 0; rgba[2] = 0;
+	std::vector<uint8_t> out;
+	tc::assets::encodeY4MFrame(rgba.data(), tc::ivec2{ 3, 3 }, out);
+	ASSERT_EQ(out.size(), 6u + 9u + 2u * 4u);
+	EXPECT_EQ(text(out, 6), "FRAME\n");
+	const uint8_t* y = out.data() + 6;
+	const uint8_t* u = y + 9;
+	const uint8_t* v = u + 4;
+	// full range: white is 255, red is 77/256 of it.
+	EXPECT_EQ(y[0], 77);
+	EXPECT_EQ(y[8], 255);
+	EXPECT_EQ(u[3], 128);
+	EXPECT_EQ(v[3], 128);
+	// the first block averages one red and three white pixels.
+	EXPECT_GT(v[0], 128);
+	EXPECT_LT(u[0], 128);
+}
+
+TEST(FrameWriterTest, Y4MStreamKeepsOrder)
+{
+	const std::filesystem::path directory = std::filesystem::temp_directory_path() / "tc_frame_writer_order";
+	std::filesystem::remove_all(directory);
+	const tc::ivec2 size{ 4, 2 };
+	const int frames = 24;
+	{
+		tc::assets::FrameWriter writer{ { directory, "stream", tc::assets::FrameFormat::Y4M, 4, 4, 25 } };
+		for (int i = 0; i < frames; ++i) {
+			writer.submit(solidFrame(size, uint8_t(i * 10)));
+		}
+		writer.finish();
+		EXPECT_EQ(writer.getFrameCount(), uint64_t(frames));
+	}
+
+	const std::vector<uint8_t> bytes = readFile(directory / "stream.y4m");
+	const std::string header = "YUV4MPEG2 W4 H2 F25:1 Ip A1:1 C420jpeg XCOLORRANGE=FULL\n";
+	ASSERT_EQ(text(bytes, header.size()), header);
+	const size_t frameSize = 6 + 8 + 2 * 2;
+	ASSERT_EQ(bytes.size(), header.size() + frames * frameSize);
+	for (int i = 0; i < frames; ++i) {
+		const uint8_t* frame = bytes.data() + header.size() + i * frameSize;
+		ASSERT_EQ(std::string(frame, frame + 6), "FRAME\n");
+		EXPECT_EQ(frame[6], uint8_t(i * 10)) << "frame " << i;
+	}
+	std::filesystem::remove_all(directory);
+}
+
+TEST(FrameWriterTest, Y4MStreamReportsBadFrame)
+{
+	const std::filesystem::path directory = std::filesystem::temp_directory_path() / "tc_frame_writer_error";
+	std::filesystem::remove_all(directory);
+	const tc::ivec2 size{ 2, 2 };
+	int errors = 0;
+	{
+		tc::assets::FrameWriter writer{ { directory, "stream", tc::assets::FrameFormat::Y4M, 4, 2, 30 } };
+		// a submit throws when a worker already failed, then the last frame
+		// is not queued.
+		int submitted = 0;
+		for (const Frame& frame : { solidFrame(size, 10), solidFrame(tc::ivec2{ 4, 4 }, 20), solidFrame(size, 30) }) {
+			try {
+				writer.submit(frame);
+				++submitted;
+			}
+			catch (const std::runtime_error&) {
+				++errors;
+			}
+		}
+		try {
+			writer.finish();
+		}
+		catch (const std::runtime_error&) {
+			++errors;
+		}
+		// the error is reported once.
+		EXPECT_NO_THROW(writer.finish());
+		EXPECT_GE(submitted, 2);
+	}
+	EXPECT_EQ(errors, 1);
+
+	// the frames after the bad one still take their turn.
+	const std::vector<uint8_t> bytes = readFile(directory / "stream.y4m");
+	const size_t header = std::string("YUV4MPEG2 W2 H2 F30:1 Ip A1:1 C420jpeg XCOLORRANGE=FULL\n").size();
+	const size_t frameSize = 6 + 4 + 2;
+	ASSERT_GE(bytes.size(), header + frameSize);
+	ASSERT_EQ((bytes.size() - header) % frameSize, 0u);
+	EXPECT_EQ(bytes[header + 6], 10);
+	if (bytes.size() > header + frameSize) {
+		EXPECT_EQ(bytes[header + frameSize + 6], 30);
+	}
+	std::filesystem::remove_all(directory);
+}
+
+TEST(FrameWriterTest, WritesNumberedFiles)
+{
+	const std::filesystem::path directory = std::filesystem::temp_directory_path() / "tc_frame_writer_files";
+	std::filesystem::remove_all(directory);
+	{
+		tc::assets::FrameWriter writer{ { directory, "shot", tc::assets::FrameFormat::QOI, 2, 2 } };
+		for (int i = 0; i < 3; ++i) {
+			writer.submit(solidFrame(tc::ivec2{ 5, 3 }, uint8_t(i)));
+		}
+		writer.finish();
+	}
+	for (int i = 0; i < 3; ++i) {
+		const std::filesystem::path path = directory / ("shot_00000" + std::to_string(i) + ".qoi");
+		ASSERT_TRUE(std::filesystem::exists(path));
+		tc::ivec2 size;
+		const std::vector<uint8_t> rgba = decodeQOI(readFile(path), size);
+		EXPECT_EQ(size.x, 5);
+		EXPECT_EQ(rgba[0], uint8_t(i));
+	}
+	std::filesystem::remove_all(directory);
+}
+
+TEST(FrameWriterTest, SubmitsThroughTheBackend)
+{
+	const std::filesystem::path directory = std::filesystem::temp_directory_path() / "tc_frame_writer_backend";
+	std::filesystem::remove_all(directory);
+	{
+		tc::CPUBackend cpu;
+		Frame frame = solidFrame(tc::ivec2{ 3, 2 }, 42);
+		tc::assets::FrameWriter writer{ { directory, "cpu", tc::assets::FrameFormat::PAM, 2, 1 } };
+		writer.submit(cpu, frame);
+		writer.finish();
+	}
+	const std::vector<uint8_t> bytes = readFile(directory / "cpu_000000.pam");
+	ASSERT_EQ(bytes.size(), std::string("P7\nWIDTH 3\nHEIGHT 2\nDEPTH 4\nMAXVAL 255\nTUPLTYPE RGB_ALPHA\nENDHDR\n").size() + 3 * 2 * 4);
+	EXPECT_EQ(bytes[bytes.size() - 4], 42);
+	std::filesystem::remove_all(directory);
+}
@@ -0,0 +1,280 @@
+// gameoflife_tests.cpp
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "vec.hpp"
+#include "computebackend.hpp"
+#include "GameOfLife/Step06_BitPacked/BitKernel.hpp"
+#include "GameOfLife/Step06_BitPacked/GameOfLife.h"
+#include "GameOfLife/Step07_HashLife/HashLife.hpp"
+#include "GameOfLife/Step08_SparseTiles/SparseKernel.hpp"
+
+namespace {
+	// The reference: one byte per cell, the cells outside the grid are dead.
+	class NaiveLife
+	{
+	public:
+		NaiveLife(int w, int h)
+			:m_Width{ w }, m_Height{ h }, m_Cells(size_t(w) * h, 0)
+		{
+		}
+
+		void set(int x, int y) {
+			m_Cells[size_t(y) * m_Width + x] = 1;
+		}
+
+		bool get(int x, int y) const {
+			return x >= 0 && y >= 0 && x < m_Width && y < m_Height && m_Cells[size_t(y) * m_Width + x];
+		}
+
+		void step(uint64_t generations = 1) {
+			std::vector<uint8_t> next(m_Cells.size());
+			for (uint64_t g = 0; g < generations; ++g) {
+				for (int y = 0; y < m_Height; ++y) {
+					for (int x = 0; x < m_Width; ++x) {
+						int n = 0;
+						for (int dy = -1; dy <= 1; ++dy) {
+							for (int dx = -1; dx <= 1; ++dx) {
+								n += (dx != 0 || dy != 0) && get(x + dx, y + dy);
+							}
+						}
+						next[size_t(y) * m_Width + x] = n == 3 || (n == 2 && get(x, y));
+					}
+				}
+				std::swap(m_Cells, next);
+			}
+		}
+
+		uint64_t population() const {
+			uint64_t count = 0;
+			for (uint8_t c : m_Cells) {
+				count += c;
+			}
+			return count;
+		}
+
+		int width() const {
+			return m_Width;
+		}
+
+		int height() const {
+			return m_Height;
+		}
+
+	private:
+		int m_Width;
+		int m_Height;
+		std::vector<uint8_t> m_Cells;
+	};
+
+	// the R-pentomino and a glider, the glider leaves the area of the
+	// R-pentomino.
+	template<typename Set>
+	void seedPatterns(Set set, int x, int y)
+	{
+		set(x + 1, y); set(x + 2, y); set(x, y + 1); set(x + 1, y + 1); set(x + 1, y + 2);
+		set(x + 21, y + 20); set(x + 22, y + 21); set(x + 20, y + 22); set(x + 21, y + 22); set(x + 22, y + 22);
+	}
+
+	// a grid that the patterns do not reach in 256 generations, the HashLife
+	// universe is unbounded. Cell (0, 0) of HashLife is the centre of the grid.
+	constexpr int Half = 256;
+
+	void expectSameUniverse(const GameOfLife::HashLife& life, const NaiveLife& reference)
+	{
+		ASSERT_EQ(life.getPopulation(), reference.population());
+		for (int y = 0; y < reference.height(); ++y) {
+			for (int x = 0; x < reference.width(); ++x) {
+				ASSERT_EQ(life.get(x - Half, y - Half), reference.get(x, y))
+					<< "cell " << x - Half << ", " << y - Half << " in generation " << life.getGeneration();
+			}
+		}
+	}
+
+	void checkHashLife(bool collectGarbage)
+	{
+		GameOfLife::HashLife life;
+		NaiveLife reference{ 2 * Half, 2 * Half };
+		seedPatterns([&](int x, int y) { life.set0(x, y); }, -10, -10);
+		seedPatterns([&](int x, int y) { reference.set(x + Half, y + Half); }, -10, -10);
+		if (collectGarbage) {
+			// step collects garbage every time.
+			life.setNodeLimit(0);
+		}
+		// a change of the step size drops the cached results.
+		for (unsigned log2Generations : { 0u, 0u, 2u, 5u, 2u, 7u }) {
+			life.step(log2Generations);
+			reference.step(uint64_t{ 1 } << log2Generations);
+			if (collectGarbage) {
+				life.collectGarbage();
+			}
+			expectSameUniverse(life, reference);
+		}
+		EXPECT_EQ(life.getGeneration(), 1u + 1u + 4u + 32u + 4u + 128u);
+	}
+
+	NaiveLife randomSoup(int w, int h, unsigned seed)
+	{
+		NaiveLife life{ w, h };
+		std::mt19937 random{ seed };
+		for (int y = 0; y < h; ++y) {
+			for (int x = 0; x < w; ++x) {
+				if (random() % 3 == 0) {
+					life.set(x, y);
+				}
+			}
+		}
+		return life;
+	}
+
+	GameOfLife::BitKernel bitKernelOf(const NaiveLife& life)
+	{
+		GameOfLife::BitKernel kernel{ size_t(life.width()), size_t(life.height()) };
+		for (int y = 0; y < life.height(); ++y) {
+			for (int x = 0; x < life.width(); ++x) {
+				if (life.get(x, y)) {
+					kernel.set0(x, y);
+				}
+			}
+		}
+		return kernel;
+	}
+
+	void expectSameCells(const GameOfLife::BitKernel& kernel, const NaiveLife& reference)
+	{
+		for (int y = 0; y < reference.height(); ++y) {
+			for (int x = 0; x < reference.width(); ++x) {
+				ASSERT_EQ(kernel.get1(x, y), uint32_t(reference.get(x, y))) << "cell " << x << ", " << y;
+			}
+		}
+	}
+}
+
+TEST(GameOfLifeTest, HashLifeMatchesNaiveStepping)
+{
+	checkHashLife(false);
+}
+
+TEST(GameOfLifeTest, HashLifeMatchesNaiveSteppingAfterGarbageCollection)
+{
+	checkHashLife(true);
+}
+
+TEST(GameOfLifeTest, HashLifeRendersUnalignedViewports)
+{
+	GameOfLife::HashLife life;
+	NaiveLife reference{ 2 * Half, 2 * Half };
+	seedPatterns([&](int x, int y) { life.set0(x, y); }, -10, -10);
+	seedPatterns([&](int x, int y) { reference.set(x + Half, y + Half); }, -10, -10);
+	life.step(5);
+	reference.step(32);
+
+	// a pixel is 1 when any of its cells lives, also when the viewport does
+	// not start on a multiple of the pixel size.
+	GameOfLife::HashLife::Image image{ tc::ivec2{ 24, 24 } };
+	for (unsigned log2Scale : { 0u, 1u, 2u }) {
+		for (int64_t origin : { int64_t{ -40 }, int64_t{ -37 }, int64_t{ -35 } }) {
+			life.render(image, origin, origin, log2Scale);
+			int scale = 1 << log2Scale;
+			for (int py = 0; py < 24; ++py) {
+				for (int px = 0; px < 24; ++px) {
+					bool alive = false;
+					for (int y = 0; y < scale; ++y) {
+						for (int x = 0; x < scale; ++x) {
+							alive = alive || reference.get(int(origin) + px * scale + x + Half, int(origin) + py * scale + y + Half);
+						}
+					}
+					ASSERT_EQ((image[tc::ivec2{ px, py }].get<tc::Channel::R>()), uint32_t(alive))
+						<< "pixel " << px << ", " << py << " at scale " << scale << " from " << origin;
+				}
+			}
+		}
+	}
+}
+
+TEST(GameOfLifeTest, BitKernelMatchesNaiveStepping)
+{
+	// neither a multiple of 64 cells nor of the tiles of stepMany.
+	NaiveLife reference = randomSoup(150, 70, 7);
+	GameOfLife::BitKernel kernel = bitKernelOf(reference);
+	for (int generation = 0; generation < 8; ++generation) {
+		kernel.dispatch();
+		reference.step();
+		expectSameCells(kernel, reference);
+		kernel.swapBuffers();
+	}
+
+	GameOfLife::BitKernel blocked = bitKernelOf(reference);
+	blocked.stepMany(13);
+	reference.step(13);
+	expectSameCells(blocked, reference);
+}
+
+TEST(GameOfLifeTest, BitPackedKernelMatchesNaiveStepping)
+{
+	// 100 cells are 4 uints per row, the dispatch is rounded up to a group
+	// of 64 like on the GPU.
+	NaiveLife reference = randomSoup(100, 20, 11);
+	GameOfLife::BitKernel engine = bitKernelOf(reference);
+	const std::span<const uint64_t> state = engine.getState0();
+
+	const tc::integer uints = static_cast<tc::integer>(2 * state.size());
+	tc::BufferResource<tc::uint> in{ uints };
+	tc::BufferResource<tc::uint> out{ uints };
+	std::memcpy(in.data(), state.data(), state.size_bytes());
+	std::memset(out.data(), 0, out.size() * sizeof(tc::uint));
+
+	BitPackedKernel kernel;
+	kernel.inData.attach(&in);
+	kernel.outData.attach(&out);
+	kernel.stride = static_cast<tc::integer>(2 * engine.getStride());
+	kernel.width = reference.width();
+
+	tc::CPUBackend backend{ tc::ExecutionPolicy::Seq };
+	for (int generation = 0; generation < 4; ++generation) {
+		backend.execute(kernel, tc::uvec3{ 64u, tc::uint(reference.height()), 1u });
+		reference.step();
+		const tc::BufferResource<tc::uint>& result = *kernel.outData.getBufferData();
+		for (int y = 0; y < reference.height(); ++y) {
+			// the padding stays zero.
+			const tc::integer row = (y + 1) * kernel.stride;
+			ASSERT_EQ((result[row]), 0u);
+			ASSERT_EQ((result[row + 1]), 0u);
+			ASSERT_EQ((result[row + 2 + 4]), 0u);
+			for (int x = 0; x < reference.width(); ++x) {
+				const tc::uint word = result[row + 2 + x / 32];
+				ASSERT_EQ((word >> (x % 32)) & 1u, tc::uint(reference.get(x, y))) << "cell " << x << ", " << y;
+			}
+		}
+		using std::swap;
+		swap(kernel.inData, kernel.outData);
+	}
+}
+
+TEST(GameOfLifeTest, SparseKernelMatchesNaiveStepping)
+{
+	// the grid is not a multiple of the tiles, the glider crosses several
+	// tiles and the rest of the board stays idle.
+	NaiveLife reference{ 150, 100 };
+	GameOfLife::SparseKernel kernel{ 150, 100, 16 };
+	seedPatterns([&](int x, int y) { reference.set(x, y); }, 10, 10);
+	seedPatterns([&](int x, int y) { kernel.set0(x, y); }, 10, 10);
+	const size_t tileCount = size_t((150 + 15) / 16) * ((100 + 15) / 16);
+	for (int generation = 0; generation < 64; ++generation) {
+		kernel.dispatch();
+		reference.step();
+		EXPECT_LT(kernel.getActiveTileCount(), tileCount);
+		for (int y = 0; y < reference.height(); ++y) {
+			for (int x = 0; x < reference.width(); ++x) {
+				ASSERT_EQ(kernel.get1(x, y), uint32_t(reference.get(x, y)))
+					<< "cell " << x << ", " << y << " in generation " << generation;
+			}
+		}
+		kernel.swapBuffers();
+	}
+}
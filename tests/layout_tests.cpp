@@ -0,0 +1,262 @@
+// layout_tests.cpp
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <vector>
+
+#include "vec.hpp"
+#include "math/arithmetic.hpp"
+#include "layout/std140.hpp"
+#include "layout/std430.hpp"
+#include "kernel_intrinsics.hpp"
+
+TEST(Std140Test, AlignmentAndSize)
+{
+	static_assert(tc::std140::alignmentOf<float>() == 4);
+	static_assert(tc::std140::alignmentOf<tc::vec2>() == 8);
+	static_assert(tc::std140::alignmentOf<tc::vec3>() == 16);
+	static_assert(tc::std140::alignmentOf<tc::dvec3>() == 32);
+	static_assert(tc::std140::sizeOf<tc::vec3>() == 12);
+	static_assert(tc::std140::sizeOf<tc::bvec2>() == 8);
+	static_assert(tc::std140::sizeOf<tc::dvec4>() == 32);
+
+	static_assert(tc::std140::isValidLocation<tc::vec4>(1));
+	static_assert(tc::std140::isValidLocation<tc::dvec4>(2));
+	static_assert(!tc::std140::isValidLocation<tc::dvec4>(3));
+	EXPECT_EQ(tc::std140::slotCount(8, 3), 2u);
+	EXPECT_EQ(tc::std140::slotCount(4, 4), 1u);
+}
+
+TEST(Std140Test, StoreValues)
+{
+	std::array<std::byte, 48> block{};
+
+	tc::std140::store(block.data() + tc::std140::slotOffset(0), 1.5f);
+	tc::std140::store(block.data() + tc::std140::slotOffset(1), tc::vec3{ 1.0f, 2.0f, 3.0f });
+	tc::std140::store(block.data() + tc::std140::slotOffset(2), tc::bvec2{ true, false });
+
+	float f;
+	std::memcpy(&f, block.data(), sizeof(float));
+	EXPECT_FLOAT_EQ(f, 1.5f);
+
+	std::array<float, 3> v;
+	std::memcpy(v.data(), block.data() + 16, sizeof(v));
+	EXPECT_FLOAT_EQ(v[0], 1.0f);
+	EXPECT_FLOAT_EQ(v[1], 2.0f);
+	EXPECT_FLOAT_EQ(v[2], 3.0f);
+
+	// a GLSL bool is 4 bytes wide
+	std::array<uint32_t, 2> b;
+	std::memcpy(b.data(), block.data() + 32, sizeof(b));
+	EXPECT_EQ(b[0], 1u);
+	EXPECT_EQ(b[1], 0u);
+}
+
+namespace {
+	struct PackedSphere {
+		tc::vec3 loc;
+		float R;
+		tc::vec4 color;
+	};
+
+	struct AlignedSphere {
+		tc::std430::vec3 loc;
+		float R;
+		tc::std430::vec4 color;
+	};
+}
+
+TEST(Std430Test, VerifyStructLayout)
+{
+	static_assert(sizeof(tc::std430::vec3) == 16 && alignof(tc::std430::vec3) == 16);
+	static_assert(alignof(tc::std430::dvec3) == 32);
+
+	// color ends up at offset 20, std430 puts a vec4 at a multiple of 16.
+	static_assert(!tc::std430::verify<PackedSphere>({
+		TC_STD430_MEMBER(PackedSphere, loc),
+		TC_STD430_MEMBER(PackedSphere, R),
+		TC_STD430_MEMBER(PackedSphere, color) }));
+
+	static_assert(tc::std430::verify<AlignedSphere>({
+		TC_STD430_MEMBER(AlignedSphere, loc),
+		TC_STD430_MEMBER(AlignedSphere, R),
+		TC_STD430_MEMBER(AlignedSphere, color) }));
+
+	EXPECT_EQ(tc::std430::check({ {0, 16, 12}, {8, 4, 4} }, 16), tc::std430::LayoutResult::Overlap);
+	EXPECT_EQ(tc::std430::check({ {0, 16, 12}, {12, 4, 4} }, 20), tc::std430::LayoutResult::Stride);
+	EXPECT_EQ(tc::std430::check({ {0, 16, 12}, {12, 4, 4} }, 16), tc::std430::LayoutResult::Ok);
+}
+
+TEST(Std430Test, AlignedVectorsBehaveAsVectors)
+{
+	AlignedSphere s{ tc::vec3{ 1.0f, 2.0f, 3.0f }, 0.5f, tc::vec4{ 1.0f } };
+	tc::vec3 loc = s.loc;
+	tc::vec4 scaled = 2.0f * s.color;
+
+	EXPECT_FLOAT_EQ(loc.z, 3.0f);
+	EXPECT_FLOAT_EQ(scaled.w, 2.0f);
+}
+
+template<tc::StorageLayout L>
+void expectBijective2D(tc::ivec2 dim)
+{
+	using Traits = tc::LayoutTraits<tc::Dim::D2, L>;
+	std::vector<int> hits(Traits::storageSize(dim), 0);
+	for (int y = 0; y < dim.y; ++y) {
+		for (int x = 0; x < dim.x; ++x) {
+			int index = Traits::coordinateToIndex(tc::ivec2{ x,y }, dim);
+			ASSERT_GE(index, 0);
+			ASSERT_LT(index, static_cast<int>(hits.size()));
+			++hits[index];
+		}
+	}
+	EXPECT_TRUE(std::ranges::all_of(hits, [](int h) { return h <= 1; }));
+}
+
+TEST(StorageLayoutTest, IndicesAreUnique)
+{
+	expectBijective2D<tc::StorageLayout::Tiled>(tc::ivec2{ 37,21 });
+	expectBijective2D<tc::StorageLayout::Morton>(tc::ivec2{ 37,21 });
+	expectBijective2D<tc::StorageLayout::Morton>(tc::ivec2{ 64,8 });
+
+	using Tiled3 = tc::LayoutTraits<tc::Dim::D3, tc::StorageLayout::Tiled>;
+	using Morton3 = tc::LayoutTraits<tc::Dim::D3, tc::StorageLayout::Morton>;
+	tc::ivec3 dim{ 9,17,5 };
+	std::vector<int> tiled(Tiled3::storageSize(dim), 0);
+	std::vector<int> morton(Morton3::storageSize(dim), 0);
+	for (int z = 0; z < dim.z; ++z) {
+		for (int y = 0; y < dim.y; ++y) {
+			for (int x = 0; x < dim.x; ++x) {
+				++tiled[Tiled3::coordinateToIndex(tc::ivec3{ x,y,z }, dim)];
+				++morton[Morton3::coordinateToIndex(tc::ivec3{ x,y,z }, dim)];
+			}
+		}
+	}
+	EXPECT_TRUE(std::ranges::all_of(tiled, [](int h) { return h <= 1; }));
+	EXPECT_TRUE(std::ranges::all_of(morton, [](int h) { return h <= 1; }));
+}
+
+TEST(StorageLayoutTest, MortonPadsOnlyTheEdgeBlocks)
+{
+	using Morton2 = tc::LayoutTraits<tc::Dim::D2, tc::StorageLayout::Morton>;
+	using Morton3 = tc::LayoutTraits<tc::Dim::D3, tc::StorageLayout::Morton>;
+	EXPECT_EQ(Morton2::storageSize(tc::ivec2{ 1025,1025 }), 1040 * 1040);
+	EXPECT_EQ(Morton2::storageSize(tc::ivec2{ 4096,3 }), 4096 * 16);
+	EXPECT_EQ(Morton2::storageSize(tc::ivec2{ 37,21 }), 48 * 32);
+	EXPECT_EQ(Morton3::storageSize(tc::ivec3{ 5,6,7 }), 512);
+	EXPECT_EQ(Morton3::storageSize(tc::ivec3{ 1100,9,3 }), 1104 * 16 * 8);
+
+	expectBijective2D<tc::StorageLayout::Morton>(tc::ivec2{ 1025,1025 });
+	expectBijective2D<tc::StorageLayout::Morton>(tc::ivec2{ 3000,5 });
+}
+
+TEST(StorageLayoutTest, MortonRoundTripsLargeVolumes)
+{
+	// more than 1024 voxels along an axis, which one Morton code of 30 bits
+	// could not address.
+	using Morton3 = tc::LayoutTraits<tc::Dim::D3, tc::StorageLayout::Morton>;
+	for (tc::ivec3 dim : { tc::ivec3{ 1100,1030,3 }, tc::ivec3{ 3,1100,1030 }, tc::ivec3{ 1030,3,1100 } }) {
+		std::vector<int> hits(Morton3::storageSize(dim), 0);
+		for (int z = 0; z < dim.z; ++z) {
+			for (int y = 0; y < dim.y; ++y) {
+				for (int x = 0; x < dim.x; ++x) {
+					int index = Morton3::coordinateToIndex(tc::ivec3{ x,y,z }, dim);
+					ASSERT_GE(index, 0);
+					ASSERT_LT(index, static_cast<int>(hits.size()));
+					++hits[index];
+				}
+			}
+		}
+		EXPECT_TRUE(std::ranges::all_of(hits, [](int h) { return h <= 1; }));
+	}
+
+	tc::BufferResource<float, tc::Dim::D3, tc::StorageLayout::Morton> volume{ tc::ivec3{ 1030,2,1030 } };
+	for (int z = 0; z < 1030; ++z) {
+		for (int x = 0; x < 1030; ++x) {
+			volume[tc::ivec3{ x,1,z }] = float(z * 1030 + x);
+		}
+	}
+	for (int z = 0; z < 1030; ++z) {
+		for (int x = 0; x < 1030; ++x) {
+			ASSERT_EQ((volume[tc::ivec3{ x,1,z }]), float(z * 1030 + x));
+		}
+	}
+}
+
+TEST(StorageLayoutTest, NeighboursShareATile)
+{
+	using Tiled = tc::LayoutTraits<tc::Dim::D2, tc::StorageLayout::Tiled>;
+	tc::ivec2 dim{ 1024,1024 };
+	int center = Tiled::coordinateToIndex(tc::ivec2{ 10,10 }, dim);
+	int below = Tiled::coordinateToIndex(tc::ivec2{ 10,11 }, dim);
+	EXPECT_EQ(below - center, 8);
+}
+
+TEST(StorageLayoutTest, ImagesConvertToLinear)
+{
+	using TiledImage = tc::BufferResource<tc::cpu::R8UI, tc::Dim::D2, tc::StorageLayout::Tiled>;
+	TiledImage tiled{ tc::ivec2{ 13,10 } };
+	tc::ImageBinding<tc::InternalFormat::R8UI, tc::Dim::D2, tc::cpu::R8UI, 0, 0, tc::StorageLayout::Tiled> image;
+	image.attach(&tiled);
+	for (int y = 0; y < 10; ++y) {
+		for (int x = 0; x < 13; ++x) {
+			tc::imageStore(image, tc::ivec2{ x,y }, tc::uvec4(tc::uint((x + 13 * y) % 251)));
+		}
+	}
+	EXPECT_EQ(tc::imageLoad(image, tc::ivec2{ 12,9 }).x, (12u + 13u * 9u) % 251u);
+
+	std::vector<tc::cpu::R8UI> linear(13 * 10);
+	tiled.copyToLinear(linear.data());
+	tc::BufferResource<tc::cpu::R8UI, tc::Dim::D2> reference{ tc::ivec2{ 13,10 } };
+	reference.copyFromLinear(linear.data());
+	for (int y = 0; y < 10; ++y) {
+		for (int x = 0; x < 13; ++x) {
+			tc::ivec2 coord{ x,y };
+			EXPECT_EQ(reference[coord].get<tc::Channel::R>(), (x + 13 * y) % 251);
+		}
+	}
+}
+
+namespace {
+	struct Particle {
+		tc::vec3 position;
+		float mass;
+		tc::vec4 color;
+	};
+}
+TC_SOA_FIELDS(Particle, position, mass, color);
+
+TEST(SoATest, MembersAreSeparateArrays)
+{
+	using Buffer = tc::BufferResource<Particle, tc::Dim::D1, tc::StorageLayout::SoA>;
+	static_assert(Buffer::FieldCount == 3);
+	static_assert(tc::soa::Fields<Particle>::names[1] == "mass");
+	// a vec3 array keeps the std430 stride.
+	static_assert(sizeof(Buffer::Fields::Columns) > 0);
+	static_assert(sizeof(std::tuple_element_t<0, Buffer::Fields::Columns>::value_type) == 16);
+
+	Buffer particles{ 8 };
+	tc::BufferBinding<Particle, 3, 0, tc::StorageLayout::SoA> binding;
+	binding.attach(&particles);
+
+	for (int i = 0; i < 8; ++i) {
+		binding[i] = Particle{ tc::vec3(float(i), 0.0f, 1.0f), 2.0f * i, tc::vec4(1.0f) };
+	}
+	binding[3].mass = 10.0f;
+
+	EXPECT_FLOAT_EQ(particles.column<1>()[3], 10.0f);
+	EXPECT_FLOAT_EQ(particles.column<1>()[4], 8.0f);
+	EXPECT_FLOAT_EQ(particles.column<0>()[5].x, 5.0f);
+
+	tc::vec3 position = binding[6].position;
+	EXPECT_FLOAT_EQ(position.x, 6.0f);
+	Particle p = binding[7];
+	EXPECT_FLOAT_EQ(p.position.z, 1.0f);
+	EXPECT_FLOAT_EQ(p.mass, 14.0f);
+
+	const auto& constBinding = binding;
+	EXPECT_FLOAT_EQ(constBinding[2].color.w, 1.0f);
+	EXPECT_EQ(binding.size(), 8u);
+}
@@ -3,13 +3,14 @@
 #
 #include "vec.hpp"    
 #include "kernel_intrinsics.hpp"
+#include "computebackend.hpp"
 #include "math/arithmetic.hpp"
 #include "images/ImageFormat.hpp"
 
 TEST(PixelTest, ReadAndWriteChannels)
 {
 	using namespace tc;
-	tc::cpu::RGB8 px{ 0.2,0.3,0.5 };
+	tc::cpu::RGB32F px{ 0.2,0.3,0.5 };
 
 	float r = px.get<Channel::R>();
 	float g = px.get<Channel::G>();
@@ -21,16 +22,16 @@ TEST(PixelTest, ReadAndWriteChannels)
 	EXPECT_EQ(b, 0.5);
 	EXPECT_EQ(a, 1.0f);
 
-	using r_t  = tc::cpu::RGB8::ChannelType<Channel::R>;
+	using r_t  = tc::cpu::RGB32F::ChannelType<Channel::R>;
 	static_assert(std::floating_point<r_t>);
 
-	using g_t = tc::cpu::RGB8::ChannelType<Channel::G>;
+	using g_t = tc::cpu::RGB32F::ChannelType<Channel::G>;
 	static_assert(std::floating_point<r_t>);
 
-	using b_t = tc::cpu::RGB8::ChannelType<Channel::B>;
+	using b_t = tc::cpu::RGB32F::ChannelType<Channel::B>;
 	static_assert(std::floating_point<r_t>);
 
-	using a_t = tc::cpu::RGB8::ChannelType<Channel::A>;
+	using a_t = tc::cpu::RGB32F::ChannelType<Channel::A>;
 	static_assert(std::floating_point<r_t>);
 }
 
@@ -41,9 +42,9 @@ TEST(PixelTest, ChannelReadAndWrite)
 
 	EXPECT_EQ(alpha, 255u);
 
-	tc::ImageBinding<tc::InternalFormat::RGBA8, tc::Dim::D2, tc::cpu::RGB8, 1> image;
+	tc::ImageBinding<tc::InternalFormat::RGBA8, tc::Dim::D2, tc::cpu::RGB32F, 1> image;
 	// vervanging door make_unique
-	auto* pImageBuffer = new tc::BufferResource<tc::cpu::RGB8, tc::Dim::D2>{ tc::ivec2{32,32} };
+	auto* pImageBuffer = new tc::BufferResource<tc::cpu::RGB32F, tc::Dim::D2>{ tc::ivec2{32,32} };
 	image.attach(pImageBuffer);
 
 	tc::imageStore(image, tc::ivec2{ 2,2 }, tc::vec4{ 0.8f,0.71f, 0.24f, 0.5f });
@@ -70,4 +71,231 @@ TEST(PixelTest, RWGrayImage)
 	EXPECT_EQ(color.y, 127);
 	EXPECT_EQ(color.z, 127);
 	EXPECT_EQ(color.w, 255);
-}
\ No newline at end of file
+}
+
+TEST(PixelTest, HalfConversion)
+{
+	EXPECT_EQ(tc::half(1.0f).bits, 0x3C00u);
+	EXPECT_EQ(tc::half(-2.5f).bits, 0xC100u);
+	EXPECT_EQ(tc::half(65504.0f).bits, 0x7BFFu);
+	// the smallest normal and the smallest denormal
+	EXPECT_EQ(tc::half(0x1p-14f).bits, 0x0400u);
+	EXPECT_EQ(tc::half(0x1p-24f).bits, 0x0001u);
+	// past the largest half and beyond
+	EXPECT_EQ(tc::half(65520.0f).bits, 0x7C00u);
+	EXPECT_EQ(tc::half(1.0e6f).bits, 0x7C00u);
+	// halfway between two halfs rounds to the even one
+	EXPECT_EQ(tc::half(1.0f + 0x1p-11f).bits, 0x3C00u);
+	EXPECT_EQ(tc::half(1.0f + 0x1p-11f * 3).bits, 0x3C02u);
+
+	for (uint32_t bits = 0; bits < 0x7C00u; ++bits) {
+		tc::half h = tc::half::fromBits(static_cast<uint16_t>(bits));
+		ASSERT_EQ(tc::half(float(h)).bits, bits);
+	}
+}
+
+TEST(PixelTest, RWHalfImage)
+{
+	tc::ImageBinding<tc::InternalFormat::RGBA16F, tc::Dim::D2, tc::cpu::RGBA16F, 1> image;
+	tc::BufferResource<tc::cpu::RGBA16F, tc::Dim::D2> buffer{ tc::ivec2{ 8, 8 } };
+	image.attach(&buffer);
+	static_assert(sizeof(tc::cpu::RGBA16F) == 8);
+
+	tc::imageStore(image, tc::ivec2{ 3, 5 }, tc::vec4{ 0.5f, -1.25f, 1024.0f, 0.1f });
+	tc::vec4 color = tc::imageLoad(image, tc::ivec2{ 3, 5 });
+
+	EXPECT_EQ(color.x, 0.5f);
+	EXPECT_EQ(color.y, -1.25f);
+	EXPECT_EQ(color.z, 1024.0f);
+	EXPECT_NEAR(color.w, 0.1f, 0.1f / 1024);
+}
+
+TEST(PixelTest, PackedFloatPixel)
+{
+	tc::cpu::R11G11B10F px{ 1.0f, 0.5f, 2.0f };
+	// exponent 15, 14 and 16 with a zero mantissa
+	EXPECT_EQ(px.bits(), (15u << 6) | ((14u << 6) << 11) | ((16u << 5) << 22));
+	EXPECT_EQ(px.get<tc::Channel::R>(), 1.0f);
+	EXPECT_EQ(px.get<tc::Channel::G>(), 0.5f);
+	EXPECT_EQ(px.get<tc::Channel::B>(), 2.0f);
+	EXPECT_EQ(px.get<tc::Channel::A>(), 1.0f);
+
+	// no sign bit, a negative value is 0 and a large one is clamped.
+	px.set<tc::Channel::R>(-3.0f);
+	px.set<tc::Channel::B>(1.0e9f);
+	EXPECT_EQ(px.get<tc::Channel::R>(), 0.0f);
+	EXPECT_EQ(px.get<tc::Channel::G>(), 0.5f);
+	EXPECT_EQ(px.get<tc::Channel::B>(), 64512.0f);
+
+	tc::ImageBinding<tc::InternalFormat::R11F_G11F_B10F, tc::Dim::D2, tc::cpu::R11G11B10F, 1> image;
+	tc::BufferResource<tc::cpu::R11G11B10F, tc::Dim::D2> buffer{ tc::ivec2{ 4, 4 } };
+	image.attach(&buffer);
+	tc::imageStore(image, tc::ivec2{ 1, 2 }, tc::vec4{ 0.25f, 3.0f, 0.75f, 0.5f });
+	tc::vec4 color = tc::imageLoad(image, tc::ivec2{ 1, 2 });
+	EXPECT_EQ(color.x, 0.25f);
+	EXPECT_EQ(color.y, 3.0f);
+	EXPECT_EQ(color.z, 0.75f);
+	EXPECT_EQ(color.w, 1.0f);
+}
+
+TEST(PixelTest, PackedUNormPixel)
+{
+	tc::cpu::RGB10A2 px{ 1.0f, 0.0f, 0.5f, 0.4f };
+	EXPECT_EQ(px.bits(), 1023u | (512u << 20) | (1u << 30));
+	EXPECT_EQ(px.get<tc::Channel::R>(), 1.0f);
+	EXPECT_EQ(px.get<tc::Channel::G>(), 0.0f);
+	EXPECT_EQ(px.get<tc::Channel::B>(), 512.0f / 1023.0f);
+	EXPECT_EQ(px.get<tc::Channel::A>(), 1.0f / 3.0f);
+	static_assert(sizeof(tc::cpu::RGB10A2) == 4);
+}
+
+TEST(PixelTest, UNorm8Image)
+{
+	static_assert(sizeof(tc::cpu::RGBA8) == 4);
+	static_assert(std::same_as<tc::cpu::RGBA8::ChannelType<tc::Channel::R>, uint8_t>);
+
+	tc::ImageBinding<tc::InternalFormat::RGBA8, tc::Dim::D2, tc::cpu::RGBA8, 1> image;
+	tc::BufferResource<tc::cpu::RGBA8, tc::Dim::D2> buffer{ tc::ivec2{ 8, 8 } };
+	image.attach(&buffer);
+
+	// stored rounded to the nearest of 256 levels, values outside 0..1 clamp.
+	tc::imageStore(image, tc::ivec2{ 4, 1 }, tc::vec4{ 1.0f, 0.5f, -0.25f, 0.2f });
+	const tc::cpu::RGBA8& px = buffer[tc::ivec2{ 4, 1 }];
+	EXPECT_EQ(px.get<tc::Channel::R>(), 255u);
+	EXPECT_EQ(px.get<tc::Channel::G>(), 128u);
+	EXPECT_EQ(px.get<tc::Channel::B>(), 0u);
+	EXPECT_EQ(px.get<tc::Channel::A>(), 51u);
+
+	tc::vec4 color = tc::imageLoad(image, tc::ivec2{ 4, 1 });
+	EXPECT_EQ(color.x, 1.0f);
+	EXPECT_EQ(color.y, 128.0f / 255.0f);
+	EXPECT_EQ(color.z, 0.0f);
+	EXPECT_FLOAT_EQ(color.w, 0.2f);
+}
+
+TEST(PixelTest, ImageViewFollowsBind)
+{
+	tc::ImageBinding<tc::InternalFormat::R8UI, tc::Dim::D2, tc::cpu::R8UI, 1> image;
+	tc::BufferResource<tc::cpu::R8UI, tc::Dim::D2> front{ tc::ivec2{ 8, 4 } };
+	tc::BufferResource<tc::cpu::R8UI, tc::Dim::D2> back{ tc::ivec2{ 4, 8 } };
+	image.attach(&front);
+	EXPECT_EQ(image.view().base, front.data());
+	EXPECT_EQ(tc::imageSize(image).x, 8);
+
+	tc::imageStore(image, tc::ivec2{ 7, 3 }, tc::uint{ 9 });
+	EXPECT_EQ((front[tc::ivec2{ 7, 3 }].get<tc::Channel::R>()), 9u);
+
+	// the view is taken again when the CPU backend binds the image.
+	front.swap(back);
+	tc::CPUBackend cpu;
+	cpu.bindImage(image);
+	EXPECT_EQ(image.view().base, front.data());
+	EXPECT_EQ(tc::imageSize(image).x, 4);
+	tc::uvec4 color = tc::imageLoad(image, tc::ivec2{ 3, 7 });
+	EXPECT_EQ(color.x, 0u);
+
+#ifndef NDEBUG
+	EXPECT_THROW(tc::imageLoad(image, tc::ivec2{ 4, 0 }), std::runtime_error);
+#endif
+
+	// without a bind the view follows the swap as well.
+	front.swap(back);
+	EXPECT_EQ(image.view().base, front.data());
+	EXPECT_EQ(tc::imageSize(image).x, 8);
+	color = tc::imageLoad(image, tc::ivec2{ 7, 3 });
+	EXPECT_EQ(color.x, 9u);
+}
+
+// Writes the average of the six neighbours of every voxel, the border keeps 0.
+struct VolumeKernel
+{
+	static constexpr char fileLocation[] = "volume";
+	tc::uvec3 local_size{ 4, 4, 4 };
+
+	tc::ImageBinding<tc::InternalFormat::R32F, tc::Dim::D3, tc::cpu::R32F, 0> inData;
+	tc::ImageBinding<tc::InternalFormat::R32F, tc::Dim::D3, tc::cpu::R32F, 1> outData;
+
+	void main() {
+		tc::ivec3 p = tc::ivec3(tc::gl_GlobalInvocationID);
+		tc::ivec3 size = tc::imageSize(inData);
+		float average = 0.0f;
+		if (p.x > 0 && p.y > 0 && p.z > 0 && p.x < size.x - 1 && p.y < size.y - 1 && p.z < size.z - 1) {
+			float sum = tc::imageLoad(inData, p + tc::ivec3(1, 0, 0)).x + tc::imageLoad(inData, p - tc::ivec3(1, 0, 0)).x
+				+ tc::imageLoad(inData, p + tc::ivec3(0, 1, 0)).x + tc::imageLoad(inData, p - tc::ivec3(0, 1, 0)).x
+				+ tc::imageLoad(inData, p + tc::ivec3(0, 0, 1)).x + tc::imageLoad(inData, p - tc::ivec3(0, 0, 1)).x;
+			average = sum / 6.0f;
+		}
+		tc::imageStore(outData, p, tc::vec4(average, 0.0f, 0.0f, 1.0f));
+	}
+};
+
+TEST(PixelTest, VolumeDispatch)
+{
+	const tc::ivec3 size{ 8, 6, 5 };
+	tc::BufferResource<tc::cpu::R32F, tc::Dim::D3> in{ size };
+	tc::BufferResource<tc::cpu::R32F, tc::Dim::D3> out{ size };
+	for (int z = 0; z < size.z; ++z) {
+		for (int y = 0; y < size.y; ++y) {
+			for (int x = 0; x < size.x; ++x) {
+				in[tc::ivec3{ x, y, z }].set<tc::Channel::R>(static_cast<float>(x + 10 * y + 100 * z));
+			}
+		}
+	}
+
+	VolumeKernel kernel;
+	kernel.inData.attach(&in);
+	kernel.outData.attach(&out);
+	tc::CPUBackend cpu;
+	cpu.useKernel(kernel);
+	cpu.uploadImage<tc::InternalFormat::R32F>(in);
+	cpu.bindImage(kernel.inData);
+	cpu.bindImage(kernel.outData);
+	cpu.execute(kernel, tc::uvec3(size));
+
+	// the neighbours of a voxel in a linear ramp average to the voxel itself.
+	for (int z = 0; z < size.z; ++z) {
+		for (int y = 0; y < size.y; ++y) {
+			for (int x = 0; x < size.x; ++x) {
+				bool border = x == 0 || y == 0 || z == 0 || x == size.x - 1 || y == size.y - 1 || z == size.z - 1;
+				float expected = border ? 0.0f : static_cast<float>(x + 10 * y + 100 * z);
+				EXPECT_FLOAT_EQ((out[tc::ivec3{ x, y, z }].get<tc::Channel::R>()), expected);
+			}
+		}
+	}
+}
+
+TEST(PixelTest, AddressModes)
+{
+	tc::BufferResource<tc::cpu::R8UI, tc::Dim::D2> buffer{ tc::ivec2{ 4, 3 } };
+	for (int y = 0; y < 3; ++y) {
+		for (int x = 0; x < 4; ++x) {
+			buffer[tc::ivec2{ x, y }].set<tc::Channel::R>(static_cast<uint8_t>(1 + x + 10 * y));
+		}
+	}
+	tc::ImageBinding<tc::InternalFormat::R8UI, tc::Dim::D2, tc::cpu::R8UI, 0, 0, tc::StorageLayout::Linear, tc::AddressMode::ClampToEdge> clamped;
+	tc::ImageBinding<tc::InternalFormat::R8UI, tc::Dim::D2, tc::cpu::R8UI, 0, 0, tc::StorageLayout::Linear, tc::AddressMode::Repeat> repeated;
+	tc::ImageBinding<tc::InternalFormat::R8UI, tc::Dim::D2, tc::cpu::R8UI, 0, 0, tc::StorageLayout::Linear, tc::AddressMode::Border> bordered;
+	clamped.attach(&buffer);
+	repeated.attach(&buffer);
+	bordered.attach(&buffer);
+
+	tc::uvec4 inside = tc::imageLoad(clamped, tc::ivec2{ 2, 1 });
+	EXPECT_EQ(inside.x, 13u);
+
+	tc::uvec4 clamp = tc::imageLoad(clamped, tc::ivec2{ -3, 5 });
+	EXPECT_EQ(clamp.x, 21u);
+	clamp = tc::imageLoad(clamped, tc::ivec2{ 4, -1 });
+	EXPECT_EQ(clamp.x, 4u);
+
+	tc::uvec4 wrap = tc::imageLoad(repeated, tc::ivec2{ -1, -1 });
+	EXPECT_EQ(wrap.x, 24u);
+	wrap = tc::imageLoad(repeated, tc::ivec2{ 9, 3 });
+	EXPECT_EQ(wrap.x, 2u);
+
+	// every channel reads zero, on the CPU only.
+	tc::uvec4 border = tc::imageLoad(bordered, tc::ivec2{ 4, 0 });
+	EXPECT_EQ(border.x, 0u);
+	EXPECT_EQ(border.w, 0u);
+	border = tc::imageLoad(bordered, tc::ivec2{ 3, 0 });
+	EXPECT_EQ(border.x, 4u);
+}
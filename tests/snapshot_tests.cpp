@@ -0,0 +1,214 @@
+// snapshot_tests.cpp
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+
+#include "vec.hpp"
+#include "kernel_intrinsics.hpp"
+#include "BufferSnapshot.h"
+
+namespace {
+	std::filesystem::path snapshotPath(const char* name)
+	{
+		return std::filesystem::temp_directory_path() / name;
+	}
+
+	template<typename Buffer>
+	void fill(Buffer& buffer, int seed)
+	{
+		const auto size = buffer.getDimension();
+		for (int y = 0; y < size.y; ++y) {
+			for (int x = 0; x < size.x; ++x) {
+				buffer[tc::ivec2{ x, y }] = float(seed + x * 100 + y);
+			}
+		}
+	}
+
+	template<typename A, typename B>
+	void expectSameElements(const A& a, const B& b)
+	{
+		const auto size = a.getDimension();
+		for (int y = 0; y < size.y; ++y) {
+			for (int x = 0; x < size.x; ++x) {
+				EXPECT_EQ((a[tc::ivec2{ x, y }]), (b[tc::ivec2{ x, y }])) << x << ", " << y;
+			}
+		}
+	}
+
+	template<tc::StorageLayout L>
+	void roundTrip(const char* name)
+	{
+		using Buffer = tc::BufferResource<float, tc::Dim::D2, L>;
+		const std::filesystem::path path = snapshotPath(name);
+		// not a multiple of the tile size, so the edge tiles are padded.
+		Buffer buffer{ tc::ivec2{ 13, 9 } };
+		fill(buffer, 1);
+		tc::assets::saveSnapshot(buffer, path);
+
+		auto loaded = tc::assets::loadSnapshot<float, tc::Dim::D2, L>(path);
+		ASSERT_EQ(loaded->size(), buffer.size());
+		expectSameElements(buffer, *loaded);
+
+		Buffer restored{ tc::ivec2{ 13, 9 } };
+		tc::assets::restoreSnapshot(path, restored);
+		expectSameElements(buffer, restored);
+
+		const tc::assets::MappedSnapshot<float, tc::Dim::D2, L> mapped{ path };
+		EXPECT_EQ(mapped.size(), buffer.size());
+		EXPECT_EQ(mapped.getDimension().x, 13);
+		EXPECT_EQ(mapped.getDimension().y, 9);
+		expectSameElements(buffer, mapped);
+		std::filesystem::remove(path);
+	}
+}
+
+TEST(SnapshotTest, LinearRoundTrip)
+{
+	roundTrip<tc::StorageLayout::Linear>("tc_snapshot_linear.tcbuf");
+}
+
+TEST(SnapshotTest, TiledRoundTrip)
+{
+	roundTrip<tc::StorageLayout::Tiled>("tc_snapshot_tiled.tcbuf");
+}
+
+TEST(SnapshotTest, MortonRoundTrip)
+{
+	roundTrip<tc::StorageLayout::Morton>("tc_snapshot_morton.tcbuf");
+}
+
+TEST(SnapshotTest, DeltaAgainstMappedBase)
+{
+	using Buffer = tc::BufferResource<float, tc::Dim::D2>;
+	const std::filesystem::path basePath = snapshotPath("tc_snapshot_base.tcbuf");
+	const std::filesystem::path deltaPath = snapshotPath("tc_snapshot_delta.tcbuf");
+	Buffer buffer{ tc::ivec2{ 64, 48 } };
+	fill(buffer, 0);
+	tc::assets::saveSnapshot(buffer, basePath);
+
+	// two separate changes, one of them in the short last block.
+	buffer[tc::ivec2{ 3, 2 }] = -1.0f;
+	buffer[tc::ivec2{ 63, 47 }] = -2.0f;
+	{
+		const tc::assets::MappedSnapshot<float, tc::Dim::D2> base{ basePath };
+		tc::assets::saveDeltaSnapshot(buffer, base, deltaPath, 1000);
+
+		Buffer restored{ tc::ivec2{ 64, 48 } };
+		base.copyTo(restored);
+		EXPECT_NE((restored[tc::ivec2{ 3, 2 }]), -1.0f);
+		tc::assets::applyDeltaSnapshot(deltaPath, restored);
+		expectSameElements(buffer, restored);
+	}
+	// only the changed blocks are stored.
+	EXPECT_LT(std::filesystem::file_size(deltaPath), std::filesystem::file_size(basePath) / 2);
+	std::filesystem::remove(basePath);
+	std::filesystem::remove(deltaPath);
+}
+
+TEST(SnapshotTest, DeltaRejectsOtherBases)
+{
+	using Buffer = tc::BufferResource<float, tc::Dim::D2>;
+	const std::filesystem::path path = snapshotPath("tc_snapshot_delta_base.tcbuf");
+	Buffer base{ tc::ivec2{ 10, 20 } };
+	fill(base, 0);
+	Buffer buffer{ tc::ivec2{ 10, 20 } };
+	fill(buffer, 0);
+	buffer[tc::ivec2{ 5, 5 }] = -1.0f;
+	tc::assets::saveDeltaSnapshot(buffer, base, path, 64);
+
+	// as many elements, another extent.
+	Buffer transposed{ tc::ivec2{ 20, 10 } };
+	EXPECT_THROW(tc::assets::applyDeltaSnapshot(path, transposed), std::runtime_error);
+	// another base, which is left as it is.
+	Buffer other{ tc::ivec2{ 10, 20 } };
+	fill(other, 7);
+	EXPECT_THROW(tc::assets::applyDeltaSnapshot(path, other), std::runtime_error);
+	EXPECT_EQ((other[tc::ivec2{ 5, 5 }]), 7.0f + 500.0f + 5.0f);
+
+	Buffer restored{ tc::ivec2{ 10, 20 } };
+	fill(restored, 0);
+	tc::assets::applyDeltaSnapshot(path, restored);
+	expectSameElements(buffer, restored);
+	std::filesystem::remove(path);
+}
+
+TEST(SnapshotTest, DeltaRejectsBadBlocks)
+{
+	using Buffer = tc::BufferResource<float, tc::Dim::D2>;
+	const std::filesystem::path path = snapshotPath("tc_snapshot_delta_corrupt.tcbuf");
+	Buffer base{ tc::ivec2{ 8, 8 } };
+	fill(base, 0);
+	Buffer buffer{ tc::ivec2{ 8, 8 } };
+	fill(buffer, 1);
+
+	auto patch = [&](auto member, auto value) {
+		tc::assets::saveDeltaSnapshot(buffer, base, path, 32);
+		std::fstream file{ path, std::ios::binary | std::ios::in | std::ios::out };
+		file.seekp(member);
+		file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+	};
+
+	Buffer restored{ tc::ivec2{ 8, 8 } };
+	fill(restored, 0);
+	patch(offsetof(tc::assets::SnapshotHeader, blockSize), uint64_t(0));
+	EXPECT_THROW(tc::assets::applyDeltaSnapshot(path, restored), std::runtime_error);
+	// more blocks than the buffer has, thrown before the table is allocated.
+	patch(offsetof(tc::assets::SnapshotHeader, blockCount), uint64_t(1) << 60);
+	EXPECT_THROW(tc::assets::applyDeltaSnapshot(path, restored), std::runtime_error);
+	// a block after the end of the buffer.
+	patch(tc::assets::SnapshotAlignment, uint64_t(8));
+	EXPECT_THROW(tc::assets::applyDeltaSnapshot(path, restored), std::runtime_error);
+	expectSameElements(base, restored);
+	std::filesystem::remove(path);
+}
+
+TEST(SnapshotTest, RejectsOtherBuffers)
+{
+	const std::filesystem::path path = snapshotPath("tc_snapshot_mismatch.tcbuf");
+	tc::BufferResource<float, tc::Dim::D2> buffer{ tc::ivec2{ 4, 4 } };
+	fill(buffer, 0);
+	tc::assets::saveSnapshot(buffer, path);
+
+	// the element type is only checked by its size.
+	using Wrong = tc::BufferResource<double, tc::Dim::D2>;
+	EXPECT_THROW((tc::assets::loadSnapshot<double, tc::Dim::D2>(path)), std::runtime_error);
+	EXPECT_THROW((tc::assets::loadSnapshot<float, tc::Dim::D3>(path)), std::runtime_error);
+	EXPECT_THROW((tc::assets::MappedSnapshot<float, tc::Dim::D2, tc::StorageLayout::Tiled>{ path }), std::runtime_error);
+	Wrong wrongType{ tc::ivec2{ 4, 4 } };
+	EXPECT_THROW(tc::assets::restoreSnapshot(path, wrongType), std::runtime_error);
+	tc::BufferResource<float, tc::Dim::D2> wrongSize{ tc::ivec2{ 4, 5 } };
+	EXPECT_THROW(tc::assets::restoreSnapshot(path, wrongSize), std::runtime_error);
+	std::filesystem::remove(path);
+}
+
+TEST(SnapshotTest, RejectsBadPayloadSize)
+{
+	const std::filesystem::path path = snapshotPath("tc_snapshot_corrupt.tcbuf");
+	tc::BufferResource<float, tc::Dim::D2> buffer{ tc::ivec2{ 8, 8 } };
+	fill(buffer, 0);
+
+	auto patch = [&](auto member, auto value) {
+		tc::assets::saveSnapshot(buffer, path);
+		std::fstream file{ path, std::ios::binary | std::ios::in | std::ios::out };
+		file.seekp(member);
+		file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+	};
+
+	// a larger element count than the payload holds.
+	patch(offsetof(tc::assets::SnapshotHeader, elementCount), uint64_t(1) << 40);
+	EXPECT_THROW((tc::assets::MappedSnapshot<float, tc::Dim::D2>{ path }), std::runtime_error);
+	// a payload that does not match the element count.
+	patch(offsetof(tc::assets::SnapshotHeader, payloadSize), uint64_t(8 * 8 * sizeof(float) - 2));
+	EXPECT_THROW((tc::assets::MappedSnapshot<float, tc::Dim::D2>{ path }), std::runtime_error);
+	EXPECT_THROW((tc::assets::loadSnapshot<float, tc::Dim::D2>(path)), std::runtime_error);
+	// a payload past the end of the file, without wrapping around.
+	patch(offsetof(tc::assets::SnapshotHeader, payloadOffset), ~uint64_t(0) - 7);
+	EXPECT_THROW((tc::assets::MappedSnapshot<float, tc::Dim::D2>{ path }), std::runtime_error);
+
+	tc::assets::saveSnapshot(buffer, path);
+	EXPECT_NO_THROW((tc::assets::MappedSnapshot<float, tc::Dim::D2>{ path }));
+	std::filesystem::remove(path);
+}
@@ -0,0 +1,110 @@
+// sparse_tests.cpp
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "vec.hpp"
+#include "sparse/ActiveTiles.hpp"
+#include "computebackend.hpp"
+
+TEST(ActiveTilesTest, TileGrid)
+{
+	tc::sparse::ActiveTiles tiles{ tc::ivec2{ 100, 40 }, tc::ivec2{ 32, 16 } };
+	EXPECT_EQ(tiles.getTileCount().x, 4);
+	EXPECT_EQ(tiles.getTileCount().y, 3);
+	EXPECT_EQ(tiles.tileOf(tc::ivec2{ 99, 39 }), 11u);
+	tc::ivec2 origin = tiles.tileOrigin(6);
+	EXPECT_EQ(origin.x, 64);
+	EXPECT_EQ(origin.y, 16);
+
+	tiles.activateAll();
+	EXPECT_EQ(tiles.getActive().size(), 12u);
+}
+
+TEST(ActiveTilesTest, CompactAddsNeighbours)
+{
+	tc::sparse::ActiveTiles tiles{ tc::ivec2{ 64, 64 }, tc::ivec2{ 16, 16 } };
+	// a corner tile and a tile in the middle, their neighbourhoods overlap.
+	tiles.markChanged(0);
+	tiles.markChanged(5);
+	tiles.compact();
+	std::vector<uint32_t> active(tiles.getActive().begin(), tiles.getActive().end());
+	std::vector<uint32_t> expected{ 0, 1, 2, 4, 5, 6, 8, 9, 10 };
+	EXPECT_EQ(active, expected);
+
+	// nothing changed since, so nothing runs.
+	tiles.compact();
+	EXPECT_TRUE(tiles.getActive().empty());
+}
+
+// Appends the index of every odd element to a list, the first element of
+// args counts the list like the group count of an indirect dispatch.
+struct CompactOddKernel
+{
+	static constexpr char fileLocation[] = "compact_odd";
+	tc::uvec3 local_size{ 4, 1, 1 };
+
+	tc::BufferBinding<tc::uint, 0> values;
+	tc::BufferBinding<tc::uint, 1> list;
+	tc::BufferBinding<tc::uint, 2> args;
+
+	void main() {
+		tc::uint i = tc::gl_GlobalInvocationID.x;
+		if (values[i] % 2 == 1) {
+			tc::uint slot = tc::atomicAdd(args[0], 1u);
+			list[slot] = i;
+		}
+	}
+};
+
+// Writes the work group of every invocation of the listed groups.
+struct GroupKernel
+{
+	static constexpr char fileLocation[] = "group";
+	tc::uvec3 local_size{ 4, 1, 1 };
+
+	tc::BufferBinding<tc::uint, 0> groups;
+
+	void main() {
+		groups[tc::gl_GlobalInvocationID.x] = tc::gl_WorkGroupID.x * 10 + tc::gl_LocalInvocationID.x;
+	}
+};
+
+TEST(IndirectDispatchTest, AtomicCompactionFeedsIndirectDispatch)
+{
+	tc::BufferResource<tc::uint> values{ 64 };
+	tc::BufferResource<tc::uint> list{ 64 };
+	tc::BufferResource<tc::uint> args{ 3 };
+	for (int i = 0; i < 64; ++i) {
+		values[i] = static_cast<tc::uint>(i);
+	}
+	args[1] = 1;
+	args[2] = 1;
+
+	CompactOddKernel compact;
+	compact.values.attach(&values);
+	compact.list.attach(&list);
+	compact.args.attach(&args);
+
+	tc::CPUBackend cpu;
+	cpu.useKernel(compact);
+	cpu.execute(compact, tc::uvec3{ 64u, 1u, 1u });
+	ASSERT_EQ(args[0], 32u);
+
+	std::vector<tc::uint> odd(list.data(), list.data() + 32);
+	std::sort(odd.begin(), odd.end());
+	for (int i = 0; i < 32; ++i) {
+		EXPECT_EQ(odd[i], static_cast<tc::uint>(2 * i + 1));
+	}
+
+	// 32 groups of 4 invocations.
+	tc::BufferResource<tc::uint> groups{ 128 };
+	GroupKernel group;
+	group.groups.attach(&groups);
+	cpu.useKernel(group);
+	cpu.executeIndirect(group, args);
+	EXPECT_EQ(groups[0], 0u);
+	EXPECT_EQ(groups[5], 11u);
+	EXPECT_EQ(groups[127], 313u);
+}
@@ -0,0 +1,39 @@
+// spec_constant_tests.cpp
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <vector>
+
+#include "vec.hpp"
+#include "computebackend.hpp"
+
+namespace {
+	struct ScaleKernel {
+		static constexpr char fileLocation[] = "tests/scale";
+		tc::uvec3 local_size{ 16,1,1 };
+		tc::SpecConstant<tc::integer, 0, 3> factor;
+		std::vector<int>* pValues;
+		void main() {
+			(*pValues)[tc::gl_GlobalInvocationID.x] *= factor;
+		}
+	};
+}
+
+TEST(SpecConstantTest, CPUUsesDefault)
+{
+	static_assert(decltype(ScaleKernel::factor)::value == 3);
+	std::vector<int> values{ 1, 2, 3 };
+	ScaleKernel kernel{};
+	kernel.pValues = &values;
+	tc::CPUBackend cpu{ tc::ExecutionPolicy::Seq };
+	cpu.execute(kernel, tc::uvec3{ 3u,1u,1u });
+	EXPECT_EQ(values, (std::vector<int>{ 3, 6, 9 }));
+}
+
+TEST(SpecConstantTest, CPUOnlyAcceptsDefault)
+{
+	ScaleKernel kernel{};
+	tc::CPUBackend cpu;
+	EXPECT_NO_THROW(cpu.specialize(kernel, kernel.factor, 3));
+	EXPECT_THROW(cpu.specialize(kernel, kernel.factor, 4), std::runtime_error);
+}
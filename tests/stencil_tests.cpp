@@ -0,0 +1,136 @@
+// stencil_tests.cpp
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "vec.hpp"
+#include "stencil/TemporalBlocking.hpp"
+
+namespace
+{
+	// Game of Life on one byte per cell.
+	void lifeRule(const uint8_t* center, std::ptrdiff_t stride, uint8_t* out, int count, tc::ivec2)
+	{
+		for (int i = 0; i < count; ++i) {
+			const uint8_t* c = center + i;
+			int n = c[-stride - 1] + c[-stride] + c[-stride + 1]
+				+ c[-1] + c[1]
+				+ c[stride - 1] + c[stride] + c[stride + 1];
+			out[i] = (n == 3) || (c[0] && n == 2);
+		}
+	}
+
+	// Game of Life on 8 cells per byte, the bit in the next element is
+	// carried over, a row of width cells ends in a partial byte.
+	struct PackedLifeRule
+	{
+		int width;
+
+		uint8_t cell(const uint8_t* p, int bit) const {
+			if (bit < 0) {
+				return (p[-1] >> 7) & 1;
+			}
+			if (bit > 7) {
+				return p[1] & 1;
+			}
+			return (p[0] >> bit) & 1;
+		}
+
+		void operator()(const uint8_t* center, std::ptrdiff_t stride, uint8_t* out, int count, tc::ivec2 first) const
+		{
+			for (int i = 0; i < count; ++i) {
+				const uint8_t* c = center + i;
+				uint8_t next = 0;
+				for (int bit = 0; bit < 8; ++bit) {
+					int n = 0;
+					for (int dy = -1; dy <= 1; ++dy) {
+						for (int dx = -1; dx <= 1; ++dx) {
+							if (dx != 0 || dy != 0) {
+								n += cell(c + dy * stride, bit + dx);
+							}
+						}
+					}
+					bool alive = (n == 3) || (cell(c, bit) && n == 2);
+					if (alive && (first.x + i) * 8 + bit < width) {
+						next |= uint8_t(1u << bit);
+					}
+				}
+				out[i] = next;
+			}
+		}
+	};
+
+	std::vector<uint8_t> randomGrid(tc::ivec2 size, int pad, unsigned seed, uint8_t mask)
+	{
+		std::mt19937 random{ seed };
+		std::vector<uint8_t> cells(static_cast<std::size_t>(size.x + 2 * pad) * (size.y + 2 * pad), 0);
+		tc::stencil::Grid2D<uint8_t> grid{ cells.data(), size, pad };
+		for (int y = 0; y < size.y; ++y) {
+			for (int x = 0; x < size.x; ++x) {
+				*grid.at(x, y) = static_cast<uint8_t>(random()) & mask;
+			}
+		}
+		return cells;
+	}
+}
+
+TEST(TemporalBlockingTest, MatchesSingleSteps)
+{
+	// tiles that do not divide the grid and more generations than a tile is wide.
+	const tc::ivec2 size{ 70, 45 };
+	const unsigned generations = 19;
+	std::vector<uint8_t> cells = randomGrid(size, 1, 7, 1);
+
+	std::vector<uint8_t> expected = cells;
+	std::vector<uint8_t> scratch(cells.size(), 0);
+	for (unsigned i = 0; i < generations; ++i) {
+		tc::stencil::stepMany(
+			tc::stencil::Grid2D<const uint8_t>{ expected.data(), size, 1 },
+			tc::stencil::Grid2D<uint8_t>{ scratch.data(), size, 1 },
+			1, lifeRule);
+		std::swap(expected, scratch);
+	}
+
+	std::vector<uint8_t> result(cells.size(), 0);
+	tc::stencil::stepMany(
+		tc::stencil::Grid2D<const uint8_t>{ cells.data(), size, 1 },
+		tc::stencil::Grid2D<uint8_t>{ result.data(), size, 1 },
+		generations, lifeRule, tc::stencil::Blocking{ .tileSize = tc::ivec2{ 16, 8 } });
+
+	EXPECT_EQ(result, expected);
+}
+
+TEST(TemporalBlockingTest, PackedCells)
+{
+	// 8 cells per byte, the halo is one byte per 8 generations.
+	const int width = 93;
+	const tc::ivec2 size{ (width + 7) / 8, 37 };
+	const unsigned generations = 21;
+	std::vector<uint8_t> cells = randomGrid(size, 1, 11, 0xFF);
+	tc::stencil::Grid2D<uint8_t> grid{ cells.data(), size, 1 };
+	for (int y = 0; y < size.y; ++y) {
+		*grid.at(size.x - 1, y) &= uint8_t((1u << (width % 8)) - 1);
+	}
+	PackedLifeRule rule{ width };
+	const tc::stencil::Blocking blocking{ .tileSize = tc::ivec2{ 4, 8 }, .cellsPerElement = tc::ivec2{ 8, 1 } };
+
+	std::vector<uint8_t> expected = cells;
+	std::vector<uint8_t> scratch(cells.size(), 0);
+	for (unsigned i = 0; i < generations; ++i) {
+		tc::stencil::stepMany(
+			tc::stencil::Grid2D<const uint8_t>{ expected.data(), size, 1 },
+			tc::stencil::Grid2D<uint8_t>{ scratch.data(), size, 1 },
+			1, rule, blocking);
+		std::swap(expected, scratch);
+	}
+
+	std::vector<uint8_t> result(cells.size(), 0);
+	tc::stencil::stepMany(
+		tc::stencil::Grid2D<const uint8_t>{ cells.data(), size, 1 },
+		tc::stencil::Grid2D<uint8_t>{ result.data(), size, 1 },
+		generations, rule, blocking);
+
+	EXPECT_EQ(result, expected);
+}
@@ -0,0 +1,50 @@
+// transpiler_tests.cpp
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "ImageAddressing.h"
+
+namespace {
+	// the coordinate of the imageLoad with the text of its addressing around it.
+	std::string addressed(const std::string& mode, const std::string& dimension)
+	{
+		auto addressing = imageAddressing(mode, dimension, "inData");
+		if (!addressing.has_value()) {
+			return "p";
+		}
+		return addressing->insertBefore + "p" + addressing->insertAfter;
+	}
+}
+
+TEST(TranspilerTest, ClampsTheCoordinateOfEachDimension)
+{
+	EXPECT_EQ(addressed("ClampToEdge", "D1"), "clamp(p, int(0), imageSize(inData) - 1)");
+	EXPECT_EQ(addressed("ClampToEdge", "D2"), "clamp(p, ivec2(0), imageSize(inData) - 1)");
+	EXPECT_EQ(addressed("ClampToEdge", "D3"), "clamp(p, ivec3(0), imageSize(inData) - 1)");
+	EXPECT_EQ(addressed("ClampToEdge", "Cube"), "clamp(p, ivec3(0), imageSize(inData) - 1)");
+}
+
+TEST(TranspilerTest, RepeatsTheCoordinateOfEachDimension)
+{
+	for (const char* dimension : { "D1", "D2", "D3", "Cube" }) {
+		EXPECT_EQ(addressed("Repeat", dimension), "tc_repeat(p, imageSize(inData))") << dimension;
+	}
+	// an overload of tc_repeat for every coordinate type.
+	for (const char* dimension : { "D1", "D2", "D3", "Cube" }) {
+		const std::string type = imageCoordinateType(dimension).value();
+		EXPECT_NE(RepeatFunctions.find(type + " tc_repeat(" + type + " p, " + type + " size)"), std::string::npos)
+			<< dimension;
+	}
+}
+
+TEST(TranspilerTest, LeavesUnaddressedLoadsAlone)
+{
+	for (const char* dimension : { "D1", "D2", "D3", "Cube" }) {
+		EXPECT_FALSE(imageAddressing("None", dimension, "inData").has_value()) << dimension;
+		// Border reads zero on the CPU only, the GLSL load is not changed.
+		EXPECT_FALSE(imageAddressing("Border", dimension, "inData").has_value()) << dimension;
+	}
+	EXPECT_FALSE(imageAddressing("ClampToEdge", "", "inData").has_value());
+	EXPECT_FALSE(imageCoordinateType("D4").has_value());
+}
@@ -0,0 +1,148 @@
+// tuning_tests.cpp
+#include <gtest/gtest.h>
+
+#include <filesystem>
+
+#include "vec.hpp"
+#include "tuning/autotune.hpp"
+#include "computebackend.hpp"
+
+TEST(TuningTest, SizeClass)
+{
+	EXPECT_EQ(tc::tuning::sizeClass(tc::uvec3{ 1u,1u,1u }), 0u);
+	EXPECT_EQ(tc::tuning::sizeClass(tc::uvec3{ 1024u,1u,1u }), 10u);
+	EXPECT_EQ(tc::tuning::sizeClass(tc::uvec3{ 1000u,1u,1u }), 9u);
+	EXPECT_EQ(tc::tuning::sizeClass(tc::uvec3{ 512u,512u,1u }), 18u);
+}
+
+TEST(TuningTest, CandidatesMatchDimensions)
+{
+	for (const tc::uvec3& c : tc::tuning::localSizeCandidates(tc::uvec3{ 4096u,1u,1u })) {
+		EXPECT_EQ(c.y, 1u);
+		EXPECT_EQ(c.z, 1u);
+	}
+	for (const tc::uvec3& c : tc::tuning::localSizeCandidates(tc::uvec3{ 512u,512u,1u }, 256)) {
+		EXPECT_GT(c.y, 1u);
+		EXPECT_EQ(c.z, 1u);
+		EXPECT_LE(c.x * c.y, 256u);
+	}
+	EXPECT_EQ(tc::tuning::chunkSizeCandidates(10).size(), 1u);
+}
+
+TEST(TuningTest, TunerPicksLowestMedian)
+{
+	tc::tuning::Tuner tuner({ tc::uvec3{ 8u,8u,1u }, tc::uvec3{ 16u,16u,1u }, tc::uvec3{ 32u,8u,1u } }, 3);
+	// the second candidate has one slow outlier, its median is still the lowest.
+	const double times[3][3] = { { 10, 11, 12 }, { 5, 100, 6 }, { 9, 9, 9 } };
+	unsigned runs[3] = {};
+	while (auto candidate = tuner.nextCandidate()) {
+		tuner.addSample(*candidate, times[*candidate][runs[*candidate]++]);
+	}
+	ASSERT_TRUE(tuner.isDone());
+	EXPECT_EQ(tuner.best().x, 16u);
+	EXPECT_EQ(tuner.best().y, 16u);
+}
+
+TEST(TuningTest, TableRoundTrip)
+{
+	std::filesystem::path file = std::filesystem::temp_directory_path() / "tc_tuning_test.txt";
+	tc::tuning::TuningTable table;
+	table.insert(tc::tuning::TuningTable::makeKey("kernels/gol", "Vendor Renderer 1", 18), tc::uvec3{ 16u,8u,1u });
+	table.insert(tc::tuning::TuningTable::makeKey("kernels/add", "cpu8", 20), tc::uvec3{ 256u,1u,1u });
+	ASSERT_TRUE(table.save(file));
+
+	tc::tuning::TuningTable loaded;
+	ASSERT_TRUE(loaded.load(file));
+	EXPECT_EQ(loaded.size(), 2u);
+	auto value = loaded.find(tc::tuning::TuningTable::makeKey("kernels/gol", "Vendor Renderer 1", 18));
+	ASSERT_TRUE(value.has_value());
+	EXPECT_EQ(value->x, 16u);
+	EXPECT_EQ(value->y, 8u);
+	EXPECT_FALSE(loaded.find(tc::tuning::TuningTable::makeKey("kernels/gol", "Vendor Renderer 1", 17)));
+	std::filesystem::remove(file);
+}
+
+namespace {
+	struct CountingKernel {
+		static constexpr char fileLocation[] = "tests/counting";
+		tc::uvec3 local_size{ 64,1,1 };
+		std::vector<int>* pHits;
+		void main() {
+			(*pHits)[tc::gl_GlobalInvocationID.x] += 1;
+		}
+	};
+}
+
+TEST(TuningTest, CPUChunksCoverEveryInvocation)
+{
+	std::filesystem::path file = std::filesystem::temp_directory_path() / "tc_tuning_cpu.txt";
+	std::filesystem::remove(file);
+	tc::CPUBackend::setAutotuneFile(file);
+	tc::CPUBackend::setAutotuneEnabled(true);
+
+	tc::CPUBackend backend{ tc::ExecutionPolicy::Seq };
+	std::vector<int> hits(5000, 0);
+	CountingKernel kernel{ .pHits = &hits };
+	const int runs = 6 * 5 + 2;
+	for (int i = 0; i < runs; ++i) {
+		backend.execute(kernel, tc::uvec3{ 5000u,1u,1u });
+	}
+	for (int h : hits) {
+		ASSERT_EQ(h, runs);
+	}
+
+	tc::tuning::TuningTable stored;
+	EXPECT_TRUE(stored.load(file));
+	EXPECT_EQ(stored.size(), 1u);
+
+	tc::CPUBackend::setAutotuneEnabled(false);
+	tc::CPUBackend::setAutotuneFile({});
+	std::filesystem::remove(file);
+}
+
+TEST(TuningTest, SessionIgnoresFileUntilActive)
+{
+	std::filesystem::path file = std::filesystem::temp_directory_path() / "tc_tuning_session.txt";
+	const std::string key = tc::tuning::TuningTable::makeKey("kernels/gol", "cpu8", 18);
+	tc::tuning::TuningTable table;
+	table.insert(key, tc::uvec3{ 64u,1u,1u });
+	ASSERT_TRUE(table.save(file));
+
+	// a stale default file does not change anything while tuning is off.
+	tc::tuning::TuningSession session{ file };
+	EXPECT_FALSE(session.isActive());
+	EXPECT_FALSE(session.find(key));
+	EXPECT_FALSE(session.nextTrial(key, { tc::uvec3{ 1u,1u,1u } }));
+
+	session.setFile(file);
+	EXPECT_TRUE(session.isActive());
+	auto value = session.find(key);
+	ASSERT_TRUE(value.has_value());
+	EXPECT_EQ(value->x, 64u);
+	// only measured when enabled.
+	EXPECT_FALSE(session.nextTrial(key, { tc::uvec3{ 1u,1u,1u } }));
+
+	session.setFile({});
+	EXPECT_FALSE(session.isActive());
+	EXPECT_FALSE(session.find(key));
+	std::filesystem::remove(file);
+}
+
+TEST(TuningTest, SessionCachesKeys)
+{
+	tc::tuning::TuningSession session{ "unused.txt" };
+	static constexpr char kernel[] = "kernels/gol";
+	int built = 0;
+	auto device = [&] { ++built; return std::string("cpu8"); };
+	const std::string& first = session.key(kernel, 0, 18, device);
+	const std::string& again = session.key(kernel, 0, 18, device);
+	session.key(kernel, 1, 18, device);
+	EXPECT_EQ(&first, &again);
+	EXPECT_EQ(first, tc::tuning::TuningTable::makeKey(kernel, "cpu8", 18));
+	EXPECT_EQ(built, 2);
+}
+
+TEST(TuningTest, LocalSizeTuningIsOptIn)
+{
+	EXPECT_FALSE(tc::tuning::tune_local_size_v<CountingKernel>);
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <map>
+#include <optional>
+#include <string>
+
+// The text an imageLoad gets around its coordinate for the tc::AddressMode of
+// the image, without clang so the tests can check it.
+struct ImageAddressing {
+	std::string insertBefore;
+	std::string insertAfter;
+};
+
+// tc_repeat(p, size) wraps p into 0..size - 1 per component. GLSL leaves
+// % of a negative operand undefined, so it wraps the absolute value.
+inline const std::string RepeatFunctions =
+	"\n#ifndef TC_REPEAT\n#define TC_REPEAT\n"
+	"int tc_repeat(int p, int size) { int r = abs(p) % size; return (p < 0 && r != 0) ? size - r : r; }\n"
+	"ivec2 tc_repeat(ivec2 p, ivec2 size) { return ivec2(tc_repeat(p.x, size.x), tc_repeat(p.y, size.y)); }\n"
+	"ivec3 tc_repeat(ivec3 p, ivec3 size) { return ivec3(tc_repeat(p.x, size.x), tc_repeat(p.y, size.y), tc_repeat(p.z, size.z)); }\n"
+	"#endif\n";
+
+// the GLSL type of the coordinate of an image with the tc::Dim, a cube map
+// is addressed with its face in z.
+inline std::optional<std::string> imageCoordinateType(const std::string& dimension)
+{
+	static const std::map<std::string, std::string> coordinateTypes =
+	{
+		{"D1","int"},{"D2","ivec2"},{"D3","ivec3"},{"Cube","ivec3"}
+	};
+	auto type = coordinateTypes.find(dimension);
+	if (type == coordinateTypes.end()) {
+		return std::nullopt;
+	}
+	return type->second;
+}
+
+// ClampToEdge and Repeat move the coordinate into the image. None and Border
+// leave the imageLoad as it is: an out of range load is undefined in GLSL, the
+// zero that Border reads is only guaranteed on the CPU.
+inline std::optional<ImageAddressing> imageAddressing(const std::string& mode, const std::string& dimension,
+	const std::string& imageText)
+{
+	if (mode == "Repeat") {
+		return ImageAddressing{ "tc_repeat(", ", imageSize(" + imageText + "))" };
+	}
+	if (mode == "ClampToEdge") {
+		auto coordType = imageCoordinateType(dimension);
+		if (!coordType.has_value()) {
+			return std::nullopt;
+		}
+		return ImageAddressing{ "clamp(", ", " + coordType.value() + "(0), imageSize(" + imageText + ") - 1)" };
+	}
+	return std::nullopt;
+}
@@ -3,6 +3,7 @@
 #include <clang/astmatchers/ASTMatchers.h>
 #include <clang/ASTMatchers/ASTMatchFinder.h>
 #include <clang/AST/TextNodeDumper.h> 
+#include <clang/AST/RecordLayout.h>
 
 KernelRewriter::KernelRewriter(clang::ASTContext* pContext, std::vector<PendingEdit>& edits)
 	:m_pASTContext(pContext), m_PendingEdits{ edits }
@@ -26,7 +27,10 @@ std::optional<std::string> KernelRewriter::glslTypeForVecBase(clang::QualType qt
 	// Make sure it is tc::vec_base<..., ...>
 	// (compare the primary templates qualified name)
 	const auto* Prim = Spec->getSpecializedTemplate();
-	if (!Prim || Prim->getQualifiedNameAsString() != "tc::vec_base")
+	if (!Prim) return std::nullopt;
+	// tc::std430::vec<T, N> only adds the std430 alignment to vec_base<T, N>
+	std::string primName = Prim->getQualifiedNameAsString();
+	if (primName != "tc::vec_base" && primName != "tc::std430::vec")
 		return std::nullopt;
 
 	const auto& args = Spec->getTemplateArgs().asArray();
@@ -182,6 +186,26 @@ bool KernelRewriter::rewriteBufferBinding(const clang::FieldDecl* FD) {
 			}
 
 			std::string varName = FD->getNameAsString();
+			if (isSoABufferBinding(FD)) {
+				// one SSBO per member, member n at binding + n.
+				const CXXRecordDecl* pElem = elemType->getAsCXXRecordDecl();
+				if (!pElem) return true;
+				std::string glsl;
+				unsigned memberBinding = binding;
+				for (const FieldDecl* pMember : pElem->fields()) {
+					QualType memberType = pMember->getType();
+					std::string glslMemberType = glslTypeForElement(memberType)
+						.value_or(typeNameNoScope(memberType, *m_pASTContext));
+					std::string arrayName = varName + "_" + pMember->getNameAsString();
+					glsl += "layout(set = " + std::to_string(set) +
+						", binding = " + std::to_string(memberBinding++) + ") buffer " + "_" + arrayName + "Layout" + " {"
+						+ glslMemberType + " " + arrayName + "[]; }; ";
+				}
+				SourceLocation endLoc = Lexer::getLocForEndOfToken(
+					FD->getSourceRange().getEnd(), 0, SM, m_pASTContext->getLangOpts());
+				m_PendingEdits.emplace_back(PendingEdit{ SourceRange(FD->getSourceRange().getBegin(), endLoc), glsl });
+				return false;
+			}
 			// Build GLSL buffer declaration (SSBO style)
 			std::string glsl = "layout(set = " + std::to_string(set) +
 				", binding = " + std::to_string(binding) + ") buffer " + "_" + varName + "Layout" + " {"
@@ -215,6 +239,9 @@ bool KernelRewriter::VisitFieldDecl(clang::FieldDecl* pField)
 	else if (checkUniformField(pField)) {
 		rewriteUniform(pField);
 	}
+	else if (checkSpecConstantField(pField)) {
+		rewriteSpecConstant(pField);
+	}
 	else if (checkStdArrayField(pField)) {
 		rewriteStdArray(pField);
 	}
@@ -241,6 +268,48 @@ bool KernelRewriter::VisitFunctionDecl(clang::FunctionDecl* pFunction)
 	return true;
 }
 
+bool KernelRewriter::isSoABufferBinding(const clang::FieldDecl* pField)
+{
+	using namespace clang;
+	if (!checkBufferBinding(pField)) {
+		return false;
+	}
+	const auto* Spec = dyn_cast_or_null<ClassTemplateSpecializationDecl>(
+		pField->getType()->getAsCXXRecordDecl());
+	if (!Spec || Spec->getTemplateArgs().size() < 4) {
+		return false;
+	}
+	const TemplateArgument& layout = Spec->getTemplateArgs()[3];
+	return layout.getKind() == TemplateArgument::ArgKind::Integral
+		&& getUnqualifiedEnumType(layout) == "SoA";
+}
+
+// buffer[i].member on a structure of arrays binding becomes buffer_member[i].
+bool KernelRewriter::VisitMemberExpr(clang::MemberExpr* pMember)
+{
+	using namespace clang;
+	const auto* pSubscript = dyn_cast<CXXOperatorCallExpr>(pMember->getBase()->IgnoreImplicit());
+	if (!pSubscript || pSubscript->getOperator() != OO_Subscript) {
+		return true;
+	}
+	const auto* pBuffer = dyn_cast<MemberExpr>(pSubscript->getArg(0)->IgnoreImpCasts());
+	if (!pBuffer) {
+		return true;
+	}
+	const auto* pBufferField = dyn_cast<FieldDecl>(pBuffer->getMemberDecl());
+	if (!pBufferField || !isSoABufferBinding(pBufferField)) {
+		return true;
+	}
+
+	const SourceManager& SM = m_pASTContext->getSourceManager();
+	std::string memberName = pMember->getMemberDecl()->getNameAsString();
+	SourceLocation afterBuffer = Lexer::getLocForEndOfToken(
+		pBuffer->getEndLoc(), 0, SM, m_pASTContext->getLangOpts());
+	m_PendingEdits.emplace_back(PendingEdit{ SourceRange{ afterBuffer, afterBuffer }, "_" + memberName, true, true });
+	m_PendingEdits.emplace_back(PendingEdit{ SourceRange{ pMember->getOperatorLoc(), pMember->getMemberLoc() }, "" });
+	return true;
+}
+
 bool KernelRewriter::checkBufferBinding(const clang::FieldDecl* pField) {
 	using namespace clang::ast_matchers;
 	auto bindingPointMatcher = fieldDecl(
@@ -263,54 +332,347 @@ bool KernelRewriter::checkBufferBinding(const clang::FieldDecl* pField) {
 	}
 }
 
+std::optional<KernelRewriter::UniformMember> KernelRewriter::getUniformMember(const clang::FieldDecl* FD)
+{
+	using namespace clang;
+	const QualType QT = FD->getType();
+	const TemplateSpecializationType* TST = QT->getAs<TemplateSpecializationType>();
+	if (!TST) return std::nullopt;
+
+	const auto* CTSDecl = dyn_cast<ClassTemplateSpecializationDecl>(TST->getAsRecordDecl());
+	if (!CTSDecl) return std::nullopt;
+
+	const auto& Args = CTSDecl->getTemplateArgs();
+	if (Args.size() < 2) return std::nullopt;
+
+	// Elem type is Arg 0
+	QualType elemType = Args[0].getAsType();
+	auto glslElemTypeOpt = glslTypeForElement(elemType);
+	if (!glslElemTypeOpt) return std::nullopt;
+
+	UniformMember member;
+	member.name = FD->getNameAsString();
+	member.glslType = *glslElemTypeOpt;
+	// location is Arg 1
+	if (Args[1].getKind() == clang::TemplateArgument::ArgKind::Integral) {
+		member.location = static_cast<unsigned>(Args[1].getAsIntegral().getZExtValue());
+	}
+
+	// scalar size and number of components for the std140 rules
+	QualType scalarType = elemType.getCanonicalType();
+	if (const auto* Spec = dyn_cast_or_null<ClassTemplateSpecializationDecl>(scalarType->getAsCXXRecordDecl())) {
+		const auto& vecArgs = Spec->getTemplateArgs();
+		scalarType = vecArgs[0].getAsType().getCanonicalType();
+		member.components = static_cast<unsigned>(vecArgs[1].getAsIntegral().getZExtValue());
+	}
+	member.scalarSize = scalarType->isSpecificBuiltinType(BuiltinType::Double) ? 8 : 4;
+	return member;
+}
+
 bool KernelRewriter::rewriteUniform(const clang::FieldDecl* FD) {
 	using namespace clang;
 	const SourceManager& SM = m_pASTContext->getSourceManager();
 
-	const QualType QT = FD->getType();
-	const TemplateSpecializationType* TST = QT->getAs<TemplateSpecializationType>();
-	if (!TST) return true;
+	// Replace the entire field declaration (including initializer)
+	SourceLocation endLoc = Lexer::getLocForEndOfToken(
+		FD->getSourceRange().getEnd(), 0, SM, m_pASTContext->getLangOpts());
+	SourceRange fullRange(FD->getSourceRange().getBegin(), endLoc);
+
+	// All uniforms of the kernel are gathered in one std140 block, which takes
+	// the place of the first uniform field. The other fields are removed.
+	const RecordDecl* pKernel = FD->getParent();
+	const FieldDecl* pFirstUniform = nullptr;
+	std::vector<UniformMember> members;
+	for (FieldDecl* pField : pKernel->fields()) {
+		if (!checkUniformField(pField)) {
+			continue;
+		}
+		if (pFirstUniform == nullptr) {
+			pFirstUniform = pField;
+		}
+		if (auto member = getUniformMember(pField)) {
+			members.push_back(*member);
+		}
+	}
 
-	QualType elemType;
-	unsigned location = 0, set = 0;
+	if (pFirstUniform != FD) {
+		PendingEdit edit{ fullRange, "" };
+		m_PendingEdits.emplace_back(edit);
+		return false;
+	}
 
-	if (const auto* CTSDecl = dyn_cast<ClassTemplateSpecializationDecl>(
-		TST->getAsRecordDecl())) {
+	std::sort(members.begin(), members.end(), [](const UniformMember& a, const UniformMember& b) {
+		return a.location < b.location;
+		});
+
+	// a Uniform<T, Location> lives at offset 16 * Location, float fillers
+	// move the next member to its slot.
+	std::string block = "layout(std140, binding = " + std::to_string(tc::std140::UniformBlockBinding) +
+		") uniform " + tc::std140::UniformBlockName + " {";
+	uint32_t cursor = 0;
+	unsigned padIndex = 0;
+	for (const UniformMember& member : members) {
+		uint32_t offset = tc::std140::slotOffset(member.location);
+		if (offset < cursor) {
+			llvm::errs() << "Uniform " << member.name << " at location " << member.location
+				<< " overlaps the previous uniform\n";
+			return true;
+		}
+		if (offset % tc::std140::baseAlignment(member.scalarSize, member.components) != 0) {
+			llvm::errs() << "Uniform " << member.name << " at location " << member.location
+				<< " is not aligned for " << member.glslType << ", use an even location\n";
+			return true;
+		}
+		for (; cursor < offset; cursor += 4) {
+			block += " float _tcPad" + std::to_string(padIndex++) + ";";
+		}
+		block += " " + member.glslType + " " + member.name + ";";
+		cursor = offset + tc::std140::byteSize(member.scalarSize, member.components);
+	}
+	block += " };";
 
-		const auto& Args = CTSDecl->getTemplateArgs();
-		if (Args.size() >= 2) {
-			// Elem type is Arg 0
-			QualType elemType = Args[0].getAsType();
+	PendingEdit edit{ fullRange, block };
+	m_PendingEdits.emplace_back(edit);
+	return false;
+}
 
-			auto glslElemTypeOpt = glslTypeForElement(elemType);
-			if (!glslElemTypeOpt) {
-				return true;
+std::optional<tc::std430::MemberInfo> KernelRewriter::std430Info(clang::QualType type)
+{
+	using namespace clang;
+	type = type.getCanonicalType().getUnqualifiedType();
+
+	if (const ConstantArrayType* pArray = m_pASTContext->getAsConstantArrayType(type)) {
+		auto elem = std430Info(pArray->getElementType());
+		if (!elem) return std::nullopt;
+		// the std430 array stride has to match the C++ element size
+		uint32_t stride = tc::std430::alignUp(elem->size, elem->alignment);
+		if (stride != m_pASTContext->getTypeSizeInChars(pArray->getElementType()).getQuantity()) {
+			return std::nullopt;
+		}
+		uint32_t count = static_cast<uint32_t>(pArray->getSize().getZExtValue());
+		return tc::std430::MemberInfo{ 0, elem->alignment, stride * count };
+	}
+
+	if (const auto* pBuiltin = type->getAs<BuiltinType>()) {
+		if (pBuiltin->isBooleanType()) return std::nullopt;
+		uint32_t size = static_cast<uint32_t>(m_pASTContext->getTypeSizeInChars(type).getQuantity());
+		if (size != 4 && !pBuiltin->isSpecificBuiltinType(BuiltinType::Double)) return std::nullopt;
+		return tc::std430::MemberInfo{ 0, size, size };
+	}
+
+	const CXXRecordDecl* pRecord = type->getAsCXXRecordDecl();
+	if (!pRecord) return std::nullopt;
+
+	if (auto glslType = glslTypeForVecBase(type)) {
+		const auto* Spec = dyn_cast<ClassTemplateSpecializationDecl>(pRecord);
+		const auto& args = Spec->getTemplateArgs();
+		QualType scalarType = args[0].getAsType().getCanonicalType();
+		if (scalarType->isBooleanType()) return std::nullopt;
+		uint32_t scalarSize = scalarType->isSpecificBuiltinType(BuiltinType::Double) ? 8 : 4;
+		uint32_t components = static_cast<uint32_t>(args[1].getAsIntegral().getZExtValue());
+		return tc::std430::MemberInfo{ 0,
+			tc::std430::baseAlignment(scalarSize, components),
+			tc::std430::byteSize(scalarSize, components) };
+	}
+
+	// a nested struct gets its own fillers, so its GLSL size is its C++ size.
+	uint32_t alignment = 4;
+	for (const FieldDecl* pField : pRecord->fields()) {
+		auto member = std430Info(pField->getType());
+		if (!member) return std::nullopt;
+		alignment = std::max(alignment, member->alignment);
+	}
+	uint32_t size = static_cast<uint32_t>(m_pASTContext->getTypeSizeInChars(type).getQuantity());
+	return tc::std430::MemberInfo{ 0, alignment, size };
+}
+
+bool KernelRewriter::isBufferElement(const clang::CXXRecordDecl* pRecord)
+{
+	using namespace clang;
+	const auto* pKernel = dyn_cast<CXXRecordDecl>(pRecord->getDeclContext());
+	if (!pKernel) return false;
+
+	const CXXRecordDecl* pCanonical = pRecord->getCanonicalDecl();
+	for (const FieldDecl* pField : pKernel->fields()) {
+		// the members of a structure of arrays element are separate arrays.
+		if (!checkBufferBinding(pField) || isSoABufferBinding(pField)) {
+			continue;
+		}
+		const auto* Spec = dyn_cast_or_null<ClassTemplateSpecializationDecl>(
+			pField->getType()->getAsCXXRecordDecl());
+		if (!Spec) continue;
+
+		QualType elemType = Spec->getTemplateArgs()[0].getAsType().getCanonicalType();
+		// element structs and the structs nested in them
+		std::vector<QualType> pending{ elemType };
+		while (!pending.empty()) {
+			QualType current = pending.back();
+			pending.pop_back();
+			if (const ArrayType* pArray = current->getAsArrayTypeUnsafe()) {
+				pending.push_back(pArray->getElementType().getCanonicalType());
+				continue;
 			}
-			std::string glslElemType = *glslElemTypeOpt;
-			// binding is Arg 1
-			unsigned location = 0;
-			if (Args[1].getKind() == clang::TemplateArgument::ArgKind::Integral) {
-				location = static_cast<unsigned>(Args[1].getAsIntegral().getZExtValue());
+			const CXXRecordDecl* pElem = current->getAsCXXRecordDecl();
+			if (!pElem || glslTypeForVecBase(current)) continue;
+			if (pElem->getCanonicalDecl() == pCanonical) return true;
+			for (const FieldDecl* pMember : pElem->fields()) {
+				pending.push_back(pMember->getType().getCanonicalType());
 			}
+		}
+	}
+	return false;
+}
 
+bool KernelRewriter::VisitCXXRecordDecl(clang::CXXRecordDecl* pRecord)
+{
+	if (pRecord->isImplicit() || pRecord->isLambda() || !pRecord->isThisDeclarationADefinition()) {
+		return true;
+	}
+	if (isBufferElement(pRecord)) {
+		padStd430Struct(pRecord);
+	}
+	return true;
+}
 
-			std::string varName = FD->getNameAsString();
-			std::string name = FD->getNameAsString();
-			std::string uniformDecl = "layout(location = " + std::to_string(location) +
-				") uniform " + glslElemType + " " + name + ";";
+void KernelRewriter::padStd430Struct(const clang::CXXRecordDecl* pRecord)
+{
+	using namespace clang;
+	const ASTRecordLayout& layout = m_pASTContext->getASTRecordLayout(pRecord);
+	uint32_t structSize = static_cast<uint32_t>(layout.getSize().getQuantity());
+
+	std::vector<const FieldDecl*> fields;
+	std::vector<tc::std430::MemberInfo> members;
+	for (const FieldDecl* pField : pRecord->fields()) {
+		auto member = std430Info(pField->getType());
+		if (!member) {
+			llvm::errs() << pField->getLocation().printToString(m_pASTContext->getSourceManager())
+				<< " Error: '" << pField->getName() << "' has no std430 equivalent (bool or unsupported type).\n";
+			return;
+		}
+		member->offset = static_cast<uint32_t>(layout.getFieldOffset(pField->getFieldIndex()) / 8);
+		fields.push_back(pField);
+		members.push_back(*member);
+	}
 
-			// Replace the entire field declaration (including initializer)
-			SourceLocation endLoc = Lexer::getLocForEndOfToken(
-				FD->getSourceRange().getEnd(), 0, SM, m_pASTContext->getLangOpts());
-			SourceRange fullRange(FD->getSourceRange().getBegin(), endLoc);
+	std::size_t failed = 0;
+	tc::std430::LayoutResult result = tc::std430::check(members, structSize, &failed);
+	if (result != tc::std430::LayoutResult::Ok) {
+		SourceLocation loc = result == tc::std430::LayoutResult::Stride || fields.empty()
+			? pRecord->getLocation() : fields[failed]->getLocation();
+		llvm::errs() << loc.printToString(m_pASTContext->getSourceManager())
+			<< " Error: the layout of '" << pRecord->getName() << "' can not be expressed in std430";
+		if (result == tc::std430::LayoutResult::Misaligned) {
+			llvm::errs() << ", '" << fields[failed]->getName() << "' at offset " << members[failed].offset
+				<< " needs an alignment of " << members[failed].alignment << ", use the tc::std430 vector types";
+		}
+		llvm::errs() << ".\n";
+		return;
+	}
 
-			// Do the replacement
-			PendingEdit edit{ fullRange, uniformDecl };
+	// float fillers move every member to its C++ offset.
+	uint32_t cursor = 0;
+	unsigned padIndex = 0;
+	auto fillers = [&padIndex](uint32_t from, uint32_t to) {
+		std::string text;
+		for (; from < to; from += 4) {
+			text += "float _pad" + std::to_string(padIndex++) + "; ";
+		}
+		return text;
+		};
+	for (std::size_t i = 0; i < fields.size(); ++i) {
+		if (members[i].offset > cursor) {
+			PendingEdit edit{ SourceRange{ fields[i]->getBeginLoc(), fields[i]->getBeginLoc() },
+				fillers(cursor, members[i].offset), true };
 			m_PendingEdits.emplace_back(edit);
-			return false;
 		}
+		cursor = members[i].offset + members[i].size;
+	}
+	if (structSize > cursor) {
+		SourceLocation rbrace = pRecord->getBraceRange().getEnd();
+		PendingEdit edit{ SourceRange{ rbrace, rbrace }, fillers(cursor, structSize), true };
+		m_PendingEdits.emplace_back(edit);
 	}
-	return true;
+}
+
+bool KernelRewriter::checkSpecConstantField(const clang::FieldDecl* pField)
+{
+	using namespace clang::ast_matchers;
+	auto specConstantMatcher = fieldDecl(
+		hasType(qualType(hasDeclaration(
+			classTemplateSpecializationDecl(hasName("SpecConstant"))
+		)))
+	);
+
+	auto innerMatches = match(
+		specConstantMatcher,
+		*pField,
+		*m_pASTContext
+	);
+	return !innerMatches.empty();
+}
+
+bool KernelRewriter::rewriteSpecConstant(const clang::FieldDecl* FD)
+{
+	using namespace clang;
+	const SourceManager& SM = m_pASTContext->getSourceManager();
+
+	const auto* CTSDecl = dyn_cast_or_null<ClassTemplateSpecializationDecl>(
+		FD->getType()->getAsCXXRecordDecl());
+	if (!CTSDecl) return true;
+
+	const auto& Args = CTSDecl->getTemplateArgs();
+	if (Args.size() < 3) return true;
+
+	// Elem type is Arg 0
+	QualType elemType = Args[0].getAsType();
+	auto glslElemTypeOpt = glslTypeForElement(elemType);
+	if (!glslElemTypeOpt) return true;
+
+	// id is Arg 1
+	unsigned id = static_cast<unsigned>(Args[1].getAsIntegral().getZExtValue());
+
+	// default value is Arg 2
+	std::string literal;
+	if (Args[2].getKind() == TemplateArgument::ArgKind::Integral) {
+		const llvm::APSInt& value = Args[2].getAsIntegral();
+		if (elemType->isBooleanType()) {
+			literal = value.getBoolValue() ? "true" : "false";
+		}
+		else {
+			literal = llvm::toString(value, 10) + (value.isUnsigned() ? "u" : "");
+		}
+	}
+	else if (Args[2].getKind() == TemplateArgument::ArgKind::StructuralValue
+		&& Args[2].getAsStructuralValue().isFloat()) {
+		llvm::SmallString<32> text;
+		Args[2].getAsStructuralValue().getFloat().toString(text);
+		literal = text.str().str();
+		if (literal.find_first_of(".eE") == std::string::npos) {
+			literal += ".0";
+		}
+		if (elemType->isSpecificBuiltinType(BuiltinType::Double)) {
+			literal += "lf";
+		}
+	}
+	else {
+		llvm::errs() << FD->getLocation().printToString(SM)
+			<< " Error: unsupported default value for SpecConstant '" << FD->getName() << "'.\n";
+		return true;
+	}
+
+	// the backend defines TC_SPEC_<id> after the #version line to override the default.
+	std::string macro = "TC_SPEC_" + std::to_string(id);
+	std::string glsl = "\n#ifndef " + macro + "\n#define " + macro + " " + literal + "\n#endif\n"
+		+ "const " + *glslElemTypeOpt + " " + FD->getNameAsString() + " = " + macro + ";";
+
+	// Replace the entire field declaration (including initializer)
+	SourceLocation endLoc = Lexer::getLocForEndOfToken(
+		FD->getSourceRange().getEnd(), 0, SM, m_pASTContext->getLangOpts());
+	SourceRange fullRange(FD->getSourceRange().getBegin(), endLoc);
+
+	PendingEdit edit{ fullRange, glsl };
+	m_PendingEdits.emplace_back(edit);
+	return false;
 }
 
 bool KernelRewriter::checkStdArrayField(const clang::FieldDecl* pField)
@@ -561,9 +923,10 @@ bool KernelRewriter::rewriteImageBinding(const clang::FieldDecl* FD)
 			}
 
 			std::string varName = FD->getNameAsString();
-			// Build image layout declaration
+			// Build image layout declaration, a repeating image needs tc_repeat first.
 			const ImageFormatDescriptor& desc = m_ImageFormats.at(imageFormat.value());
-			std::string glsl = "layout(binding=" + std::to_string(binding) +
+			std::string glsl = (imageAddressMode(QT) == "Repeat" ? RepeatFunctions : "") +
+				"layout(binding=" + std::to_string(binding) +
 				"," + desc.imageIdentifier + ") "
 				"uniform " + m_TypePrefix.at(desc.scalar) + "image" + m_DimensionSuffix.at(dimension.value()) +
 				" " + varName;
@@ -585,6 +948,53 @@ bool KernelRewriter::rewriteImageBinding(const clang::FieldDecl* FD)
 	return true;
 }
 
+std::string KernelRewriter::imageAddressMode(clang::QualType imageType)
+{
+	using namespace clang;
+	const auto* CTSDecl = dyn_cast_or_null<ClassTemplateSpecializationDecl>(
+		imageType.getNonReferenceType()->getAsCXXRecordDecl());
+	if (!CTSDecl || CTSDecl->getName() != "ImageBinding") {
+		return "None";
+	}
+	// address mode is Arg 7
+	const auto& Args = CTSDecl->getTemplateArgs();
+	if (Args.size() < 7 || Args[6].getKind() != TemplateArgument::ArgKind::Integral) {
+		return "None";
+	}
+	return getUnqualifiedEnumType(Args[6]).value_or("None");
+}
+
+void KernelRewriter::addressImageLoad(const clang::CallExpr* callExpr)
+{
+	using namespace clang;
+	if (callExpr->getNumArgs() != 2) {
+		return;
+	}
+	const Expr* image = callExpr->getArg(0)->IgnoreParenImpCasts();
+	const auto* CTSDecl = dyn_cast_or_null<ClassTemplateSpecializationDecl>(image->getType()->getAsCXXRecordDecl());
+	if (!CTSDecl || CTSDecl->getTemplateArgs().size() < 2) {
+		return;
+	}
+	const std::string mode = imageAddressMode(image->getType());
+	const auto dimension = getUnqualifiedEnumType(CTSDecl->getTemplateArgs()[1]);
+
+	SourceManager& sourceManager = m_pASTContext->getSourceManager();
+	const LangOptions& languageOptions = m_pASTContext->getLangOpts();
+	std::string imageText = Lexer::getSourceText(
+		CharSourceRange::getTokenRange(image->getSourceRange()), sourceManager, languageOptions).str();
+
+	auto addressing = imageAddressing(mode, dimension.value_or(""), imageText);
+	if (!addressing.has_value()) {
+		return;
+	}
+
+	SourceRange sr = callExpr->getArg(1)->IgnoreParenImpCasts()->getSourceRange();
+	SourceLocation endLoc = Lexer::getLocForEndOfToken(sr.getEnd(), 0, sourceManager, languageOptions);
+
+	m_PendingEdits.emplace_back(SourceRange{ sr.getBegin(), sr.getBegin() }, addressing->insertBefore, true);
+	m_PendingEdits.emplace_back(SourceRange{ endLoc, endLoc }, addressing->insertAfter, true, true);
+}
+
 bool KernelRewriter::checkImageBinding(const clang::FieldDecl* pField)
 {
 	using namespace clang::ast_matchers;
@@ -716,6 +1126,9 @@ bool KernelRewriter::VisitCallExpr(clang::CallExpr* callExpr)
 	if (auto* functionCall = callExpr->getDirectCallee()) {
 
 		if (isInNamespace(functionCall, "tc")) {
+			if (functionCall->getNameAsString() == "imageLoad") {
+				addressImageLoad(callExpr);
+			}
 			// Remove just the namespace qualifier "tc::" if its present in the source.
 			if (auto* DRE = llvm::dyn_cast<clang::DeclRefExpr>(
 				callExpr->getCallee()->IgnoreParenImpCasts())) {
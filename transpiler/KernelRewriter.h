@@ -8,6 +8,9 @@
 #include <map>
 #include "PendingEdit.h"
 #include "ImageFormatDescriptor.h"
+#include "ImageAddressing.h"
+#include "layout/std140.hpp"
+#include "layout/std430.hpp"
 
 enum class GLSLDataType {
 	BOOL, INT, UINT, FLOAT, DOUBLE, OTHER
@@ -25,6 +28,7 @@ public:
 	bool VisitUsingDirectiveDecl(clang::UsingDirectiveDecl* pUsing);
 	bool VisitInitListExpr(clang::InitListExpr* pInitList);
 	bool VisitCXXMemberCallExpr(clang::CXXMemberCallExpr* pMemberCall);
+	bool VisitCXXRecordDecl(clang::CXXRecordDecl* pRecord);
 
 	static void focusedDump(const clang::Stmt* S, clang::ASTContext& Ctx);
 
@@ -35,13 +39,15 @@ public:
 	clang::SourceLocation afterRSquare(const clang::Expr* Index);
 
 	bool VisitCXXOperatorCallExpr(clang::CXXOperatorCallExpr* E);
+	bool VisitMemberExpr(clang::MemberExpr* pMember);
 
 	bool TraverseFieldDecl(clang::FieldDecl* pFieldDecl) {
 		
 		if (pFieldDecl->getNameAsString() == "local_size"
 			|| checkBufferBinding(pFieldDecl)
 			|| checkImageBinding(pFieldDecl)
-			|| checkUniformField(pFieldDecl))
+			|| checkUniformField(pFieldDecl)
+			|| checkSpecConstantField(pFieldDecl))
 		{
 			return this->WalkUpFromFieldDecl(pFieldDecl);
 		}
@@ -72,12 +78,35 @@ private:
 	void castTo(clang::Expr* pExpr, GLSLDataType targetCast);
 	bool checkBufferBinding(const clang::FieldDecl* pField);
 	bool rewriteBufferBinding(const clang::FieldDecl* pField);
+	bool isSoABufferBinding(const clang::FieldDecl* pField);
 
 	bool checkImageBinding(const clang::FieldDecl* pField);
 	bool rewriteImageBinding(const clang::FieldDecl* pField);
+	// the tc::AddressMode of an ImageBinding type, "None" for other types.
+	std::string imageAddressMode(clang::QualType imageType);
+	// moves the coordinate of an imageLoad into the image when its binding
+	// clamps or repeats, see imageAddressing.
+	void addressImageLoad(const clang::CallExpr* callExpr);
+
+	struct UniformMember {
+		std::string name;
+		std::string glslType;
+		unsigned location = 0;
+		unsigned scalarSize = 4;
+		unsigned components = 1;
+	};
 
 	bool checkUniformField(clang::FieldDecl* pField);
 	bool rewriteUniform(const clang::FieldDecl* pField);
+	std::optional<UniformMember> getUniformMember(const clang::FieldDecl* pField);
+
+	// std430 alignment and size of a buffer element member, offset is left 0.
+	std::optional<tc::std430::MemberInfo> std430Info(clang::QualType type);
+	bool isBufferElement(const clang::CXXRecordDecl* pRecord);
+	void padStd430Struct(const clang::CXXRecordDecl* pRecord);
+
+	bool checkSpecConstantField(const clang::FieldDecl* pField);
+	bool rewriteSpecConstant(const clang::FieldDecl* pField);
 
 	bool checkStdArrayField(const clang::FieldDecl* pField);
 	bool rewriteStdArray(const clang::FieldDecl* pField);
@@ -64,12 +64,15 @@ public:
 
         llvm::outs() << "Extracted local_size: " << x << ", " << y << ", " << z << "\n";
 
-        // Build replacement GLSL layout line
+        // Build replacement GLSL layout line, the sizes are defaults that the
+        // backend overrides with TC_LOCAL_SIZE_* defines for a tuned variant.
         std::string replacement =
-            "layout (local_size_x = " + std::to_string(x) +
-            ", local_size_y = " + std::to_string(y) +
-            ", local_size_z = " + std::to_string(z) +
-            ") in;";
+            "\n#ifndef TC_LOCAL_SIZE_X\n#define TC_LOCAL_SIZE_X " + std::to_string(x) +
+            "\n#define TC_LOCAL_SIZE_Y " + std::to_string(y) +
+            "\n#define TC_LOCAL_SIZE_Z " + std::to_string(z) +
+            "\n#endif\n"
+            "layout (local_size_x = TC_LOCAL_SIZE_X, local_size_y = TC_LOCAL_SIZE_Y"
+            ", local_size_z = TC_LOCAL_SIZE_Z) in;";
 
         // Replace the entire field declaration (including initializer)
         SourceManager& SM = Ctx->getSourceManager();